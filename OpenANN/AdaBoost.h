@@ -2,7 +2,7 @@
 #define OPENANN_ADABOOST_H_
 
 #include <OpenANN/EnsembleLearner.h>
-#include <list>
+#include <vector>
 
 namespace OpenANN
 {
@@ -15,6 +15,10 @@ namespace OpenANN
  * AdaBoost tries to learn specialized experts for subsets of the training set
  * [1]. This implementation can only be used for classification.
  *
+ * The predictions of each model on the training set are computed only once
+ * per boosting round and they are used to compute the weighted error as well
+ * as to update the weights of the training instances.
+ *
  * [1] Y. Freund, R. E. Schapire:
  * A Decision-Theoretic Generalization of on-Line Learning and an Application
  * to Boosting,
@@ -22,7 +26,7 @@ namespace OpenANN
  */
 class AdaBoost : public EnsembleLearner
 {
-  std::list<Learner*> models;
+  std::vector<Learner*> models;
   Optimizer* optimizer;
   Eigen::VectorXd modelWeights;
   int F;
@@ -2,7 +2,7 @@
 #define OPENANN_BAGGING_H_
 
 #include <OpenANN/EnsembleLearner.h>
-#include <list>
+#include <vector>
 
 namespace OpenANN
 {
@@ -16,11 +16,20 @@ namespace OpenANN
  * sampled subsets of the training set [1]. This implementation can be used
  * for classification and regression.
  *
+ * The models will be trained in parallel if the optimizer can be cloned
+ * (see Optimizer::isCloneable()). Each thread uses its own copy of the
+ * optimizer. The m-th model draws its bootstrap sample and all random
+ * numbers during its training from its own RandomStream, so that the
+ * result does not depend on the number of threads. Note that the
+ * training set will be copied and that DataSet::finishIteration() of the
+ * training set will not be called. Predictions of the models will be
+ * computed in parallel, too.
+ *
  * [1] L. Breiman: Bagging Predictors, Machine Learning 24, pp. 123-140, 1996.
  */
 class Bagging : public EnsembleLearner
 {
-  std::list<Learner*> models;
+  std::vector<Learner*> models;
   Optimizer* optimizer;
   double bagSize;
   int F;
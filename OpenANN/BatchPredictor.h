@@ -0,0 +1,105 @@
+#ifndef OPENANN_BATCH_PREDICTOR_H_
+#define OPENANN_BATCH_PREDICTOR_H_
+
+#include <Eigen/Core>
+#include <vector>
+
+namespace OpenANN
+{
+
+class Net;
+class DataSet;
+
+/**
+ * @class PredictionSink
+ *
+ * Receives the predictions of a BatchPredictor.
+ */
+class PredictionSink
+{
+public:
+  virtual ~PredictionSink() {}
+  /**
+   * Receive the predictions of a tile. Tiles will be passed one at a time in
+   * the order of the instances.
+   * @param offset index of the first instance of the tile
+   * @param Y predictions, each row represents an instance
+   */
+  virtual void consume(int offset, const Eigen::MatrixXd& Y) = 0;
+};
+
+/**
+ * @class BatchPredictor
+ *
+ * Computes the predictions of a network for large data sets in parallel.
+ *
+ * The instances will be split into tiles that are small enough to keep the
+ * activations of all layers in the cache. Each thread propagates its tiles
+ * through its own replica of the network and reuses its buffers, i.e. the
+ * required memory depends on the number of threads and the tile size but
+ * not on the number of instances. The results can be collected in a matrix
+ * or passed to a PredictionSink, e.g.
+ *
+\code
+OpenANN::BatchPredictor predictor(net);
+Eigen::MatrixXd Y = predictor(X);
+\endcode
+ *
+ * The number of threads is limited by numThreads(). The replicas will be
+ * created with Net::save() and Net::load() and their parameters will be
+ * updated before each prediction. Creating the replicas does not change the
+ * random numbers of the calling thread. Networks that cannot be replicated (see
+ * Net::isReplicable()) will be evaluated tile by tile in the calling thread.
+ * Dropout will be disabled.
+ */
+class BatchPredictor
+{
+  Net& net;
+  int tileSize;
+  bool replicable;
+  std::vector<Net*> replicas;
+  std::vector<Eigen::MatrixXd> inputs;
+  std::vector<Eigen::MatrixXd> outputs;
+public:
+  /**
+   * Create a predictor.
+   * @param net network, must live as long as the predictor
+   * @param tileSize number of instances per tile, 0 will derive it from the
+   *                 sizes of the layers
+   */
+  BatchPredictor(Net& net, int tileSize = 0);
+  ~BatchPredictor();
+  /**
+   * Get the number of instances per tile.
+   * @return tile size
+   */
+  int getTileSize() const { return tileSize; }
+  /**
+   * Make predictions.
+   * @param X each row represents an input vector
+   * @return each row represents an output vector
+   */
+  Eigen::MatrixXd operator()(const Eigen::MatrixXd& X);
+  /**
+   * Make predictions.
+   * @param X each row represents an input vector
+   * @param Y each row represents an output vector, will be resized if
+   *          necessary
+   */
+  void predict(const Eigen::MatrixXd& X, Eigen::MatrixXd& Y);
+  /**
+   * Make predictions and stream them to a sink. Instances will be read from
+   * the data set by one thread at a time.
+   * @param dataSet inputs, the targets will be ignored
+   * @param sink receives the predictions
+   */
+  void predict(DataSet& dataSet, PredictionSink& sink);
+private:
+  void predict(const Eigen::MatrixXd* X, DataSet* dataSet, int N,
+               PredictionSink& sink);
+  int prepare(int tiles);
+};
+
+} // namespace OpenANN
+
+#endif // OPENANN_BATCH_PREDICTOR_H_
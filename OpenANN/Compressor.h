@@ -26,6 +26,9 @@ public:
   virtual Transformer& fit(const Eigen::MatrixXd& X);
   virtual Transformer& fitPartial(const Eigen::MatrixXd& X);
   virtual Eigen::MatrixXd transform(const Eigen::MatrixXd& X);
+  virtual bool affine(Eigen::MatrixXd& W, Eigen::VectorXd& b);
+  virtual bool save(std::ostream& stream);
+  virtual bool load(std::istream& stream);
   int getOutputs();
 };
 
@@ -15,8 +15,9 @@ class StoppingCriteria;
  * Train a feedforward neural network supervised.
  *
  * @param net neural network
- * @param algorithm a registered algorithm, e.g. "MBSGD", "LMA", "CG", "LBFGS"
- *                  or "CMAES"
+ * @param algorithm a registered algorithm, e.g. "MBSGD", "LMA", "CG", "LBFGS",
+ *                  "CMAES" or "ELM" (closed-form solution for the output
+ *                  layer, see Net::fitOutputLayer())
  * @param errorFunction error function to optimize
  * @param stop stopping criteria
  * @param reinitialize should the weights be initialized before optimization?
@@ -10,6 +10,7 @@ namespace OpenANN
 
 class Learner;
 class DataSet;
+class EvaluationWorker;
 
 /**
  * @class Evaluator
@@ -44,6 +45,18 @@ public:
  * In addition, the number of iteration and the elapsed time will be logged. The
  * logger will be called "evaluation", i.e. the corresponding log file is
  * "evaluation.log" or "evaluation-date.log".
+ *
+ * In asynchronous mode the evaluator only takes a snapshot of the current
+ * parameter vector and returns immediately. A background thread evaluates
+ * the snapshot with an inference-only replica of the network and logs the
+ * results in the order of the iterations as soon as they are available.
+ * The logged time is the training time at which the snapshot was taken.
+ * The data set will be copied on its first evaluation, i.e. it must not
+ * change during the optimization. Asynchronous evaluation is only available
+ * for networks that can be replicated (see Net::isReplicable()). Other
+ * learners will be evaluated synchronously. The replica draws its initial
+ * parameters from a separate RandomStream, i.e. asynchronous evaluation does
+ * not change the random numbers of the training.
  */
 class MulticlassEvaluator : public Evaluator
 {
@@ -51,17 +64,24 @@ class MulticlassEvaluator : public Evaluator
   Logger* logger;
   Stopwatch* stopwatch;
   int iteration;
+  EvaluationWorker* worker;
 public:
   /**
    * Create MulticlassEvaluator.
    * @param interval logging interval, the learner will be evaluated after
    *                 *interval* iterations
    * @param target target of the logger
+   * @param asynchronous evaluate parameter snapshots in a background thread
    */
   MulticlassEvaluator(int interval = 1,
-                      Logger::Target target = Logger::CONSOLE);
+                      Logger::Target target = Logger::CONSOLE,
+                      bool asynchronous = false);
   virtual ~MulticlassEvaluator();
   virtual void evaluate(Learner& learner, DataSet& dataSet);
+  /**
+   * Block until all pending asynchronous evaluations have been logged.
+   */
+  void wait();
 };
 
 } // namespace OpenANN
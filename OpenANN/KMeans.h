@@ -14,10 +14,28 @@ namespace OpenANN
  *
  * K-means clustering.
  *
- * This is an iterative implementation based on mini-batch stochastic
- * gradient descent [1].
+ * The centers will be initialized with k-means++ [1]. fit() uses the greedy
+ * variant that tries several candidates for each center and runs Lloyd's
+ * algorithm on the whole dataset until the assignments do not change any
+ * more. It uses the triangle inequality to skip most distance computations
+ * [2]. fitPartial() performs one iteration of mini-batch stochastic gradient
+ * descent [3] so that the centers can be learned from very large datasets.
  *
- * [1] Sculley, D.:
+ * Distances will be computed through matrix multiplications
+ * (\f$ \|x\|^2 - 2 x^T c + \|c\|^2 \f$) and instances will be assigned to
+ * their centers in parallel.
+ *
+ * [1] Arthur, D.; Vassilvitskii, S.:
+ * k-means++: The advantages of careful seeding,
+ * Proceedings of the 18th annual ACM-SIAM symposium on Discrete algorithms,
+ * pp. 1027-1035, 2007.
+ *
+ * [2] Hamerly, G.:
+ * Making k-means even faster,
+ * Proceedings of the 2010 SIAM international conference on data mining,
+ * pp. 130-140, 2010.
+ *
+ * [3] Sculley, D.:
  * Web-scale k-means clustering,
  * Proceedings of the 19th international conference on World wide web,
  * pp. 1177-1178, ISBN 978-1-60558-799-8, 2010.
@@ -26,6 +44,7 @@ class KMeans : public Transformer
 {
   const int D;
   const int K;
+  int maxIterations;
   Eigen::MatrixXd C;
   Eigen::VectorXi v;
   bool initialized;
@@ -36,14 +55,18 @@ public:
    * Create KMeans object.
    * @param D number of features
    * @param K number of centers
+   * @param maxIterations maximum number of iterations of fit()
    */
-  KMeans(int D, int K);
+  KMeans(int D, int K, int maxIterations = 100);
 
   virtual Transformer& fit(const Eigen::MatrixXd& X);
+  virtual Transformer& fitPartial(const Eigen::MatrixXd& X);
   virtual Eigen::MatrixXd transform(const Eigen::MatrixXd& X)
   {
     return (*this)(X);
   }
+  virtual bool save(std::ostream& stream);
+  virtual bool load(std::istream& stream);
 
   /**
    * Compute for each instance the distances to the centers.
@@ -60,8 +83,12 @@ public:
   Eigen::MatrixXd getCenters();
 
 private:
-  void initialize(const Eigen::MatrixXd& X);
+  void initialize(const Eigen::MatrixXd& X, int candidates);
+  void squaredDistances(const Eigen::MatrixXd& X, int start, int rows,
+                        Eigen::MatrixXd& Y);
   void findClusters(const Eigen::MatrixXd& X);
+  void clusterSums(const Eigen::MatrixXd& X, Eigen::MatrixXd& sums,
+                   Eigen::VectorXi& counts);
   void updateCenters(const Eigen::MatrixXd& X);
 };
 
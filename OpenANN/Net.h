@@ -5,7 +5,10 @@
 #include <OpenANN/ActivationFunctions.h>
 #include <OpenANN/Regularization.h>
 #include <OpenANN/layers/Layer.h>
+#include <OpenANN/util/AllocationTracker.h>
+#include <OpenANN/util/Metrics.h>
 #include <vector>
+#include <string>
 #include <sstream>
 
 namespace OpenANN
@@ -23,6 +26,57 @@ enum ErrorFunction
   CE   //!< Cross entropy and softmax (multiple classes)
 };
 
+/**
+ * @struct LayerProfile
+ *
+ * Accumulated runtime statistics of a layer, see Net::useProfiling().
+ *
+ * The numbers of floating point operations and moved bytes are estimated
+ * from the layer's dimensions: we assume that each parameter is used for one
+ * multiply-add per output position and instance (i.e. weights are shared
+ * across the rows and columns of the output of convolutional layers) and
+ * that inputs, outputs and parameters are each moved once per pass.
+ */
+struct LayerProfile
+{
+  //! Type of the layer
+  std::string name;
+  //! Number of inputs per instance
+  int inputs;
+  //! Number of outputs per instance
+  int outputs;
+  //! Number of parameters
+  int parameters;
+  //! Number of forward passes
+  unsigned long forwardCalls;
+  //! Number of backward passes
+  unsigned long backwardCalls;
+  //! Number of instances in all forward passes
+  unsigned long forwardInstances;
+  //! Number of instances in all backward passes
+  unsigned long backwardInstances;
+  //! Wall time of all forward passes in seconds
+  double forwardTime;
+  //! Wall time of all backward passes in seconds
+  double backwardTime;
+  //! Estimated floating point operations of all forward passes
+  double forwardFlops;
+  //! Estimated floating point operations of all backward passes
+  double backwardFlops;
+  //! Estimated bytes moved by all forward and backward passes
+  double bytes;
+  //! Heap allocations of all passes, see AllocationTracker
+  unsigned long allocations;
+  //! Bytes requested by all heap allocations
+  double allocatedBytes;
+
+  LayerProfile();
+  /**
+   * Reset all counters.
+   */
+  void reset();
+};
+
 /**
  * @class Net
  *
@@ -41,8 +95,14 @@ protected:
   Regularization regularization;
   ErrorFunction errorFunction;
   bool dropout;
+  bool profiling;
+  std::vector<LayerProfile> profiles;
+  //! Layer names interned for the Tracer
+  std::vector<const char*> spanNames;
+  Metrics* metrics;
 
   bool initialized;
+  bool storable;
   int P, L;
   Eigen::VectorXd parameterVector, tempGradient;
   Eigen::MatrixXd tempInput, tempOutput, tempError;
@@ -95,11 +155,14 @@ public:
    * @param stdDev standard deviation of the Gaussian distributed initial
    *               weights
    * @param backprop finetune weights with backpropagation
+   * @param persistentChains number of persistent Gibbs chains for
+   *                         pretraining with PCD, 0 means CD-n
    * @return this for chaining
    */
   Net& restrictedBoltzmannMachineLayer(int H, int cdN = 1,
                                        double stdDev = 0.01,
-                                       bool backprop = true);
+                                       bool backprop = true,
+                                       int persistentChains = 0);
   /**
    * Add a sparse auto-encoder.
    * @param H number of outputs
@@ -193,8 +256,10 @@ public:
   /**
    * Add a dropout layer.
    * @param dropoutProbability probability of suppression during training
+   * @param inverted scale the outputs during training instead of scaling
+   *                 them down after training, see Dropout
    */
-  Net& dropoutLayer(double dropoutProbability);
+  Net& dropoutLayer(double dropoutProbability, bool inverted = true);
   /**
    * Add a fully connected output layer. This will initialize the network.
    * @param units number of nodes (neurons)
@@ -225,7 +290,8 @@ public:
   /**
    * Add a new layer to this deep neural network.
    * Never free/delete the added layer outside of this class.
-   * Its cleaned up by Net's destructor automatically.
+   * Its cleaned up by Net's destructor automatically. The network cannot be
+   * saved afterwards, see isStorable().
    * @param layer pointer to an instance that implements the Layer interface
    * @return this for chaining
    */
@@ -233,7 +299,8 @@ public:
   /**
    * Add a new output layer to this deep neural network.
    * Never free/delete the added layer outside of this class.
-   * Its cleaned up by Net's destructor automatically.
+   * Its cleaned up by Net's destructor automatically. The network cannot be
+   * saved afterwards, see isStorable().
    * @param layer pointer to an instance that implements the Layer interface
    * @return this for chaining
    */
@@ -274,6 +341,21 @@ public:
    * @name Persistence
    */
   ///@{
+  /**
+   * Check whether save() stores the whole network. This is not the case if
+   * layers have been added with addLayer() or addOutputLayer().
+   * @return true if load() can reconstruct the network
+   */
+  bool isStorable();
+  /**
+   * Check whether a network that has been constructed with save() and
+   * load() computes the same outputs with the same parameters. This is not
+   * the case if the network cannot be stored completely, if it contains
+   * layers with random matrices that are not stored (compressed and extreme
+   * layers) or layers with an internal state (alpha-beta filters).
+   * @return true if the network can be replicated
+   */
+  bool isReplicable();
   /**
    * Save network.
    * @param fileName name of the file
@@ -331,6 +413,87 @@ net2.load("mlnn.net");
    * @return this for chaining
    */
   Net& useDropout(bool activate = true);
+  /**
+   * Train the output layer in closed form.
+   *
+   * The training set is propagated in blocks through all layers except the
+   * output layer and the weights of the fully connected output layer are
+   * computed by ridge regression, i.e. we solve
+   * \f$ (H^T H + \lambda I) W^T = H^T T \f$ with a Cholesky decomposition,
+   * where \f$ \lambda \f$ is the L2 penalty. All other layers remain
+   * unchanged, so this is the training algorithm of extreme learning
+   * machines. The activations of the output layer are fitted to the
+   * targets, hence the result is optimal for linear outputs.
+   * @param blockSize number of instances that will be propagated at once
+   * @return this for chaining
+   */
+  Net& fitOutputLayer(int blockSize = 1024);
+  ///@}
+
+  /**
+   * @name Profiling
+   */
+  ///@{
+  /**
+   * Toggle profiling.
+   *
+   * If profiling is activated, the wall time, number of calls, batch sizes,
+   * and estimated numbers of floating point operations and moved bytes of
+   * each layer's forward and backward passes will be recorded. Heap
+   * allocations will be counted if the library has been built with
+   * TRACK_ALLOCATIONS. Deactivated profiling costs only one branch per
+   * propagation.
+   * @param activate turn profiling on or off
+   * @return this for chaining
+   */
+  Net& useProfiling(bool activate = true);
+  /**
+   * Reset the recorded statistics of all layers.
+   * @return this for chaining
+   */
+  Net& resetProfile();
+  /**
+   * Access the recorded statistics.
+   * @return one entry per layer
+   */
+  const std::vector<LayerProfile>& getProfile();
+  /**
+   * Summarize the recorded statistics.
+   * @param json generate JSON instead of a human readable table
+   * @return report
+   */
+  std::string profileReport(bool json = false);
+  ///@}
+
+  /**
+   * @name Inference
+   * Predict single instances without heap allocations, e.g. in control loops.
+   */
+  ///@{
+  /**
+   * Make a prediction.
+   *
+   * All intermediate results are stored in buffers of the layers that will
+   * be reused. After the first call, this function neither allocates memory
+   * nor starts threads if y already has the correct size. Dropout and
+   * profiling are ignored.
+   *
+   * @param x input vector
+   * @param y output vector, will be resized if necessary
+   */
+  void predict(const Eigen::VectorXd& x, Eigen::VectorXd& y);
+  /**
+   * Make predictions.
+   *
+   * Buffers will be reused as long as the number of instances does not
+   * change. Dropout and profiling are ignored. BatchPredictor splits large
+   * data sets into small batches that will be processed in parallel.
+   *
+   * @param X each row represents an input vector
+   * @param Y each row represents an output vector, will be resized if
+   *          necessary
+   */
+  void predict(const Eigen::MatrixXd& X, Eigen::MatrixXd& Y);
   ///@}
 
   /**
@@ -356,12 +519,18 @@ net2.load("mlnn.net");
                              std::vector<int>::const_iterator endN,
                              double& value, Eigen::VectorXd& grad);
   virtual void finishedIteration();
+  virtual void setMetrics(Metrics* metrics);
   ///@}
 
 protected:
+  Net& appendLayer(Layer* layer);
   void initializeNetwork();
   void forwardPropagate(double* error);
   void backpropagate();
+  void recordForward(int l, int N, double time,
+                     const AllocationTracker& tracker);
+  void recordBackward(int l, int N, double time,
+                      const AllocationTracker& tracker);
 };
 
 } // namespace OpenANN
@@ -11,16 +11,36 @@ namespace OpenANN
  * @class Normalization
  * Normalize data so that for each feature the mean is 0 and the standard
  * deviation is 1.
+ *
+ * The mean and the standard deviation can be accumulated incrementally with
+ * fitPartial(). Each batch will be split into chunks that are processed in
+ * parallel and the statistics of the chunks will be merged with the
+ * numerically stable update of Chan et al. [1].
+ *
+ * [1] T. F. Chan, G. H. Golub, R. J. LeVeque:
+ * Algorithms for Computing the Sample Variance: Analysis and Recommendations,
+ * The American Statistician 37 (3), pp. 242-247, 1983.
  */
 class Normalization : public Transformer
 {
+  int samples;
   Eigen::MatrixXd mean;
+  Eigen::MatrixXd sumOfSquares;
   Eigen::MatrixXd std;
 public:
   Normalization();
 
   virtual Transformer& fit(const Eigen::MatrixXd& X);
+  virtual Transformer& fitPartial(const Eigen::MatrixXd& X);
   virtual Eigen::MatrixXd transform(const Eigen::MatrixXd& X);
+  virtual bool affine(Eigen::MatrixXd& W, Eigen::VectorXd& b);
+  virtual bool save(std::ostream& stream);
+  virtual bool load(std::istream& stream);
+  /**
+   * Normalize the data without copying it.
+   * @param X each row represents an instance, will be overwritten
+   */
+  void transformInPlace(Eigen::MatrixXd& X);
 
   /**
    * Get the mean of the original data.
@@ -32,6 +52,9 @@ public:
    * @return standard deviations
    */
   Eigen::VectorXd getStd();
+private:
+  void merge(int samples, const Eigen::MatrixXd& mean,
+             const Eigen::MatrixXd& sumOfSquares);
 };
 
 } // namespace OpenANN
@@ -2,6 +2,7 @@
 #define OPENANN_PCA_H_
 
 #include <OpenANN/Transformer.h>
+#include <OpenANN/util/OnlineCovariance.h>
 #include <Eigen/Core>
 
 namespace OpenANN
@@ -10,11 +11,61 @@ namespace OpenANN
 /**
  * @class PCA
  * Principal component analysis.
+ *
+ * There are several ways to compute the principal components:
+ *
+ * - SVD: singular value decomposition of the centered data matrix. This is
+ *   numerically the most accurate solver but it is slow and requires a copy
+ *   of the whole dataset.
+ * - COVARIANCE: eigendecomposition of the D x D covariance matrix. This is
+ *   much faster if there are more instances than features (N >> D).
+ * - RANDOMIZED: randomized truncated SVD [1]. Only the required components
+ *   will be approximated. This is much faster if we only need a few
+ *   components of high-dimensional data.
+ *
+ * By default (AUTO), the solver will be selected according to the shape of
+ * the data and the number of components. AUTO uses the randomized solver if
+ * \f$ 6 (k + 10) < \min(N, D) \f$ for k components, i.e. only large
+ * datasets of which we need only a few components will be transformed
+ * approximately. Otherwise it uses COVARIANCE if N >= D and SVD if N < D.
+ * Select SVD or COVARIANCE explicitly if the exact components are required.
+ *
+ * Features without variance are allowed: the explained variance ratio of
+ * constant data is 0 and whitening does not scale components without
+ * variance.
+ *
+ * fitPartial() accumulates the mean and the covariance matrix of all
+ * instances that have been passed since the last call of fit() and always
+ * uses the covariance solver. The eigendecomposition will be computed only
+ * once when the transformation is required. Hence, PCA can be fitted to
+ * datasets that do not fit into memory in one pass with \f$ O(D^2) \f$
+ * memory.
+ *
+ * [1] N. Halko, P. G. Martinsson, J. A. Tropp:
+ * Finding structure with randomness: Probabilistic algorithms for
+ * constructing approximate matrix decompositions,
+ * SIAM Review 53 (2), pp. 217-288, 2011.
  */
 class PCA : public Transformer
 {
+public:
+  /**
+   * Algorithm that computes the principal components.
+   */
+  enum Solver
+  {
+    AUTO,       //!< select solver based on the shape of the data
+    SVD,        //!< full SVD of the data matrix
+    COVARIANCE, //!< eigendecomposition of the covariance matrix
+    RANDOMIZED  //!< randomized truncated SVD
+  };
+
+private:
   int components;
   bool whiten;
+  Solver solver;
+  OnlineCovariance statistics;
+  bool outdated;
   Eigen::VectorXd mean;
   Eigen::MatrixXd W;
   Eigen::VectorXd evr;
@@ -23,11 +74,16 @@ public:
    * Create PCA.
    * @param components number of dimensions after transformation
    * @param whiten outputs should have variance 1
+   * @param solver algorithm that computes the principal components
    */
-  PCA(int components, bool whiten = true);
+  PCA(int components, bool whiten = true, Solver solver = AUTO);
 
   virtual Transformer& fit(const Eigen::MatrixXd& X);
+  virtual Transformer& fitPartial(const Eigen::MatrixXd& X);
   virtual Eigen::MatrixXd transform(const Eigen::MatrixXd& X);
+  virtual bool affine(Eigen::MatrixXd& W, Eigen::VectorXd& b);
+  virtual bool save(std::ostream& stream);
+  virtual bool load(std::istream& stream);
 
   /**
    * Get the ratio of explained variance for each transformed feature.
@@ -35,6 +91,13 @@ public:
    *         for all features (including discarded features)
    */
   Eigen::VectorXd explainedVarianceRatio();
+
+private:
+  Solver selectSolver(int N, int D);
+  void fitSVD(const Eigen::MatrixXd& X, Eigen::VectorXd& S);
+  void fitRandomized(const Eigen::MatrixXd& X, Eigen::VectorXd& S);
+  void update();
+  void finish(const Eigen::VectorXd& S, double totalVariance);
 };
 
 } // namespace OpenANN
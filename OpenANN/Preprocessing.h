@@ -22,7 +22,15 @@ void scaleData(Eigen::MatrixXd& data, double min = -1.0, double max = 1.0);
 
 /**
  * Apply a (numerically stable) filter (FIR or IIR) on the input signal.
- * @param x input signal
+ *
+ * The filter is defined by the difference equation
+ * \f$ a_0 y_t = \sum_{k=0}^{P} b_k x_{t-k} - \sum_{k=1}^{Q} a_k y_{t-k} \f$.
+ * The beginning of the input signal will be mirrored, i.e.
+ * \f$ x_{-t} = x_t \f$, to compute the first outputs. IIR filters will be
+ * evaluated in transposed direct form II. All channels will be processed
+ * simultaneously.
+ *
+ * @param x input signal, each row represents a channel
  * @param y output, filtered signal
  * @param b feedforward filter coefficients
  * @param a feedback filter coefficients
@@ -32,12 +40,31 @@ void filter(const Eigen::MatrixXd& x, Eigen::MatrixXd& y,
 
 /**
  * Downsample an input signal.
- * @param y input signal
- * @param d downsampled signal
+ * @param y input signal, each row represents a channel
+ * @param d downsampled signal, the number of columns determines the number
+ *          of samples that will be extracted
  * @param downSamplingFactor downsampling factor
  */
 void downsample(const Eigen::MatrixXd& y, Eigen::MatrixXd& d, int downSamplingFactor);
 
+/**
+ * Filter and downsample an input signal.
+ *
+ * This is equivalent to filter() followed by downsample() but it does not
+ * require a temporary copy of the signal and FIR filters will only compute
+ * the outputs that will be retained.
+ *
+ * @param x input signal, each row represents a channel
+ * @param d filtered and downsampled signal, the number of columns
+ *          determines the number of samples that will be extracted
+ * @param b feedforward filter coefficients
+ * @param a feedback filter coefficients
+ * @param downSamplingFactor downsampling factor
+ */
+void filterAndDownsample(const Eigen::MatrixXd& x, Eigen::MatrixXd& d,
+                         const Eigen::MatrixXd& b, const Eigen::MatrixXd& a,
+                         int downSamplingFactor);
+
 /**
  * Extract random patches from a images.
  * @param images each row contains an original image
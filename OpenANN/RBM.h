@@ -35,6 +35,12 @@ class RandomNumberGenerator;
  * which was the major breakthrouh in deep learning. There are also other ways
  * to make deep learning work, e.g. CNNs (weight sharing), ReLUs, maxout, etc.
  *
+ * The negative phase of the gradient can either be estimated with CD-n,
+ * i.e. the Gibbs chains are started at the training data, or with
+ * persistent contrastive divergence (PCD) [3], i.e. a pool of fantasy
+ * particles is kept between parameter updates and advanced by n Gibbs steps
+ * for each mini-batch.
+ *
  * Supports the following regularization types:
  *
  * - L1 penalty
@@ -47,17 +53,25 @@ class RandomNumberGenerator;
  * [2] Hinton, Geoffrey E.:
  * Training Products of Experts by Minimizing Contrastive Divergence,
  * Technical Report, University College London, 2000.
+ *
+ * [3] Tieleman, Tijmen:
+ * Training Restricted Boltzmann Machines using Approximations to the
+ * Likelihood Gradient,
+ * Proceedings of the 25th International Conference on Machine Learning,
+ * 2008, pp. 1064-1071.
  */
 class RBM : public Learner, public Layer
 {
   RandomNumberGenerator* rng;
   int D, H;
   int cdN;
+  int persistentChains;
   double stdDev;
   Eigen::MatrixXd W, posGradW, negGradW, Wd;
   Eigen::VectorXd bv, posGradBv, negGradBv, bh, posGradBh, negGradBh, bhd;
   Eigen::MatrixXd pv, v, ph, h, phd;
   Eigen::MatrixXd deltas, e;
+  Eigen::MatrixXd u, fantasy;
   int K;
   Eigen::VectorXd params, grad;
   bool backprop;
@@ -73,9 +87,12 @@ public:
    * @param stdDev standard deviation of initial weights
    * @param backprop weights can be finetuned with backprop
    * @param regularization regularization coefficients
+   * @param persistentChains number of persistent Gibbs chains (fantasy
+   *                         particles) for PCD, 0 means CD-n
    */
   RBM(int D, int H, int cdN = 1, double stdDev = 0.01, bool backprop = true,
-      Regularization regularization = Regularization());
+      Regularization regularization = Regularization(),
+      int persistentChains = 0);
   virtual ~RBM();
 
   // Learner interface
@@ -119,6 +136,11 @@ public:
    * @return number of hidden units
    */
   int hiddenUnits();
+  /**
+   * Get number of persistent Gibbs chains.
+   * @return number of fantasy particles, 0 if CD-n is used
+   */
+  int persistentGibbsChains();
   /**
    * Get the current weight matrix.
    * @return weight matrix
@@ -154,6 +176,7 @@ private:
   void reality();
   void daydream();
   void fillGradient();
+  void sample(Eigen::MatrixXd& p, Eigen::MatrixXd& s);
 };
 
 } // namespace OpenANN
@@ -16,6 +16,16 @@ namespace OpenANN
  * distance to the desired mean activation of the hidden nodes as well as the
  * reconstruction error. Sparse auto-encoders (SAEs) can be used to train
  * multiple layers of feature detectors unsupervised.
+ *
+ * SAEs can be trained with batch methods (e.g. LBFGS) or with mini-batches
+ * (e.g. MBSGD). In the latter case, the mean activation of the hidden nodes
+ * that is required for the sparsity penalty is estimated with an exponential
+ * moving average over the mini-batches. The estimate will be reset when the
+ * auto-encoder is initialized, when the training set changes and when the
+ * parameters are replaced, i.e. setParameters() is called without a
+ * mini-batch gradient since the last call (e.g. when parameters are loaded
+ * or after an optimizer has returned its result). Updates of an optimizer
+ * between mini-batches keep the estimate.
  */
 class SparseAutoEncoder : public Learner, public Layer
 {
@@ -27,8 +37,11 @@ class SparseAutoEncoder : public Learner, public Layer
   Eigen::VectorXd b1, b2, b1d, b2d;
   Eigen::MatrixXd A1, Z1, G1D, A2, Z2, G2D;
   Eigen::VectorXd parameters, grad;
-  Eigen::MatrixXd dEdZ2, dEdZ1;
-  Eigen::VectorXd meanActivation;
+  Eigen::MatrixXd dEdZ2, dEdZ1, deltas2, deltas1;
+  Eigen::VectorXd meanActivation, batchMeanActivation, runningMeanActivation;
+  //! A mini-batch has been evaluated since the parameters have been set
+  bool batchEvaluated;
+  Eigen::MatrixXd XBatch;
 public:
   /**
    * Sparse auto-encoder.
@@ -50,10 +63,15 @@ public:
   virtual unsigned int dimension();
   virtual void setParameters(const Eigen::VectorXd& parameters);
   virtual const Eigen::VectorXd& currentParameters();
+  virtual unsigned int examples();
   virtual double error();
+  virtual double error(unsigned int n);
   virtual bool providesGradient();
   virtual Eigen::VectorXd gradient();
   virtual void errorGradient(double& value, Eigen::VectorXd& grad);
+  virtual void errorGradient(std::vector<int>::const_iterator startN,
+                             std::vector<int>::const_iterator endN,
+                             double& value, Eigen::VectorXd& grad);
   virtual Learner& trainingSet(DataSet& trainingSet);
 
   // Layer interface
@@ -72,6 +90,13 @@ public:
   Eigen::MatrixXd getInputWeights();
   Eigen::MatrixXd getOutputWeights();
   Eigen::VectorXd reconstruct(const Eigen::VectorXd& x);
+
+private:
+  double reconstructionError(const Eigen::MatrixXd& X);
+  double sparsityPenalty(const Eigen::VectorXd& rhoHat);
+  void backpropagateError(const Eigen::MatrixXd& X,
+                          const Eigen::VectorXd& rhoHat,
+                          Eigen::VectorXd& grad);
 };
 
 } // OpenANN
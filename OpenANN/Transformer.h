@@ -2,6 +2,8 @@
 #define OPENANN_TRANSFORMER_H_
 
 #include <Eigen/Core>
+#include <istream>
+#include <ostream>
 
 namespace OpenANN
 {
@@ -39,6 +41,38 @@ public:
    * @return transformed data
    */
   virtual Eigen::MatrixXd transform(const Eigen::MatrixXd& X) = 0;
+  /**
+   * Get the parameters of an affine transformation.
+   * Affine transformations can be written as \f$ Y = X W + 1 b^T \f$.
+   * Adjacent affine transformations can be combined to one.
+   * @param W weight matrix, each column corresponds to an output
+   * @param b bias, one entry for each output
+   * @return false if the transformation is not affine
+   */
+  virtual bool affine(Eigen::MatrixXd& /* W */, Eigen::VectorXd& /* b */)
+  {
+    return false;
+  }
+  /**
+   * Store the fitted transformation.
+   * @param stream binary output stream
+   * @return false if the transformation cannot be stored
+   */
+  virtual bool save(std::ostream& /* stream */)
+  {
+    return false;
+  }
+  /**
+   * Restore a transformation that has been stored with save().
+   * The transformation must have been constructed with the same parameters,
+   * it will not be modified if the stored state does not match.
+   * @param stream binary input stream
+   * @return false if the state could not be restored
+   */
+  virtual bool load(std::istream& /* stream */)
+  {
+    return false;
+  }
 };
 
 } // namespace OpenANN
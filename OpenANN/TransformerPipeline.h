@@ -0,0 +1,118 @@
+#ifndef OPENANN_TRANSFORMER_PIPELINE_H_
+#define OPENANN_TRANSFORMER_PIPELINE_H_
+
+#include <OpenANN/Transformer.h>
+#include <Eigen/Core>
+#include <string>
+#include <vector>
+
+namespace OpenANN
+{
+
+/**
+ * @class TransformerPipeline
+ *
+ * Chain of transformations.
+ *
+ * Each transformation will be fitted to the output of its predecessors.
+ * Adjacent affine transformations (see Transformer::affine()), e.g.
+ * Normalization, PCA and ZCAWhitening, will be combined to a single matrix
+ * multiplication. The data will be transformed in blocks of instances so
+ * that only the output and the intermediate results of one block have to be
+ * stored.
+ *
+ * Optionally, transformed datasets can be cached in a directory. The name
+ * of the file that transform() uses depends on a hash of the input and of
+ * the transformed first instances, i.e. a dataset will only be loaded if the
+ * input and the fitted transformations are the same. fitTransform() also
+ * stores the fitted transformations (see Transformer::save()) so that
+ * fitting can be skipped for a known input. Files will be written to a
+ * temporary file first and renamed afterwards so that concurrent processes
+ * never read incomplete files.
+ */
+class TransformerPipeline : public Transformer
+{
+  struct Stage
+  {
+    Transformer* transformer;
+    Eigen::MatrixXd W;
+    Eigen::VectorXd b;
+  };
+
+  std::vector<Transformer*> transformers;
+  int blockSize;
+  std::string cacheDirectory;
+public:
+  /**
+   * Create an empty pipeline.
+   * @param blockSize number of instances that will be transformed at once
+   */
+  TransformerPipeline(int blockSize = 1024);
+  /**
+   * Append a transformation.
+   * @param transformer transformation, will not be deleted by the pipeline
+   * @return this for chaining
+   */
+  TransformerPipeline& add(Transformer& transformer);
+  /**
+   * Cache transformed datasets.
+   * @param directory existing directory where the datasets will be stored,
+   *                  an empty string disables the cache
+   * @return this for chaining
+   */
+  TransformerPipeline& cache(const std::string& directory);
+  /**
+   * Get the name of the file that contains the cached transformed dataset.
+   * @param X each row represents an instance
+   * @return file name, empty if there is no cache directory
+   */
+  std::string cacheFileName(const Eigen::MatrixXd& X);
+  /**
+   * Get the name of the file that contains the cached fitted transformations
+   * and the transformed dataset of fitTransform().
+   * @param X each row represents an instance
+   * @return file name, empty if there is no cache directory
+   */
+  std::string fittedCacheFileName(const Eigen::MatrixXd& X);
+  /**
+   * Fit the transformations to X and transform X.
+   * The result is the same as the result of fit() and transform(). If a
+   * cache directory is set, the fitted transformations and the transformed
+   * dataset will be loaded from the cache if the pipeline has already been
+   * fitted to the same input with the same configuration, i.e. block size,
+   * types and parameters of the transformations. Otherwise they will be
+   * stored if all transformations support Transformer::save().
+   * @param X each row represents an instance
+   * @return transformed data
+   */
+  Eigen::MatrixXd fitTransform(const Eigen::MatrixXd& X);
+
+  /**
+   * Fit the transformations one after another. The input of each
+   * transformation will be computed block-wise from X with the fitted
+   * predecessors so that at most one intermediate dataset is stored.
+   * @param X each row represents an instance
+   * @return this for chaining
+   */
+  virtual Transformer& fit(const Eigen::MatrixXd& X);
+  /**
+   * Update the transformations one after another. Each transformation will
+   * be updated with Transformer::fitPartial() for each block of instances,
+   * i.e. no intermediate dataset has to be stored.
+   * @param X each row represents an instance
+   * @return this for chaining
+   */
+  virtual Transformer& fitPartial(const Eigen::MatrixXd& X);
+  virtual Eigen::MatrixXd transform(const Eigen::MatrixXd& X);
+  virtual bool affine(Eigen::MatrixXd& W, Eigen::VectorXd& b);
+
+private:
+  std::string cacheFileName(std::vector<Stage>& stages,
+                            const Eigen::MatrixXd& X, int& outputs);
+  void fuse(std::vector<Stage>& stages, size_t count);
+  Eigen::MatrixXd apply(std::vector<Stage>& stages, const Eigen::MatrixXd& X);
+};
+
+} // namespace OpenANN
+
+#endif // OPENANN_TRANSFORMER_PIPELINE_H_
@@ -2,6 +2,7 @@
 #define OPENANN_ZCA_WHITENING_H_
 
 #include <OpenANN/Transformer.h>
+#include <OpenANN/util/OnlineCovariance.h>
 #include <Eigen/Core>
 
 namespace OpenANN
@@ -16,14 +17,27 @@ namespace OpenANN
  * covariance matrix \f$ C = \frac{1}{n-1} Y^T Y \f$ will be \f$ I \f$ and
  * \f$ W = W^T \f$. This is essentially a PCA and a transformation back to
  * the original space.
+ *
+ * The mean and the covariance matrix can be accumulated incrementally with
+ * fitPartial() so that the whole dataset does not have to be in memory. The
+ * transformation will be computed when it is required.
  */
 class ZCAWhitening : public Transformer
 {
+  OnlineCovariance statistics;
+  bool outdated;
   Eigen::VectorXd mean;
   Eigen::MatrixXd W;
 public:
+  ZCAWhitening();
   virtual Transformer& fit(const Eigen::MatrixXd& X);
+  virtual Transformer& fitPartial(const Eigen::MatrixXd& X);
   virtual Eigen::MatrixXd transform(const Eigen::MatrixXd& X);
+  virtual bool affine(Eigen::MatrixXd& W, Eigen::VectorXd& b);
+  virtual bool save(std::ostream& stream);
+  virtual bool load(std::istream& stream);
+private:
+  void update();
 };
 
 } // namespace OpenANN
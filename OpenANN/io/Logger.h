@@ -83,6 +83,14 @@ struct FloatingPointFormatter
  * @class Log
  *
  * Global logger.
+ *
+ * By default, messages of Log and Logger are written asynchronously: they
+ * are formatted by the calling thread and appended to a lock-free ring
+ * buffer. A background thread writes them in batches and flushes each
+ * target once per batch. Messages of one thread keep their order. Error
+ * messages and destroyed file loggers wait until all pending messages have
+ * been written. Call flush() before you read a target or write to it
+ * directly.
  */
 class Log
 {
@@ -100,10 +108,32 @@ public:
 
   std::ostream& get(LogLevel level, const char* name_space);
 
+  /**
+   * Set the stream of all following messages. Pending messages will be
+   * written to the previous stream before it is replaced.
+   * @param stream output stream, must exist until it is replaced
+   */
   static void setStream(std::ostream& stream);
   static std::ostream& getStream();
   static LogLevel& getLevel();
 
+  /**
+   * Toggle asynchronous writing.
+   * @param asynchronous write messages in a background thread, otherwise
+   *                     each message will be written and flushed directly
+   */
+  static void setAsynchronous(bool asynchronous);
+  /**
+   * Wait until all pending messages have been written and flushed.
+   */
+  static void flush();
+  /**
+   * Write a message to a stream, see setAsynchronous().
+   * @param stream target
+   * @param text formatted message
+   */
+  static void write(std::ostream& stream, const std::string& text);
+
   static void setDisabled();
   static void setError();
   static void setInfo();
@@ -148,6 +178,11 @@ public:
    * @return is the logger activated?
    */
   bool isActive();
+  /**
+   * Write formatted text to the target.
+   * @param text message
+   */
+  void write(const std::string& text);
 };
 
 
@@ -156,17 +191,11 @@ Logger& operator<<(Logger& logger, const FloatingPointFormatter& t);
 template<typename T>
 Logger& operator<<(Logger& logger, const T& t)
 {
-  switch(logger.target)
+  if(logger.target != Logger::NONE)
   {
-  case Logger::CONSOLE:
-    std::cout << t << std::flush;
-    break;
-  case Logger::APPEND_FILE:
-  case Logger::FILE:
-    logger.file << t << std::flush;
-    break;
-  default: // do not log
-    break;
+    std::ostringstream text;
+    text << t;
+    logger.write(text.str());
   }
   return logger;
 }
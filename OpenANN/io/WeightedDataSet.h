@@ -13,7 +13,9 @@ namespace OpenANN
  * Resampled dataset based on the original dataset.
  *
  * The probability of each instance to occur in the dataset is defined by the
- * given weights. Note that the weights must sum up to one.
+ * given weights. Note that the weights must sum up to one. Resampling
+ * requires O(N log N) steps (O(N) in deterministic mode) because the
+ * instances are looked up in the cumulative weights.
  */
 class WeightedDataSet : public DataSet
 {
@@ -21,6 +23,7 @@ class WeightedDataSet : public DataSet
   Eigen::VectorXd weights;
   bool deterministic;
   std::vector<int> originalIndices;
+  std::vector<double> cumulativeWeights;
 public:
   /**
    * @param dataSet original dataset
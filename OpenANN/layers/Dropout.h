@@ -2,6 +2,8 @@
 #define OPENANN_LAYERS_DROPOUT_H_
 
 #include <OpenANN/layers/Layer.h>
+#include <vector>
+#include <stdint.h>
 
 namespace OpenANN
 {
@@ -13,8 +15,14 @@ namespace OpenANN
  *
  * The dropout technique tries to minimize similarities of neurons in one
  * layer by randomly suppressing the output of neurons during training [1].
- * After training, we use the "mean network", i.e. we reduce the output of
- * each neuron to compensate that all will be active.
+ * By default, we use "inverted dropout", i.e. the outputs of the active
+ * neurons are scaled up by \f$ 1 / (1 - p) \f$ during training so that the
+ * layer does not modify its input after training. Otherwise, the outputs
+ * are not scaled during training and scaled down by \f$ 1 - p \f$ after
+ * training, which is required by networks that have been stored with the
+ * token "dropout" instead of "inverted_dropout" (see Net::save()). The
+ * dropout mask is stored as a bit mask and applied together with the
+ * scaling in one pass.
  *
  * [1] Hinton, G. E., Srivastava, N., Krizhevsky, A., Sutskever, I. and
  * Salakhutdinov, R. R.:
@@ -26,11 +34,14 @@ class Dropout : public Layer
   OutputInfo info;
   int I;
   double dropoutProbability;
-  Eigen::MatrixXd dropoutMask;
+  bool inverted;
+  bool masked;
+  std::vector<uint32_t> dropoutMask;
+  Eigen::MatrixXd* output;
   Eigen::MatrixXd y;
   Eigen::MatrixXd e;
 public:
-  Dropout(OutputInfo info, double dropoutProbability);
+  Dropout(OutputInfo info, double dropoutProbability, bool inverted = true);
   virtual OutputInfo initialize(std::vector<double*>& parameterPointers,
                                 std::vector<double*>& parameterDerivativePointers);
   virtual void initializeParameters() {}
@@ -41,6 +52,10 @@ public:
                              bool backpropToPrevious);
   virtual Eigen::MatrixXd& getOutput();
   virtual Eigen::VectorXd getParameters();
+private:
+  void applyMask(const Eigen::MatrixXd& in, Eigen::MatrixXd& out);
+  void scaleAfterTraining(Eigen::MatrixXd* in, Eigen::MatrixXd*& out,
+                          Eigen::MatrixXd& buffer);
 };
 
 } // namespace OpenANN
@@ -34,6 +34,8 @@ public:
   ~CG();
   virtual void setOptimizable(Optimizable& opt);
   virtual void setStopCriteria(const StoppingCriteria& stop);
+  virtual Optimizer* clone();
+  virtual bool isCloneable() { return true; }
   virtual bool step();
   virtual void optimize();
   virtual Eigen::VectorXd result();
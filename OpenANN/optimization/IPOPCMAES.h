@@ -72,6 +72,8 @@ public:
   virtual ~IPOPCMAES();
   virtual void setOptimizable(Optimizable& opt);
   virtual void setStopCriteria(const StoppingCriteria& stop);
+  virtual Optimizer* clone();
+  virtual bool isCloneable() { return true; }
   /**
    * Restart the optimizer.
    * @return optimizer is still running
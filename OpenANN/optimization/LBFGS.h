@@ -39,6 +39,8 @@ public:
   LBFGS(int m = 10);
   virtual ~LBFGS() {}
   virtual void setStopCriteria(const StoppingCriteria& stop);
+  virtual Optimizer* clone();
+  virtual bool isCloneable() { return true; }
   virtual void setOptimizable(Optimizable& optimizable);
   virtual void optimize();
   virtual bool step();
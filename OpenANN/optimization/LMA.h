@@ -57,6 +57,8 @@ public:
   virtual ~LMA();
   virtual void setOptimizable(Optimizable& opt);
   virtual void setStopCriteria(const StoppingCriteria& stop);
+  virtual Optimizer* clone();
+  virtual bool isCloneable() { return true; }
   virtual void optimize();
   virtual bool step();
   virtual Eigen::VectorXd result();
@@ -121,12 +121,16 @@ class MBSGD : public Optimizer
   Optimizable* opt; // do not delete
   //! Use nesterov's accelerated momentum
   bool nesterov;
+  //! Initial learning rate
+  double alpha0;
   //! Learning rate
   double alpha;
   //! Learning rate decay
   double alphaDecay;
   //! Minimum learning rat
   double minAlpha;
+  //! Initial momentum
+  double eta0;
   //! Momentum
   double eta;
   //! Momentum gain
@@ -175,6 +179,8 @@ public:
   ~MBSGD();
   virtual void setOptimizable(Optimizable& opt);
   virtual void setStopCriteria(const StoppingCriteria& stop);
+  virtual Optimizer* clone();
+  virtual bool isCloneable() { return true; }
   virtual void optimize();
   virtual bool step();
   virtual Eigen::VectorXd result();
@@ -10,6 +10,8 @@
 namespace OpenANN
 {
 
+class Metrics;
+
 /**
  * @class Optimizable
  *
@@ -143,6 +145,14 @@ public:
    * This callback is called after each optimization algorithm iteration.
    */
   virtual void finishedIteration() {}
+
+  /**
+   * Pass the metrics of the optimization algorithm so that the objective
+   * function can record details of its computation. Optimizers set the
+   * metrics at the beginning of a step and reset them at its end.
+   * @param metrics metrics of the optimizer, 0 disables recording
+   */
+  virtual void setMetrics(Metrics* metrics) {}
 };
 
 } // namespace OpenANN
@@ -1,6 +1,7 @@
 #ifndef OPENANN_OPTIMIZATION_OPTIMIZER_H_
 #define OPENANN_OPTIMIZATION_OPTIMIZER_H_
 
+#include <OpenANN/util/Metrics.h>
 #include <Eigen/Core>
 #include <string>
 
@@ -17,6 +18,9 @@ class StoppingCriteria;
  */
 class Optimizer
 {
+protected:
+  //! Training progress
+  Metrics metrics;
 public:
   virtual ~Optimizer() {}
   /**
@@ -42,11 +46,31 @@ public:
    * @return the best parameter the algorithm found
    */
   virtual Eigen::VectorXd result() = 0;
+  /**
+   * Create a new optimizer with the same configuration.
+   *
+   * The copy does not share any state with this optimizer so that both can
+   * be used in parallel.
+   * @return new optimizer (has to be deleted manually) or 0 if the
+   *         optimizer does not support copying
+   */
+  virtual Optimizer* clone() { return 0; }
+  /**
+   * Check whether clone() is supported.
+   * @return true if clone() creates a new optimizer
+   */
+  virtual bool isCloneable() { return false; }
   /**
    * Get the name of the optimization algorithm.
    * @return name of the optimization algorithm
    */
   virtual std::string name() = 0;
+  /**
+   * Get metrics of the optimization, e.g. duration of steps, throughput and
+   * estimated remaining time.
+   * @return metrics
+   */
+  Metrics& getMetrics() { return metrics; }
 };
 
 } // namespace OpenANN
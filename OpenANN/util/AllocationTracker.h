@@ -0,0 +1,69 @@
+#ifndef OPENANN_UTIL_ALLOCATION_TRACKER_H_
+#define OPENANN_UTIL_ALLOCATION_TRACKER_H_
+
+namespace OpenANN
+{
+
+/**
+ * @class AllocationTracker
+ *
+ * Counts heap allocations within a scope.
+ *
+ * Allocations will only be counted if %OpenANN has been built with the CMake
+ * option TRACK_ALLOCATIONS. In this case the library replaces malloc(),
+ * calloc() and realloc() (with glibc) or the global operator new (otherwise)
+ * so that all allocations of Eigen and the standard library will be counted.
+ * The counters are shared by all threads, i.e. allocations of OpenMP worker
+ * threads are included as well as allocations of unrelated threads.
+ *
+ * A tracker counts the allocations since its construction or the last call
+ * of reset(), e.g.
+\code
+OpenANN::AllocationTracker tracker;
+net.errorGradient(error, gradient);
+std::cout << tracker.allocations() << " allocations, "
+    << tracker.bytes() << " bytes" << std::endl;
+\endcode
+ */
+class AllocationTracker
+{
+  unsigned long startAllocations, startBytes;
+public:
+  /**
+   * Start counting.
+   */
+  AllocationTracker();
+  /**
+   * Restart counting.
+   */
+  void reset();
+  /**
+   * Get number of allocations since start.
+   * @return number of allocations
+   */
+  unsigned long allocations() const;
+  /**
+   * Get number of requested bytes since start.
+   * @return number of bytes
+   */
+  unsigned long bytes() const;
+  /**
+   * Check whether allocations will be counted.
+   * @return true if the library has been built with TRACK_ALLOCATIONS
+   */
+  static bool available();
+  /**
+   * Get number of allocations since the program started.
+   * @return number of allocations
+   */
+  static unsigned long totalAllocations();
+  /**
+   * Get number of requested bytes since the program started.
+   * @return number of bytes
+   */
+  static unsigned long totalBytes();
+};
+
+} // namespace OpenANN
+
+#endif // OPENANN_UTIL_ALLOCATION_TRACKER_H_
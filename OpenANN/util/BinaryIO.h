@@ -0,0 +1,69 @@
+#ifndef OPENANN_UTIL_BINARY_IO_H_
+#define OPENANN_UTIL_BINARY_IO_H_
+
+#include <Eigen/Core>
+#include <istream>
+#include <ostream>
+
+namespace OpenANN
+{
+
+/**
+ * Write a value in the native binary representation.
+ * @param stream binary output stream
+ * @param value plain old data
+ */
+template<typename T>
+void writeBinary(std::ostream& stream, const T& value)
+{
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/**
+ * Read a value that has been written with writeBinary().
+ * @param stream binary input stream
+ * @param value plain old data, will be overwritten
+ * @return false if the stream ended too early
+ */
+template<typename T>
+bool readBinary(std::istream& stream, T& value)
+{
+  stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+  return (bool) stream;
+}
+
+/**
+ * Write a matrix including its shape in the native binary representation.
+ * @param stream binary output stream
+ * @param m matrix
+ */
+template<typename T, int M, int N>
+void writeBinary(std::ostream& stream, const Eigen::Matrix<T, M, N>& m)
+{
+  writeBinary(stream, (int) m.rows());
+  writeBinary(stream, (int) m.cols());
+  stream.write(reinterpret_cast<const char*>(m.data()), m.size() * sizeof(T));
+}
+
+/**
+ * Read a matrix that has been written with writeBinary().
+ * @param stream binary input stream
+ * @param m matrix, will be resized
+ * @return false if the shape is invalid or the stream ended too early
+ */
+template<typename T, int M, int N>
+bool readBinary(std::istream& stream, Eigen::Matrix<T, M, N>& m)
+{
+  int rows = -1, cols = -1;
+  if(!readBinary(stream, rows) || !readBinary(stream, cols) ||
+     rows < 0 || cols < 0 ||
+     (M != Eigen::Dynamic && rows != M) || (N != Eigen::Dynamic && cols != N))
+    return false;
+  m.resize(rows, cols);
+  stream.read(reinterpret_cast<char*>(m.data()), m.size() * sizeof(T));
+  return (bool) stream;
+}
+
+} // namespace OpenANN
+
+#endif // OPENANN_UTIL_BINARY_IO_H_
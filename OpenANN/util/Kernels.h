@@ -0,0 +1,71 @@
+#ifndef OPENANN_UTIL_KERNELS_H_
+#define OPENANN_UTIL_KERNELS_H_
+
+#include <string>
+
+namespace OpenANN
+{
+
+/**
+ * @class Kernels
+ *
+ * Element-wise kernels that are compiled for several instruction sets.
+ *
+ * The library is built for a conservative instruction set (SSE4.2) so that
+ * it runs on all x86-64 processors. With the CMake option
+ * RUNTIME_CPU_DISPATCH the kernels will additionally be compiled for AVX2
+ * with FMA and for AVX-512. The fastest variant that the processor supports
+ * will be selected when the library is loaded. The environment variable
+ * OPENANN_KERNELS (generic, avx2 or avx512) overrides the selection.
+ *
+ * The activation functions use their own vectorizable implementations of
+ * exp() and tanh(), which are accurate to about 1e-15. All variants compute
+ * bitwise identical results, hence training does not depend on the
+ * processor.
+ *
+ * All kernels operate on contiguous arrays of n elements. Input and output
+ * may be the same array.
+ */
+struct Kernels
+{
+  //! Name of the instruction set, e.g. "generic" or "avx2"
+  const char* isa;
+  //! z = 1 / (1 + exp(-a))
+  void (*logistic)(const double* a, double* z, int n);
+  //! gd = z * (1 - z)
+  void (*logisticDerivative)(const double* z, double* gd, int n);
+  //! z = tanh(a)
+  void (*tanh)(const double* a, double* z, int n);
+  //! gd = 1 - z^2
+  void (*tanhDerivative)(const double* z, double* gd, int n);
+  //! z = 1.7159 * tanh(2/3 * a)
+  void (*scaledTanh)(const double* a, double* z, int n);
+  //! gd = 2/3 / 1.7159 * (1.7159 + z) * (1.7159 - z)
+  void (*scaledTanhDerivative)(const double* z, double* gd, int n);
+  //! z = max(0, a)
+  void (*rectifier)(const double* a, double* z, int n);
+  //! gd = z > 0
+  void (*rectifierDerivative)(const double* z, double* gd, int n);
+  //! momentum = eta * momentum - alpha * gradient, parameters += momentum
+  void (*momentumUpdate)(double* parameters, double* momentum,
+                         const double* gradient, double eta, double alpha,
+                         int n);
+};
+
+/**
+ * Get the kernels for the current processor.
+ * @return kernels
+ */
+const Kernels& kernels();
+
+/**
+ * Select kernels manually.
+ * @param isa instruction set: "generic", "avx2" or "avx512"
+ * @return true if the instruction set is available and supported by the
+ *         processor
+ */
+bool useKernels(const std::string& isa);
+
+} // namespace OpenANN
+
+#endif // OPENANN_UTIL_KERNELS_H_
@@ -0,0 +1,130 @@
+#ifndef OPENANN_UTIL_METRICS_H_
+#define OPENANN_UTIL_METRICS_H_
+
+#include <OpenANN/util/Stopwatch.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace OpenANN
+{
+
+/**
+ * @class Metrics
+ *
+ * Counters, gauges and histograms that describe the progress of a training.
+ *
+ * Optimizers record the following metrics in each step:
+ *
+ * - steps_total: number of optimization steps (counter)
+ * - samples_total: number of processed training instances (counter)
+ * - step_seconds: duration of steps (histogram)
+ * - samples_per_second: throughput of the last step (gauge)
+ * - error: training error of the last step (gauge)
+ * - eta_seconds: estimated remaining time, requires a maximal number of
+ *   iterations (gauge)
+ *
+ * Depending on the optimizer and the objective function, there are more
+ * metrics, e.g. MBSGD records batch_seconds (histogram), update_seconds_total
+ * and evaluation_seconds_total (time spent on parameter updates and
+ * finishedIteration()), and Net records gather_seconds_total and
+ * compute_seconds_total (time spent on copying training data and on
+ * propagation).
+ *
+ * All metrics can be exported periodically to a file in the text format of
+ * <a href="https://prometheus.io" target=_blank>Prometheus</a>. The names of
+ * exported metrics have the prefix "openann_". Metrics are not thread-safe.
+ */
+class Metrics
+{
+  struct Histogram
+  {
+    //! Number of observations per bucket (not cumulative), last is +Inf
+    std::vector<unsigned long> counts;
+    unsigned long count;
+    double sum;
+  };
+
+  std::map<std::string, double> counters;
+  std::map<std::string, double> gauges;
+  std::map<std::string, Histogram> histograms;
+  std::string fileName;
+  double interval;
+  bool exported;
+  Stopwatch sinceExport;
+
+public:
+  Metrics();
+  /**
+   * Increase a counter.
+   * @param name name of the counter
+   * @param value increment
+   */
+  void increment(const std::string& name, double value = 1.0);
+  /**
+   * Set a gauge.
+   * @param name name of the gauge
+   * @param value current value
+   */
+  void set(const std::string& name, double value);
+  /**
+   * Add an observation to a histogram with exponential buckets from 0.1 ms
+   * to 100 s.
+   * @param name name of the histogram
+   * @param seconds observed duration
+   */
+  void observe(const std::string& name, double seconds);
+  /**
+   * Get the value of a counter or gauge or the sum of a histogram.
+   * @param name name of the metric
+   * @return value, 0 if the metric does not exist
+   */
+  double value(const std::string& name) const;
+  /**
+   * Get the number of observations of a histogram.
+   * @param name name of the histogram
+   * @return number of observations
+   */
+  unsigned long count(const std::string& name) const;
+  /**
+   * Estimate a quantile of a histogram by linear interpolation within the
+   * corresponding bucket.
+   * @param name name of the histogram
+   * @param q quantile, e.g. 0.95
+   * @return estimated quantile, 0 if there are no observations
+   */
+  double quantile(const std::string& name, double q) const;
+  /**
+   * Remove all metrics.
+   */
+  void reset();
+  /**
+   * Format all metrics in the Prometheus text format.
+   * @return metrics
+   */
+  std::string exposition() const;
+  /**
+   * Export metrics periodically. The file will be replaced atomically.
+   * @param fileName name of the file, an empty name stops exporting
+   * @param interval minimal time between two exports in seconds
+   */
+  void exportPeriodically(const std::string& fileName, double interval = 10.0);
+  /**
+   * Record an optimization step.
+   * @param seconds duration of the step
+   * @param samples number of processed training instances
+   * @param error training error
+   * @param iteration number of finished iterations
+   * @param maximalIterations maximal number of iterations, the remaining
+   *                          time will only be estimated if it is positive
+   */
+  void finishedStep(double seconds, int samples, double error, int iteration,
+                    int maximalIterations);
+
+private:
+  void exportIfDue();
+};
+
+} // namespace OpenANN
+
+#endif // OPENANN_UTIL_METRICS_H_
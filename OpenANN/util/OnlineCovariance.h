@@ -0,0 +1,84 @@
+#ifndef OPENANN_UTIL_ONLINE_COVARIANCE_H_
+#define OPENANN_UTIL_ONLINE_COVARIANCE_H_
+
+#include <Eigen/Core>
+#include <istream>
+#include <ostream>
+
+namespace OpenANN
+{
+
+/**
+ * @class OnlineCovariance
+ *
+ * Accumulates the mean and the covariance matrix of a stream of instances.
+ *
+ * Only the mean and the scatter matrix (sum of the outer products of the
+ * centered instances) will be stored so that the required memory is
+ * \f$ O(D^2) \f$, independent of the number of instances. Batches are
+ * processed block-wise in parallel and the partial results are merged with
+ * the pairwise update of Chan et al. [1], which is numerically stable.
+ *
+ * [1] T. F. Chan, G. H. Golub, R. J. LeVeque:
+ * Algorithms for Computing the Sample Variance: Analysis and Recommendations,
+ * The American Statistician 37 (3), pp. 242-247, 1983.
+ */
+class OnlineCovariance
+{
+  int n;
+  Eigen::VectorXd mean;
+  Eigen::MatrixXd scatter;
+public:
+  OnlineCovariance();
+  /**
+   * Remove all instances.
+   * @return this for chaining
+   */
+  OnlineCovariance& reset();
+  /**
+   * Add a batch of instances.
+   * @param X each row represents an instance
+   * @return this for chaining
+   */
+  OnlineCovariance& add(const Eigen::MatrixXd& X);
+  /**
+   * Add the instances that have been accumulated by another object.
+   * @param other accumulated statistics of other instances
+   * @return this for chaining
+   */
+  OnlineCovariance& merge(const OnlineCovariance& other);
+  /**
+   * Get the number of accumulated instances.
+   * @return number of instances
+   */
+  int samples() const;
+  /**
+   * Get the mean of all instances.
+   * @return mean
+   */
+  const Eigen::VectorXd& getMean() const;
+  /**
+   * Get the covariance matrix of all instances.
+   * @param unbiased divide by n-1 instead of n
+   * @return covariance matrix
+   */
+  Eigen::MatrixXd getCovariance(bool unbiased = true) const;
+  /**
+   * Store the accumulated statistics.
+   * @param stream binary output stream
+   */
+  void save(std::ostream& stream) const;
+  /**
+   * Restore statistics that have been stored with save().
+   * @param stream binary input stream
+   * @return false if the stream ended too early, the statistics will not be
+   *         modified in this case
+   */
+  bool load(std::istream& stream);
+private:
+  void addBlock(const Eigen::MatrixXd& X);
+};
+
+} // namespace OpenANN
+
+#endif // OPENANN_UTIL_ONLINE_COVARIANCE_H_
@@ -10,6 +10,8 @@
 #include <cmath>
 #include <cstdlib>
 #include <algorithm>
+#include <vector>
+#include <stdint.h>
 
 namespace OpenANN
 {
@@ -17,6 +19,27 @@ namespace OpenANN
 /**
  * @class RandomNumberGenerator
  * A utility class that simplifies the generation of random numbers.
+ *
+ * We use the counter-based generator Philox4x32-10 [1]: the n-th random
+ * number is a bijective function of the seed and the counter n. Each draw
+ * reserves a range of counters atomically, so that the generator can be used
+ * from several threads at once. Matrices are filled in parallel and each
+ * entry only depends on its position within the reserved range, i.e. the
+ * result does not depend on the number of threads.
+ *
+ * All instances share the same state, i.e. setting the seed affects all
+ * random numbers that will be generated by %OpenANN. For compatibility, the
+ * seed of std::rand() (used e.g. by Eigen's Random()) will be set as well.
+ *
+ * By default, all threads draw from one shared sequence, i.e. the numbers
+ * that concurrent callers receive depend on the scheduling of the threads.
+ * Parallel tasks that must be reproducible should select their own stream
+ * with RandomStream.
+ *
+ * [1] Salmon, John K.; Moraes, Mark A.; Dror, Ron O.; Shaw, David E.:
+ * Parallel Random Numbers: As Easy as 1, 2, 3,
+ * Proceedings of the International Conference for High Performance
+ * Computing, Networking, Storage and Analysis, 2011.
  */
 class RandomNumberGenerator
 {
@@ -62,7 +85,7 @@ public:
     if(range == T())
       return min;
     else
-      return (T) rand() / (T) RAND_MAX * range + min;
+      return (T) uniform() * range + min;
   }
 
   /**
@@ -83,12 +106,14 @@ public:
   template<class T>
   T sampleNormalDistribution() const
   {
-    return std::sqrt(T(-2) * std::log(generate(T(), T(1)))) *
-           std::cos(T(2) * T(M_PI) * generate(T(), T(1)));
+    return (T) normal();
   }
 
   /**
    * Generate a random sequence of indices.
+   *
+   * The indices will be shuffled with the Fisher-Yates algorithm.
+   *
    * @tparam container type of result (must support push_back())
    * @param n number of indices
    * @param result result container, must be empty if initialized = false
@@ -107,20 +132,120 @@ public:
     {
       OPENANN_CHECK_EQUALS(result.size(), (size_t) n);
     }
-#if __cplusplus < 201300L		
-    std::random_shuffle(result.begin(), result.end());
-#else
-    std::shuffle(result.begin(), result.end());
-#endif
+    if(n < 2)
+      return;
+    Key key;
+    const uint64_t first = reserve(n - 1, key);
+    for(int i = n - 1; i > 0; i--)
+    {
+      const size_t j = indexAt(key, first + (n - 1 - i), i + 1);
+      std::iter_swap(result.begin() + i, result.begin() + j);
+    }
+  }
+
+  /**
+   * Fill a matrix with samples from a uniform distribution.
+   * @tparam M matrix type, must store doubles contiguously
+   * @param matrix matrix that will be filled
+   * @param min minimal value
+   * @param range range of the interval
+   */
+  template<class M>
+  void fillUniformDistribution(M& matrix, double min = 0.0,
+                               double range = 1.0)
+  {
+    fillUniform(matrix.data(), matrix.rows() * matrix.cols(), min, range);
   }
 
+  /**
+   * Fill a matrix with samples from a normal distribution with zero mean.
+   * @tparam M matrix type, must store doubles contiguously
+   * @param matrix matrix that will be filled
+   * @param stdDev standard deviation
+   */
   template<class M>
   void fillNormalDistribution(M& matrix, double stdDev = 1.0)
   {
-    const double* end = matrix.data() + matrix.rows() * matrix.cols();
-    for(double* p = matrix.data(); p < end; p++)
-        *p = sampleNormalDistribution<double>() * stdDev;
+    fillNormal(matrix.data(), matrix.rows() * matrix.cols(), stdDev);
+  }
+
+  /**
+   * Fill a matrix with samples from a Bernoulli distribution.
+   * @tparam M matrix type, must store doubles contiguously
+   * @param matrix matrix that will be filled with 0 and 1
+   * @param p probability of 1
+   */
+  template<class M>
+  void fillBernoulliDistribution(M& matrix, double p)
+  {
+    fillBernoulli(matrix.data(), matrix.rows() * matrix.cols(), p);
   }
+
+  /**
+   * Generate a bit mask with entries from a Bernoulli distribution.
+   * @param mask will contain n bits, bit i of entry i / 32 is the i-th sample
+   * @param n number of samples
+   * @param p probability of a set bit
+   */
+  void fillBernoulliMask(std::vector<uint32_t>& mask, int n, double p);
+
+private:
+  //! Key of the Philox generator, identifies seed and stream
+  struct Key
+  {
+    uint32_t seed;
+    uint32_t stream;
+  };
+
+  double uniform() const;
+  double normal() const;
+  static uint64_t reserve(uint64_t n, Key& key);
+  static size_t indexAt(const Key& key, uint64_t n, size_t size);
+  static void fillUniform(double* data, int n, double min, double range);
+  static void fillNormal(double* data, int n, double stdDev);
+  static void fillBernoulli(double* data, int n, double p);
+};
+
+/**
+ * @class RandomStream
+ *
+ * Selects an independent stream of random numbers for the current thread.
+ *
+ * While the object exists, the RandomNumberGenerator will generate numbers
+ * in the current thread that only depend on the seed and the id of the
+ * stream, even if other threads draw random numbers at the same time. E.g.
+ * each task of a parallel loop can use its own stream:
+ *
+\code
+#pragma omp parallel for
+for(int m = 0; m < M; m++)
+{
+  OpenANN::RandomStream stream(m);
+  // draw random numbers
+}
+\endcode
+ *
+ * Streams can be nested. Note that the stream is not inherited by threads
+ * that are started within its scope.
+ */
+class RandomStream
+{
+  friend class RandomNumberGenerator;
+  uint32_t seed;
+  uint32_t id;
+  uint64_t counter;
+  RandomStream* previous;
+public:
+  /**
+   * Select a stream.
+   * @param id identifier of the stream, the same id will produce the same
+   *           sequence for the same seed
+   */
+  RandomStream(unsigned int id);
+  /**
+   * Restore the previous stream of the thread.
+   */
+  ~RandomStream();
 };
 
 } // namespace OpenANN
@@ -0,0 +1,67 @@
+#ifndef OPENANN_UTIL_THREADS_H_
+#define OPENANN_UTIL_THREADS_H_
+
+namespace OpenANN
+{
+
+/**
+ * @name Threads
+ *
+ * Control the parallelism of %OpenANN at runtime.
+ *
+ * All parallel regions of the library (layers, preprocessing, clustering,
+ * ensembles) and Eigen's matrix products use the number of threads that is
+ * configured here instead of the global OpenMP settings of the process. By
+ * default it is the value of the environment variable OPENANN_NUM_THREADS or,
+ * if it is not set, the default number of OpenMP threads (usually
+ * OMP_NUM_THREADS or the number of processors). Hence, an application that
+ * embeds %OpenANN can restrict it without affecting its own OpenMP code:
+\code
+OpenANN::setNumThreads(2);
+net(X); // uses at most two threads
+\endcode
+ */
+///@{
+/**
+ * Set the number of threads that %OpenANN may use.
+ * @param threads number of threads, 0 restores the default
+ */
+void setNumThreads(int threads);
+/**
+ * Get the number of threads that %OpenANN may use.
+ * @return number of threads, 1 if %OpenANN has been built without OpenMP
+ */
+int numThreads();
+/**
+ * Get the number of threads that should process the given number of
+ * independent work packages.
+ * @param work number of work packages
+ * @return number of threads within [1, numThreads()]
+ */
+int numThreads(int work);
+/**
+ * (De)activate nested parallel regions, e.g. parallel layers within the
+ * models of a Bagging ensemble that are trained in parallel. Nested
+ * parallelism is disabled by default because it usually oversubscribes the
+ * processors.
+ * @param nested activate nested parallelism
+ */
+void setNestedParallelism(bool nested);
+/**
+ * Pin the OpenMP threads of the calling thread to processors.
+ *
+ * The i-th thread will run on the i-th processor (modulo the number of
+ * processors) of the processors that the calling thread was allowed to use
+ * before it has been pinned. Unpinning restores this set of processors for
+ * all threads, including the calling thread. This is only supported on
+ * Linux and should only be used if %OpenANN is the only compute-intensive
+ * part of the process.
+ * @param pin pin threads or allow them to run on their original processors
+ * @return true if the affinity of all threads could be set
+ */
+bool pinThreads(bool pin = true);
+///@}
+
+} // namespace OpenANN
+
+#endif // OPENANN_UTIL_THREADS_H_
@@ -0,0 +1,146 @@
+#ifndef OPENANN_UTIL_TRACER_H_
+#define OPENANN_UTIL_TRACER_H_
+
+#include <string>
+
+namespace OpenANN
+{
+
+/**
+ * @class Tracer
+ *
+ * Records a timeline of spans in the trace event format of Chrome.
+ *
+ * The trace can be loaded in chrome://tracing or
+ * <a href="https://ui.perfetto.dev" target=_blank>Perfetto</a>. It contains
+ * the layers' forward and backward passes, data gathering in Net,
+ * optimization steps, evaluations and the threads' shares of parallel loops
+ * in layers. Each thread has its own row so that serial sections and load
+ * imbalance are visible, e.g.
+ *
+\code
+OpenANN::Tracer::start();
+optimizer.optimize();
+OpenANN::Tracer::stop();
+OpenANN::Tracer::save("trace.json");
+\endcode
+ *
+ * Tracing is disabled by default and costs only a branch per span in this
+ * case. start() and stop() must not be called within parallel regions.
+ * Threads that are not part of a parallel region (e.g. the background thread
+ * of an Evaluator) may record spans while the trace is started, stopped or
+ * exported: each thread's buffer is guarded by its own lock, which is not
+ * contended when recording.
+ */
+class Tracer
+{
+  static volatile bool enabled;
+public:
+  /**
+   * Remove previously recorded spans and start recording.
+   */
+  static void start();
+  /**
+   * Stop recording.
+   */
+  static void stop();
+  /**
+   * Check whether spans will be recorded.
+   * @return true between start() and stop()
+   */
+  static bool active() { return enabled; }
+  /**
+   * Get the recorded trace.
+   * @return JSON object in the trace event format
+   */
+  static std::string json();
+  /**
+   * Write the recorded trace to a file.
+   * @param fileName name of the file, usually with the ending ".json"
+   */
+  static void save(const std::string& fileName);
+  /**
+   * Get time since start().
+   * @return time in microseconds
+   */
+  static double now();
+  /**
+   * Add a span of the current thread.
+   * @param name name of the span, must be interned
+   * @param category category of the span, must be a string literal
+   * @param begin start time in microseconds
+   * @param duration duration in microseconds
+   */
+  static void record(const char* name, const char* category, double begin,
+                     double duration);
+  /**
+   * Get a copy of a string that will not be released.
+   * @param name string
+   * @return persistent copy
+   */
+  static const char* intern(const std::string& name);
+};
+
+/**
+ * @class TraceSpan
+ *
+ * Records a span from its construction to its destruction if the Tracer is
+ * active.
+ */
+class TraceSpan
+{
+  const char* name;
+  const char* category;
+  double begin;
+public:
+  /**
+   * @param name name of the span, must be a string literal or interned
+   * @param category category of the span, must be a string literal
+   */
+  TraceSpan(const char* name, const char* category)
+    : name(0), category(category), begin(0.0)
+  {
+    if(Tracer::active())
+    {
+      this->name = name;
+      begin = Tracer::now();
+    }
+  }
+
+  /**
+   * @param name name of the span, will be interned (this acquires a lock,
+   *             intern names of frequent spans once with Tracer::intern())
+   * @param category category of the span, must be a string literal
+   */
+  TraceSpan(const std::string& name, const char* category)
+    : name(0), category(category), begin(0.0)
+  {
+    if(Tracer::active())
+    {
+      this->name = Tracer::intern(name);
+      begin = Tracer::now();
+    }
+  }
+
+  ~TraceSpan()
+  {
+    if(name)
+      Tracer::record(name, category, begin, Tracer::now() - begin);
+  }
+};
+
+} // namespace OpenANN
+
+#define OPENANN_TRACE_CONCAT2(a, b) a##b
+#define OPENANN_TRACE_CONCAT(a, b) OPENANN_TRACE_CONCAT2(a, b)
+
+/**
+ * Record a span until the end of the current scope.
+ * @param name name of the span
+ * @param category category of the span, e.g. "layer" or "optimizer"
+ */
+#define OPENANN_TRACE_SPAN(name, category) \
+  const OpenANN::TraceSpan OPENANN_TRACE_CONCAT(openannTraceSpan, __LINE__)( \
+      name, category)
+
+#endif // OPENANN_UTIL_TRACER_H_
@@ -0,0 +1,497 @@
+#include <OpenANN/OpenANN>
+#include <OpenANN/layers/Input.h>
+#include <OpenANN/layers/AlphaBetaFilter.h>
+#include <OpenANN/layers/FullyConnected.h>
+#include <OpenANN/layers/Compressed.h>
+#include <OpenANN/layers/Extreme.h>
+#include <OpenANN/layers/Convolutional.h>
+#include <OpenANN/layers/Subsampling.h>
+#include <OpenANN/layers/MaxPooling.h>
+#include <OpenANN/layers/LocalResponseNormalization.h>
+#include <OpenANN/layers/Dropout.h>
+#include <OpenANN/layers/SigmaPi.h>
+#include <OpenANN/RBM.h>
+#include <OpenANN/SparseAutoEncoder.h>
+#include <OpenANN/IntrinsicPlasticity.h>
+#include <OpenANN/ActivationFunctions.h>
+#include <OpenANN/optimization/MBSGD.h>
+#include <OpenANN/optimization/LBFGS.h>
+#include <OpenANN/io/DirectStorageDataSet.h>
+#include <OpenANN/io/DataSetView.h>
+#include <OpenANN/util/Random.h>
+#include <OpenANN/util/AllocationTracker.h>
+#include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * \page Microbenchmarks Microbenchmarks
+ *
+ * Measures the throughput of individual components: forward and backward
+ * propagation of each layer type for several batch sizes, activation
+ * functions, gathering instances from data sets, single optimization steps
+ * and persistence of networks.
+ *
+ * Each benchmark is calibrated so that one sample takes at least the minimal
+ * time. The program prints one JSON object per line, e.g.
+ * \verbatim
+$ ./openann_microbench --filter FullyConnected
+{"benchmark": "layer/FullyConnected/784-256/forward/batch=1", "items": 1, "iterations": 512, "samples": 20, "median_us": 20.4, "p95_us": 21.9, "mean_us": 20.6, "min_us": 20.1, "items_per_second": 49019.6}
+...
+   \endverbatim
+ *
+ * All inputs are generated with a fixed seed, hence the results of two
+ * versions of %OpenANN can be compared directly. Options:
+ *
+ * - --filter <substring>: run only benchmarks whose names contain substring
+ * - --samples <n>: number of timed samples per benchmark (default: 20)
+ * - --min-time <ms>: minimal duration of a sample (default: 10)
+ *
+ * If %OpenANN has been built with TRACK_ALLOCATIONS, the number of heap
+ * allocations of one iteration will be reported as well.
+ */
+
+/**
+ * Monotonic wall time in seconds.
+ */
+double wallTime()
+{
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (double) t.tv_sec + 1e-9 * (double) t.tv_nsec;
+}
+
+OpenANN::OutputInfo shape(int dim1, int dim2 = 0, int dim3 = 0)
+{
+  OpenANN::OutputInfo info;
+  info.dimensions.push_back(dim1);
+  if(dim2 > 0)
+    info.dimensions.push_back(dim2);
+  if(dim3 > 0)
+    info.dimensions.push_back(dim3);
+  return info;
+}
+
+std::string str(int value)
+{
+  std::stringstream stream;
+  stream << value;
+  return stream.str();
+}
+
+/**
+ * A benchmark repeatedly executes run(), which processes items() instances.
+ */
+class Benchmark
+{
+public:
+  virtual ~Benchmark() {}
+  virtual std::string name() = 0;
+  virtual int items() = 0;
+  virtual void run() = 0;
+};
+
+class LayerBenchmark : public Benchmark
+{
+  std::string layerName;
+  OpenANN::Layer* layer;
+  bool backward;
+  std::vector<double*> parameters, derivatives;
+  Eigen::MatrixXd X, E;
+  Eigen::MatrixXd* y;
+  Eigen::MatrixXd* e;
+  bool dropout;
+public:
+  LayerBenchmark(const std::string& layerName, OpenANN::Layer* layer,
+                 OpenANN::OutputInfo input, int N, bool backward,
+                 bool dropout = false)
+    : layerName(layerName), layer(layer), backward(backward), dropout(dropout)
+  {
+    OpenANN::OutputInfo output = layer->initialize(parameters, derivatives);
+    layer->initializeParameters();
+    X = Eigen::MatrixXd::Random(N, input.outputs());
+    E = Eigen::MatrixXd::Random(N, output.outputs());
+    // Backpropagation requires the activations of a forward pass
+    layer->forwardPropagate(&X, y, dropout);
+    this->layerName += "/" + str(input.outputs()) + "-" +
+                       str(output.outputs());
+  }
+
+  virtual ~LayerBenchmark()
+  {
+    delete layer;
+  }
+
+  virtual std::string name()
+  {
+    return "layer/" + layerName + (backward ? "/backward" : "/forward")
+           + "/batch=" + str(X.rows());
+  }
+
+  virtual int items()
+  {
+    return X.rows();
+  }
+
+  virtual void run()
+  {
+    if(backward)
+      layer->backpropagate(&E, e, true);
+    else
+      layer->forwardPropagate(&X, y, dropout);
+  }
+};
+
+class ActivationBenchmark : public Benchmark
+{
+  std::string actName;
+  OpenANN::ActivationFunction act;
+  bool derivative;
+  Eigen::MatrixXd A, Z, G;
+public:
+  ActivationBenchmark(const std::string& actName,
+                      OpenANN::ActivationFunction act, bool derivative)
+    : actName(actName), act(act), derivative(derivative),
+      A(Eigen::MatrixXd::Random(256, 1024)), Z(256, 1024), G(256, 1024)
+  {
+    OpenANN::activationFunction(act, A, Z);
+  }
+
+  virtual std::string name()
+  {
+    return "activation/" + actName + (derivative ? "/derivative" : "/value");
+  }
+
+  virtual int items()
+  {
+    return A.size();
+  }
+
+  virtual void run()
+  {
+    if(derivative)
+      OpenANN::activationFunctionDerivative(act, Z, G);
+    else
+      OpenANN::activationFunction(act, A, Z);
+  }
+};
+
+class GatherBenchmark : public Benchmark
+{
+  std::string dataSetName;
+  OpenANN::DataSet& dataSet;
+  std::vector<int> indices;
+  Eigen::MatrixXd X, T;
+public:
+  GatherBenchmark(const std::string& dataSetName, OpenANN::DataSet& dataSet,
+                  int N)
+    : dataSetName(dataSetName), dataSet(dataSet),
+      X(N, dataSet.inputs()), T(N, dataSet.outputs())
+  {
+    OpenANN::RandomNumberGenerator rng;
+    rng.generateIndices(dataSet.samples(), indices);
+    indices.resize(N);
+  }
+
+  virtual std::string name()
+  {
+    return "dataset/" + dataSetName + "/gather/batch=" + str(X.rows());
+  }
+
+  virtual int items()
+  {
+    return X.rows();
+  }
+
+  virtual void run()
+  {
+    for(int n = 0; n < X.rows(); n++)
+    {
+      X.row(n) = dataSet.getInstance(indices[n]);
+      T.row(n) = dataSet.getTarget(indices[n]);
+    }
+  }
+};
+
+class OptimizerBenchmark : public Benchmark
+{
+  OpenANN::Optimizer* optimizer;
+  int N;
+public:
+  OptimizerBenchmark(OpenANN::Optimizer* optimizer, OpenANN::Net& net)
+    : optimizer(optimizer), N(net.examples())
+  {
+    OpenANN::StoppingCriteria stop;
+    stop.maximalIterations = 1000000000;
+    optimizer->setOptimizable(net);
+    optimizer->setStopCriteria(stop);
+  }
+
+  virtual ~OptimizerBenchmark()
+  {
+    delete optimizer;
+  }
+
+  virtual std::string name()
+  {
+    return "optimizer/" + optimizer->name() + "/step/N=" + str(N);
+  }
+
+  virtual int items()
+  {
+    return N;
+  }
+
+  virtual void run()
+  {
+    optimizer->step();
+  }
+};
+
+class PersistenceBenchmark : public Benchmark
+{
+  OpenANN::Net& net;
+  bool load;
+  std::string saved;
+public:
+  PersistenceBenchmark(OpenANN::Net& net, bool load)
+    : net(net), load(load)
+  {
+    std::stringstream stream;
+    net.save(stream);
+    saved = stream.str();
+  }
+
+  virtual std::string name()
+  {
+    return std::string("net/") + (load ? "load" : "save") + "/P="
+           + str(net.dimension());
+  }
+
+  virtual int items()
+  {
+    return 1;
+  }
+
+  virtual void run()
+  {
+    if(load)
+    {
+      std::stringstream stream(saved);
+      OpenANN::Net loaded;
+      loaded.load(stream);
+    }
+    else
+    {
+      std::stringstream stream;
+      net.save(stream);
+    }
+  }
+};
+
+/**
+ * Calibrate, measure and print the statistics of a benchmark.
+ */
+void measure(Benchmark& benchmark, int samples, double minTime)
+{
+  benchmark.run();
+  int iterations = 1;
+  while(true)
+  {
+    const double begin = wallTime();
+    for(int i = 0; i < iterations; i++)
+      benchmark.run();
+    if(wallTime() - begin >= minTime || iterations >= (1 << 30))
+      break;
+    iterations *= 2;
+  }
+
+  OpenANN::AllocationTracker tracker;
+  benchmark.run();
+  const unsigned long allocations = tracker.allocations();
+
+  std::vector<double> times(samples);
+  for(int s = 0; s < samples; s++)
+  {
+    const double begin = wallTime();
+    for(int i = 0; i < iterations; i++)
+      benchmark.run();
+    times[s] = (wallTime() - begin) / iterations;
+  }
+  std::sort(times.begin(), times.end());
+  double mean = 0.0;
+  for(int s = 0; s < samples; s++)
+    mean += times[s];
+  mean /= samples;
+  const double median = samples % 2 == 1 ? times[samples / 2] :
+                        0.5 * (times[samples / 2 - 1] + times[samples / 2]);
+  const int p95 = std::max(0, (int) std::ceil(0.95 * samples) - 1);
+
+  std::cout << "{\"benchmark\": \"" << benchmark.name() << "\""
+            << ", \"items\": " << benchmark.items()
+            << ", \"iterations\": " << iterations
+            << ", \"samples\": " << samples
+            << ", \"median_us\": " << 1e6 * median
+            << ", \"p95_us\": " << 1e6 * times[p95]
+            << ", \"mean_us\": " << 1e6 * mean
+            << ", \"min_us\": " << 1e6 * times[0]
+            << ", \"items_per_second\": " << benchmark.items() / median;
+  if(OpenANN::AllocationTracker::available())
+    std::cout << ", \"allocations\": " << allocations;
+  std::cout << "}" << std::endl;
+}
+
+void addLayerBenchmarks(std::vector<Benchmark*>& benchmarks,
+                        const std::vector<int>& batchSizes)
+{
+  OpenANN::Regularization regularization;
+  for(size_t b = 0; b < batchSizes.size(); b++)
+  {
+    const int N = batchSizes[b];
+    for(int backward = 0; backward < 2; backward++)
+    {
+      benchmarks.push_back(new LayerBenchmark("Input",
+          new OpenANN::Input(784, 1, 1), shape(784), N, backward));
+      benchmarks.push_back(new LayerBenchmark("AlphaBetaFilter",
+          new OpenANN::AlphaBetaFilter(shape(64), 0.05, 0.05), shape(64), N,
+          backward));
+      benchmarks.push_back(new LayerBenchmark("FullyConnected",
+          new OpenANN::FullyConnected(shape(784), 256, true, OpenANN::TANH,
+                                      0.05, regularization),
+          shape(784), N, backward));
+      benchmarks.push_back(new LayerBenchmark("Compressed",
+          new OpenANN::Compressed(shape(784), 256, 64, true, OpenANN::TANH,
+                                  "dct", 0.05, regularization),
+          shape(784), N, backward));
+      benchmarks.push_back(new LayerBenchmark("Extreme",
+          new OpenANN::Extreme(shape(784), 256, true, OpenANN::TANH, 5.0),
+          shape(784), N, backward));
+      benchmarks.push_back(new LayerBenchmark("Convolutional",
+          new OpenANN::Convolutional(shape(3, 32, 32), 16, 5, 5, true,
+                                     OpenANN::TANH, 0.05, regularization),
+          shape(3, 32, 32), N, backward));
+      benchmarks.push_back(new LayerBenchmark("Subsampling",
+          new OpenANN::Subsampling(shape(16, 28, 28), 2, 2, true,
+                                   OpenANN::TANH, 0.05, regularization),
+          shape(16, 28, 28), N, backward));
+      benchmarks.push_back(new LayerBenchmark("MaxPooling",
+          new OpenANN::MaxPooling(shape(16, 28, 28), 2, 2),
+          shape(16, 28, 28), N, backward));
+      benchmarks.push_back(new LayerBenchmark("LocalResponseNormalization",
+          new OpenANN::LocalResponseNormalization(shape(16, 28, 28), 2.0, 5,
+                                                  1e-4, 0.75),
+          shape(16, 28, 28), N, backward));
+      benchmarks.push_back(new LayerBenchmark("Dropout",
+          new OpenANN::Dropout(shape(1024), 0.5), shape(1024), N, backward,
+          true));
+      OpenANN::SigmaPi* sigmaPi = new OpenANN::SigmaPi(shape(8, 8), false,
+                                                       OpenANN::TANH, 0.05);
+      sigmaPi->secondOrderNodes(4);
+      benchmarks.push_back(new LayerBenchmark("SigmaPi", sigmaPi,
+                                              shape(8, 8), N, backward));
+      benchmarks.push_back(new LayerBenchmark("IntrinsicPlasticity",
+          new OpenANN::IntrinsicPlasticity(256, 0.2), shape(256), N,
+          backward));
+      benchmarks.push_back(new LayerBenchmark("RBM",
+          new OpenANN::RBM(784, 256), shape(784), N, backward));
+      benchmarks.push_back(new LayerBenchmark("SparseAutoEncoder",
+          new OpenANN::SparseAutoEncoder(784, 256, 3.0, 0.1, 0.0,
+                                         OpenANN::LOGISTIC),
+          shape(784), N, backward));
+    }
+  }
+}
+
+void addActivationBenchmarks(std::vector<Benchmark*>& benchmarks)
+{
+  const char* names[] = {"LOGISTIC", "TANH", "TANH_SCALED", "RECTIFIER",
+                         "LINEAR"};
+  const OpenANN::ActivationFunction acts[] = {OpenANN::LOGISTIC,
+      OpenANN::TANH, OpenANN::TANH_SCALED, OpenANN::RECTIFIER,
+      OpenANN::LINEAR};
+  for(int a = 0; a < 5; a++)
+    for(int derivative = 0; derivative < 2; derivative++)
+      benchmarks.push_back(new ActivationBenchmark(names[a], acts[a],
+                                                   derivative));
+}
+
+int main(int argc, char** argv)
+{
+  OpenANN::useAllCores();
+  OpenANN::Log::getLevel() = OpenANN::Log::DISABLED;
+  OpenANN::RandomNumberGenerator().seed(0);
+
+  std::string filter;
+  int samples = 20;
+  double minTime = 0.01;
+  for(int i = 1; i < argc; i++)
+  {
+    if(std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+      filter = argv[++i];
+    else if(std::strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+      samples = std::max(1, std::atoi(argv[++i]));
+    else if(std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+      minTime = 1e-3 * std::atof(argv[++i]);
+    else
+    {
+      std::cerr << "Usage: " << argv[0] << " [--filter substring] "
+                << "[--samples n] [--min-time ms]" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::vector<int> batchSizes;
+  batchSizes.push_back(1);
+  batchSizes.push_back(32);
+  batchSizes.push_back(256);
+
+  // Data set and network for optimizers and persistence
+  const int N = 1024;
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(N, 784);
+  Eigen::MatrixXd T = Eigen::MatrixXd::Random(N, 10);
+  OpenANN::DirectStorageDataSet dataSet(&X, &T);
+  std::vector<int> viewIndices;
+  OpenANN::RandomNumberGenerator().generateIndices(N, viewIndices);
+  OpenANN::DataSetView view(dataSet, viewIndices.begin(), viewIndices.end());
+  OpenANN::Net net;
+  net.inputLayer(784)
+  .fullyConnectedLayer(128, OpenANN::TANH)
+  .outputLayer(10, OpenANN::LINEAR)
+  .trainingSet(dataSet);
+  OpenANN::Net lbfgsNet;
+  lbfgsNet.inputLayer(784)
+  .fullyConnectedLayer(128, OpenANN::TANH)
+  .outputLayer(10, OpenANN::LINEAR)
+  .trainingSet(dataSet);
+
+  std::vector<Benchmark*> benchmarks;
+  addLayerBenchmarks(benchmarks, batchSizes);
+  addActivationBenchmarks(benchmarks);
+  for(size_t b = 0; b < batchSizes.size(); b++)
+  {
+    benchmarks.push_back(new GatherBenchmark("DirectStorageDataSet", dataSet,
+                                             batchSizes[b]));
+    benchmarks.push_back(new GatherBenchmark("DataSetView", view,
+                                             batchSizes[b]));
+  }
+  benchmarks.push_back(new OptimizerBenchmark(
+      new OpenANN::MBSGD(0.01, 0.5, 32), net));
+  benchmarks.push_back(new OptimizerBenchmark(new OpenANN::LBFGS, lbfgsNet));
+  benchmarks.push_back(new PersistenceBenchmark(net, false));
+  benchmarks.push_back(new PersistenceBenchmark(net, true));
+
+  for(size_t b = 0; b < benchmarks.size(); b++)
+  {
+    if(benchmarks[b]->name().find(filter) != std::string::npos)
+      measure(*benchmarks[b], samples, minTime);
+    delete benchmarks[b];
+  }
+  return EXIT_SUCCESS;
+}
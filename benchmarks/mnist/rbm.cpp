@@ -11,9 +11,6 @@
 #include <QKeyEvent>
 #include <QApplication>
 #include <GL/glu.h>
-#ifdef PARALLEL_CORES
-#include <omp.h>
-#endif
 
 /**
  * \page MNISTRBM Restricted Boltzmann Machine on MNIST dataset
@@ -212,9 +209,7 @@ public:
 
 int main(int argc, char** argv)
 {
-#ifdef PARALLEL_CORES
-  omp_set_num_threads(PARALLEL_CORES);
-#endif
+  OpenANN::useAllCores();
 
   std::string directory = "./";
   if(argc > 1)
@@ -7,9 +7,6 @@
 #include <QKeyEvent>
 #include <QApplication>
 #include <GL/glu.h>
-#ifdef PARALLEL_CORES
-#include <omp.h>
-#endif
 
 class DataVisualization : public QGLWidget
 {
@@ -140,9 +137,7 @@ public:
 
 int main(int argc, char** argv)
 {
-#ifdef PARALLEL_CORES
-  omp_set_num_threads(PARALLEL_CORES);
-#endif
+  OpenANN::useAllCores();
   OpenANN::Logger interfaceLogger(OpenANN::Logger::CONSOLE);
 
   std::string directory = "./";
@@ -6,9 +6,6 @@
 #include <QKeyEvent>
 #include <QApplication>
 #include <GL/glu.h>
-#ifdef PARALLEL_CORES
-#include <omp.h>
-#endif
 
 class MNISTVisualization : public QGLWidget
 {
@@ -170,9 +167,7 @@ public:
 
 int main(int argc, char** argv)
 {
-#ifdef PARALLEL_CORES
-  omp_set_num_threads(PARALLEL_CORES);
-#endif
+  OpenANN::useAllCores();
   OpenANN::Logger interfaceLogger(OpenANN::Logger::CONSOLE);
 
   std::string directory = "mnist/";
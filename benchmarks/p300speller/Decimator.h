@@ -25,7 +25,6 @@ public:
     // Low pass filter
     // scipy:
     //  signal.firwin(30+1, 10.0/fs, window='hamming')
-    Eigen::MatrixXd y1(x.rows(), x.cols());
     Eigen::VectorXd b1(31);
     b1 << 0.00256293,  0.0032317 ,  0.00475108,  0.00727558,  0.01088579,
        0.01557498,  0.02124304,  0.02769838,  0.03466804,  0.04181521,
@@ -36,10 +35,9 @@ public:
        0.00256293;
     Eigen::VectorXd a1(1);
     a1 << 1.;
-    OpenANN::filter(x, y1, b1, a1);
 
     Eigen::MatrixXd d(x.rows(), x.cols() / downSamplingFactor);
-    OpenANN::downsample(y1, d, downSamplingFactor);
+    OpenANN::filterAndDownsample(x, d, b1, a1, downSamplingFactor);
     return d;
   }
 };
@@ -2,9 +2,6 @@
 #include <QApplication>
 #include <OpenANN/OpenANN>
 #include "CreateTwoSpiralsDataSet.h"
-#ifdef PARALLEL_CORES
-#include <omp.h>
-#endif
 
 /**
  * \page TwoSpirals Two Spirals
@@ -65,7 +62,7 @@
 
 int main(int argc, char** argv)
 {
-  useAllCores(); // Enable all cores (must be specified during build)
+  useAllCores();
   OpenANNLibraryInfo::print();
   QApplication app(argc, argv);
 
@@ -45,6 +45,10 @@ cdef extern from "OpenANN/OpenANN" namespace "OpenANN::OpenANNLibraryInfo":
 
 cdef extern from "OpenANN/OpenANN" namespace "OpenANN":
   void useAllCores()
+  void setNumThreads(int threads)
+  int numThreads()
+  void setNestedParallelism(bool nested)
+  bool pinThreads(bool pin)
 
 
 cdef extern from "OpenANN/ActivationFunctions.h" namespace "OpenANN":
@@ -88,6 +92,12 @@ cdef extern from "OpenANN/io/Logger.h" namespace "OpenANN::Log":
   void setInfo()
   void setDebug()
 
+cdef extern from "OpenANN/util/Tracer.h":
+  void startTrace "OpenANN::Tracer::start"()
+  void stopTrace "OpenANN::Tracer::stop"()
+  string traceJson "OpenANN::Tracer::json"()
+  void saveTrace "OpenANN::Tracer::save"(string& fileName)
+
 
 cdef extern from "OpenANN/util/Random.h" namespace "OpenANN":
   cdef cppclass RandomNumberGenerator:
@@ -197,6 +207,16 @@ cdef extern from "OpenANN/optimization/Optimizable.h" namespace "OpenANN":
     VectorXd gradient()
 
 
+cdef extern from "OpenANN/util/Metrics.h" namespace "OpenANN":
+  cdef cppclass Metrics:
+    double value(string& name)
+    unsigned long count(string& name)
+    double quantile(string& name, double q)
+    void reset()
+    string exposition()
+    void exportPeriodically(string& fileName, double interval)
+
+
 cdef extern from "OpenANN/optimization/Optimizer.h" namespace "OpenANN":
   cdef cppclass Optimizer:
     void setOptimizable(Optimizable& optimizable)
@@ -205,6 +225,7 @@ cdef extern from "OpenANN/optimization/Optimizer.h" namespace "OpenANN":
     VectorXd result()
     bool step()
     string name()
+    Metrics& getMetrics()
 
 
 cdef extern from "OpenANN/optimization/MBSGD.h" namespace "OpenANN":
@@ -241,7 +262,7 @@ cdef extern from "OpenANN/Net.h" namespace "OpenANN":
     Net& fullyConnectedLayer(int units, ActivationFunction act, double stdDev,
                              bool bias)
     Net& restrictedBoltzmannMachineLayer(int H, int cdN, double stdDev,
-                                         bool backprop)
+                                         bool backprop, int persistentChains)
     Net& compressedLayer(int units, int params, ActivationFunction act,
                          string compression, double stdDev, bool bias)
     Net& extremeLayer(int units, ActivationFunction act, double stdDev,
@@ -265,6 +286,10 @@ cdef extern from "OpenANN/Net.h" namespace "OpenANN":
                            double maxSquaredWeightNorm)
     Net& setErrorFunction(ErrorFunction errorFunction)
     Net& useDropout(bool activate)
+    Net& fitOutputLayer(int blockSize)
+    Net& useProfiling(bool activate)
+    Net& resetProfile()
+    string profileReport(bool json)
 
     unsigned int numberOflayers()
     Layer& getLayer(unsigned int l)
@@ -274,10 +299,16 @@ cdef extern from "OpenANN/Net.h" namespace "OpenANN":
     void save(string& fileName)
     void load(string& fileName)
 
+cdef extern from "OpenANN/BatchPredictor.h" namespace "OpenANN":
+  cdef cppclass BatchPredictor:
+    BatchPredictor(Net& net, int tileSize)
+    int getTileSize()
+    MatrixXd predict "operator()" (MatrixXd& X)
+
 cdef extern from "OpenANN/RBM.h" namespace "OpenANN":
   cdef cppclass RBM(Learner):
     RBM(int D, int H, int cdN, double stdDev, bool backprop,
-        Regularization regularization)
+        Regularization regularization, int persistentChains)
     int visibleUnits()
     int hiddenUnits()
     MatrixXd& getWeights()
@@ -46,10 +46,10 @@ cdef class Net(Learner):
     return self
 
   def restricted_boltzmann_machine_layer(self, units, cd_n=1, std_dev=0.01,
-                                         backprop=True):
+                                         backprop=True, persistent_chains=0):
     """Add an RBM."""
     self.thisptr.restrictedBoltzmannMachineLayer(units, cd_n, std_dev,
-                                                 backprop)
+                                                 backprop, persistent_chains)
 
   def compressed_layer(self, units, params, act, compression, std_dev=0.05,
                        bias=True):
@@ -132,6 +132,25 @@ cdef class Net(Learner):
     """(De)activate dropout."""
     self.thisptr.useDropout(activate)
 
+  def fit_output_layer(self, block_size=1024):
+    """Train the output layer in closed form (ridge regression)."""
+    self.thisptr.fitOutputLayer(block_size)
+    return self
+
+  def use_profiling(self, activate=True):
+    """(De)activate per-layer profiling."""
+    self.thisptr.useProfiling(activate)
+    return self
+
+  def reset_profile(self):
+    """Reset the recorded per-layer statistics."""
+    self.thisptr.resetProfile()
+    return self
+
+  def profile_report(self, json=False):
+    """Summarize per-layer statistics as table or JSON string."""
+    return self.thisptr.profileReport(json).c_str()
+
   def predict(self, x_numpy):
     """Predict output for given inputs, each row represents an instance."""
     x_numpy = numpy.atleast_2d(x_numpy)
@@ -178,16 +197,41 @@ cdef class Net(Learner):
     self.thisptr.load(string(fn))
 
 
+cdef class BatchPredictor:
+  """Computes predictions of a network tile by tile in parallel."""
+  cdef cbindings.BatchPredictor *thisptr
+  cdef Net net
+
+  def __cinit__(self, Net net, tile_size=0):
+    self.net = net
+    self.thisptr = new cbindings.BatchPredictor(deref(net.thisptr), tile_size)
+
+  def __dealloc__(self):
+    del self.thisptr
+
+  def tile_size(self):
+    """Number of instances per tile."""
+    return self.thisptr.getTileSize()
+
+  def predict(self, x_numpy):
+    """Predict output for given inputs, each row represents an instance."""
+    x_numpy = numpy.atleast_2d(x_numpy)
+    cdef cbindings.MatrixXd* x_eigen = __matrix_numpy_to_eigen__(x_numpy)
+    cdef cbindings.MatrixXd y_eigen = self.thisptr.predict(deref(x_eigen))
+    del x_eigen
+    return __matrix_eigen_to_numpy__(&y_eigen)
+
+
 cdef class RBM(Learner):
   """Restricted Boltzmann machine."""
   cdef cbindings.RBM *thisptr
 
   def __init__(self, D, H, cd_N=1, std_dev=0.01, backprop=True, l1penalty=0.0,
-               l2penalty=0.0):
+               l2penalty=0.0, persistent_chains=0):
     cdef cbindings.Regularization* regularization = \
         new cbindings.Regularization(l1penalty, l2penalty, 0.0)
     self.thisptr = new cbindings.RBM(D, H, cd_N, std_dev, backprop,
-                                     deref(regularization))
+                                     deref(regularization), persistent_chains)
     del regularization
     self.learner = self.thisptr
 
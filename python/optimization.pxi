@@ -56,6 +56,28 @@ cdef class Optimizer:
     self.thisptr.setOptimizable(deref((<Learner>net).learner))
     self.thisptr.optimize()
 
+  def metric(self, name):
+    """Value of a counter or gauge or sum of a histogram, e.g. 'error'."""
+    cdef char* n = name
+    return self.thisptr.getMetrics().value(string(n))
+
+  def metric_quantile(self, name, q):
+    """Estimated quantile of a histogram, e.g. 'step_seconds'."""
+    cdef char* n = name
+    return self.thisptr.getMetrics().quantile(string(n), q)
+
+  def reset_metrics(self):
+    self.thisptr.getMetrics().reset()
+
+  def metrics_exposition(self):
+    """All metrics in the Prometheus text format."""
+    return self.thisptr.getMetrics().exposition().c_str()
+
+  def export_metrics(self, file_name, interval=10.0):
+    """Periodically write metrics to a file during optimization."""
+    cdef char* fn = file_name
+    self.thisptr.getMetrics().exportPeriodically(string(fn), interval)
+
 cdef class MBSGD(Optimizer):
   """Mini-batch stochastic gradient descent."""
   def __cinit__(self,
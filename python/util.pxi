@@ -95,6 +95,26 @@ cdef class Log:
     cbindings.write(cbindings.Log().get(Log.ERROR, ""), <char*?>text)
 
 
+cdef class Tracer:
+  """Records a timeline in the trace event format of Chrome."""
+  @classmethod
+  def start(object cls):
+    cbindings.startTrace()
+
+  @classmethod
+  def stop(object cls):
+    cbindings.stopTrace()
+
+  @classmethod
+  def json(object cls):
+    return cbindings.traceJson().c_str()
+
+  @classmethod
+  def save(object cls, file_name):
+    cdef char* fn = file_name
+    cbindings.saveTrace(string(fn))
+
+
 cdef class RandomNumberGenerator:
   """Controls random number generation in OpenANN."""
   cdef cbindings.RandomNumberGenerator *thisptr
@@ -135,6 +155,25 @@ cdef class OpenANN:
 __version__ = cbindings.VERSION
 
 
+def set_num_threads(threads):
+  """Set the number of threads that OpenANN may use (0: default)."""
+  cbindings.setNumThreads(threads)
+
+
+def num_threads():
+  """Number of threads that OpenANN may use."""
+  return cbindings.numThreads()
+
+
+def set_nested_parallelism(nested):
+  cbindings.setNestedParallelism(nested)
+
+
+def pin_threads(pin=True):
+  """Pin OpenMP threads to processors (only Linux)."""
+  return cbindings.pinThreads(pin)
+
+
 def _use_all_cores():
   cbindings.useAllCores()
 
@@ -1,6 +1,5 @@
 #include <OpenANN/ActivationFunctions.h>
-#include <limits>
-#include <cmath>
+#include <OpenANN/util/Kernels.h>
 
 namespace OpenANN
 {
@@ -67,73 +66,42 @@ void softmax(Eigen::MatrixXd& y)
 
 void logistic(const Eigen::MatrixXd& a, Eigen::MatrixXd& z)
 {
-  double const* aPtr = a.data();
-  double const* aEnd = aPtr + a.rows() * a.cols();
-  for(double* zPtr = z.data(); aPtr < aEnd; aPtr++, zPtr++)
-  {
-    if(*aPtr < -45.0)
-      *zPtr = 0.0;
-    else if(*aPtr > 45.0)
-      *zPtr = 1.0;
-    else
-      *zPtr = 1.0 / (1.0 + std::exp(-*aPtr));
-  }
+  kernels().logistic(a.data(), z.data(), a.size());
 }
 
 void logisticDerivative(const Eigen::MatrixXd& z, Eigen::MatrixXd& gd)
 {
-  double const* zPtr = z.data();
-  double const* zEnd = zPtr + z.rows() * z.cols();
-  for(double* gdPtr = gd.data(); zPtr < zEnd; zPtr++, gdPtr++)
-    *gdPtr = *zPtr * (1.0 - *zPtr);
+  kernels().logisticDerivative(z.data(), gd.data(), z.size());
 }
 
 void normaltanh(const Eigen::MatrixXd& a, Eigen::MatrixXd& z)
 {
-  double const* aPtr = a.data();
-  double const* aEnd = aPtr + a.rows() * a.cols();
-  for(double* zPtr = z.data(); aPtr < aEnd; aPtr++, zPtr++)
-    *zPtr = std::tanh(*aPtr);
+  kernels().tanh(a.data(), z.data(), a.size());
 }
 
 void normaltanhDerivative(const Eigen::MatrixXd& z, Eigen::MatrixXd& gd)
 {
-  double const* zPtr = z.data();
-  double const* zEnd = zPtr + z.rows() * z.cols();
-  for(double* gdPtr = gd.data(); zPtr < zEnd; zPtr++, gdPtr++)
-    *gdPtr = 1.0 - *zPtr * *zPtr;
+  kernels().tanhDerivative(z.data(), gd.data(), z.size());
 }
 
 void scaledtanh(const Eigen::MatrixXd& a, Eigen::MatrixXd& z)
 {
-  double const* aPtr = a.data();
-  double const* aEnd = aPtr + a.rows() * a.cols();
-  for(double* zPtr = z.data(); aPtr < aEnd; aPtr++, zPtr++)
-    *zPtr = 1.7159 * std::tanh(0.66666667 * *aPtr);
+  kernels().scaledTanh(a.data(), z.data(), a.size());
 }
 
 void scaledtanhDerivative(const Eigen::MatrixXd& z, Eigen::MatrixXd& gd)
 {
-  double const* zPtr = z.data();
-  double const* zEnd = zPtr + z.rows() * z.cols();
-  for(double* gdPtr = gd.data(); zPtr < zEnd; zPtr++, gdPtr++)
-    *gdPtr = 0.66666667 / 1.7159 * (1.7159 + *zPtr) * (1.7159 - *zPtr);
+  kernels().scaledTanhDerivative(z.data(), gd.data(), z.size());
 }
 
 void rectifier(const Eigen::MatrixXd& a, Eigen::MatrixXd& z)
 {
-  double const* aPtr = a.data();
-  double const* aEnd = aPtr + a.rows() * a.cols();
-  for(double* zPtr = z.data(); aPtr < aEnd; aPtr++, zPtr++)
-    *zPtr = std::max<double>(0.0, *aPtr);
+  kernels().rectifier(a.data(), z.data(), a.size());
 }
 
 void rectifierDerivative(const Eigen::MatrixXd& z, Eigen::MatrixXd& gd)
 {
-  double const* zPtr = z.data();
-  double const* zEnd = zPtr + z.rows() * z.cols();
-  for(double* gdPtr = gd.data(); zPtr < zEnd; zPtr++, gdPtr++)
-    *gdPtr = (double)(*zPtr > 0.0) * 1.0;
+  kernels().rectifierDerivative(z.data(), gd.data(), z.size());
 }
 
 void linear(const Eigen::MatrixXd& a, Eigen::MatrixXd& z)
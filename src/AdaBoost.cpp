@@ -2,12 +2,15 @@
 #include <OpenANN/Evaluation.h>
 #include <OpenANN/util/AssertionMacros.h>
 #include <OpenANN/io/WeightedDataSet.h>
+#include <OpenANN/util/Threads.h>
+#include <algorithm>
+#include <vector>
 
 namespace OpenANN
 {
 
 AdaBoost::AdaBoost()
-  : F(0)
+  : optimizer(0), F(0)
 {
 }
 
@@ -19,45 +22,76 @@ Eigen::VectorXd AdaBoost::getWeights()
 EnsembleLearner& AdaBoost::addLearner(Learner& learner)
 {
   models.push_back(&learner);
+  return *this;
 }
 
 EnsembleLearner& AdaBoost::setOptimizer(Optimizer& optimizer)
 {
   this->optimizer = &optimizer;
+  return *this;
 }
 
 EnsembleLearner& AdaBoost::train(DataSet& dataSet)
 {
+  OPENANN_CHECK(optimizer);
   const int N = dataSet.samples();
+  const int M = models.size();
   F = dataSet.outputs();
-  modelWeights.conservativeResize(models.size());
+  modelWeights.conservativeResize(M);
   modelWeights.setZero();
-  Eigen::VectorXd weights(dataSet.samples());
-  weights.fill(1.0 / (double) dataSet.samples());
+  Eigen::VectorXd weights(N);
+  weights.fill(1.0 / (double) N);
   WeightedDataSet resampled(dataSet, weights, true);
-  int t = 0;
-  for(std::list<Learner*>::iterator m = models.begin(); m != models.end();
-      m++, t++)
+
+  Eigen::MatrixXd X(N, dataSet.inputs());
+  std::vector<int> targets(N);
+  for(int n = 0; n < N; n++)
   {
-    (*m)->trainingSet(resampled);
-    optimizer->setOptimizable(**m);
+    X.row(n) = dataSet.getInstance(n);
+    targets[n] = oneOfCDecoding(dataSet.getTarget(n));
+  }
+  std::vector<char> correct(N);
+
+  for(int t = 0; t < M; t++)
+  {
+    Learner& model = *models[t];
+    model.trainingSet(resampled);
+    optimizer->setOptimizable(model);
     optimizer->optimize();
-    (*m)->removeTrainingSet();
-    const double error = 1.0 - weightedAccuracy(**m, dataSet, weights);
+    model.removeTrainingSet();
+
+    // Propagate blocks of instances to limit the size of the activations
+    const int blockSize = 1024;
+    double accuracy = 0.0;
+    for(int n0 = 0; n0 < N; n0 += blockSize)
+    {
+      const int rows = std::min<int>(blockSize, N - n0);
+      Eigen::MatrixXd Y = model(Eigen::MatrixXd(X.middleRows(n0, rows)));
+      #pragma omp parallel for reduction(+:accuracy) num_threads(numThreads())
+      for(int i = 0; i < rows; i++)
+      {
+        const int n = n0 + i;
+        correct[n] = oneOfCDecoding(Y.row(i).transpose()) == targets[n];
+        if(correct[n])
+          accuracy += weights(n);
+      }
+    }
+
+    const double error = 1.0 - accuracy;
     OPENANN_CHECK_WITHIN(error, 0.0, 1.0);
     modelWeights(t) = 0.5 * std::log((1.0 - error) / (error+1e-10));
     if(error == 0.0 || error >= 0.5)
       continue;
+    const double decrease = std::exp(-modelWeights(t));
+    const double increase = std::exp(modelWeights(t));
+    #pragma omp parallel for num_threads(numThreads())
     for(int n = 0; n < N; n++)
-    {
-      const bool correct = oneOfCDecoding((**m)(dataSet.getInstance(n))) ==
-          oneOfCDecoding(dataSet.getTarget(n));
-      weights(n) *= std::exp((correct ? -1.0 : 1.0) * modelWeights(t));
-    }
+      weights(n) *= correct[n] ? decrease : increase;
     weights /= weights.sum();
     resampled.updateWeights(weights);
   }
   modelWeights /= modelWeights.sum();
+  return *this;
 }
 
 Eigen::MatrixXd AdaBoost::operator()(Eigen::MatrixXd& X)
@@ -66,17 +100,15 @@ Eigen::MatrixXd AdaBoost::operator()(Eigen::MatrixXd& X)
   Eigen::MatrixXd Y(N, F);
   Y.fill(0.0);
 
-  int t = 0;
-  for(std::list<Learner*>::iterator m = models.begin(); m != models.end();
-      m++, t++)
-    Y += modelWeights(t) * (**m)(X);
+  for(int t = 0; t < (int) models.size(); t++)
+    Y += modelWeights(t) * (*models[t])(X);
 
   return Y;
 }
 
 Eigen::VectorXd AdaBoost::operator()(Eigen::VectorXd& x)
 {
-  Eigen::MatrixXd X = X.transpose();
+  Eigen::MatrixXd X = x.transpose();
   return (*this)(X).transpose();
 }
 
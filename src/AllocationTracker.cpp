@@ -0,0 +1,137 @@
+#include <OpenANN/util/AllocationTracker.h>
+#include <cstdlib>
+#include <new>
+
+namespace OpenANN
+{
+
+namespace
+{
+
+unsigned long allocationCount = 0;
+unsigned long allocatedBytes = 0;
+
+#ifdef OPENANN_TRACK_ALLOCATIONS
+inline void countAllocation(size_t size)
+{
+  __sync_fetch_and_add(&allocationCount, 1UL);
+  __sync_fetch_and_add(&allocatedBytes, (unsigned long) size);
+}
+#endif
+
+}
+
+AllocationTracker::AllocationTracker()
+{
+  reset();
+}
+
+void AllocationTracker::reset()
+{
+  startAllocations = totalAllocations();
+  startBytes = totalBytes();
+}
+
+unsigned long AllocationTracker::allocations() const
+{
+  return totalAllocations() - startAllocations;
+}
+
+unsigned long AllocationTracker::bytes() const
+{
+  return totalBytes() - startBytes;
+}
+
+bool AllocationTracker::available()
+{
+#ifdef OPENANN_TRACK_ALLOCATIONS
+  return true;
+#else
+  return false;
+#endif
+}
+
+unsigned long AllocationTracker::totalAllocations()
+{
+  return __sync_fetch_and_add(&allocationCount, 0UL);
+}
+
+unsigned long AllocationTracker::totalBytes()
+{
+  return __sync_fetch_and_add(&allocatedBytes, 0UL);
+}
+
+} // namespace OpenANN
+
+#ifdef OPENANN_TRACK_ALLOCATIONS
+#ifdef __GLIBC__
+
+// Eigen allocates with malloc() and the default operator new calls malloc(),
+// hence it is sufficient to replace the C allocation functions.
+extern "C"
+{
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* p, size_t size);
+
+void* malloc(size_t size)
+{
+  OpenANN::countAllocation(size);
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size)
+{
+  OpenANN::countAllocation(n * size);
+  return __libc_calloc(n, size);
+}
+
+void* realloc(void* p, size_t size)
+{
+  OpenANN::countAllocation(size);
+  return __libc_realloc(p, size);
+}
+
+}
+
+#else // __GLIBC__
+
+// Dynamic exception specifications have been removed in C++17
+#if __cplusplus >= 201103L
+#define OPENANN_THROWS_BAD_ALLOC noexcept(false)
+#define OPENANN_THROWS_NOTHING noexcept
+#else
+#define OPENANN_THROWS_BAD_ALLOC throw(std::bad_alloc)
+#define OPENANN_THROWS_NOTHING throw()
+#endif
+
+void* operator new(size_t size) OPENANN_THROWS_BAD_ALLOC
+{
+  OpenANN::countAllocation(size);
+  void* p = std::malloc(size ? size : 1);
+  if(!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[](size_t size) OPENANN_THROWS_BAD_ALLOC
+{
+  return operator new(size);
+}
+
+void operator delete(void* p) OPENANN_THROWS_NOTHING
+{
+  std::free(p);
+}
+
+void operator delete[](void* p) OPENANN_THROWS_NOTHING
+{
+  std::free(p);
+}
+
+#undef OPENANN_THROWS_BAD_ALLOC
+#undef OPENANN_THROWS_NOTHING
+
+#endif // __GLIBC__
+#endif // OPENANN_TRACK_ALLOCATIONS
@@ -1,54 +1,92 @@
 #include <OpenANN/Bagging.h>
 #include <OpenANN/util/AssertionMacros.h>
+#include <OpenANN/util/Tracer.h>
 #include <OpenANN/io/DataSetView.h>
+#include <OpenANN/io/DirectStorageDataSet.h>
+#include <OpenANN/util/Random.h>
+#include <OpenANN/util/Threads.h>
 
 namespace OpenANN
 {
 
 Bagging::Bagging(double bagSize)
-  : bagSize(bagSize), F(0)
+  : optimizer(0), bagSize(bagSize), F(0)
 {
 }
 
 EnsembleLearner& Bagging::addLearner(Learner& learner)
 {
   models.push_back(&learner);
+  return *this;
 }
 
 EnsembleLearner& Bagging::setOptimizer(Optimizer& optimizer)
 {
   this->optimizer = &optimizer;
+  return *this;
 }
 
 EnsembleLearner& Bagging::train(DataSet& dataSet)
 {
+  OPENANN_CHECK(optimizer);
   const int N = dataSet.samples();
+  const int M = models.size();
   F = dataSet.outputs();
-  for(std::list<Learner*>::iterator m = models.begin(); m != models.end(); m++)
+
+  // Models that are trained in parallel must not share the temporary
+  // vectors of a data set, hence each model gets its own view on a copy
+  Eigen::MatrixXd X(N, dataSet.inputs());
+  Eigen::MatrixXd T(N, F);
+  for(int n = 0; n < N; n++)
+  {
+    X.row(n) = dataSet.getInstance(n);
+    T.row(n) = dataSet.getTarget(n);
+  }
+
+  const bool parallel = optimizer->isCloneable();
+  #pragma omp parallel if(parallel) num_threads(numThreads(M))
   {
-    DataSetView samples = sample(dataSet, bagSize, true);
-    (*m)->trainingSet(samples);
-    optimizer->setOptimizable(**m);
-    optimizer->optimize();
-    (*m)->removeTrainingSet();
+    Optimizer* optimizer = parallel ? this->optimizer->clone() :
+                           this->optimizer;
+    #pragma omp for schedule(dynamic, 1)
+    for(int m = 0; m < M; m++)
+    {
+      OPENANN_TRACE_SPAN("Bagging::trainModel", "parallel");
+      // The bootstrap sample and the training of a model only depend on the
+      // seed and m, not on the other models
+      RandomStream stream(m);
+      DirectStorageDataSet storage(&X, &T);
+      DataSetView bag = sample(storage, bagSize, true);
+      models[m]->trainingSet(bag);
+      optimizer->setOptimizable(*models[m]);
+      optimizer->optimize();
+      models[m]->removeTrainingSet();
+    }
+    if(parallel)
+      delete optimizer;
   }
+  return *this;
 }
 
 Eigen::MatrixXd Bagging::operator()(Eigen::MatrixXd& X)
 {
-  const int N = X.rows();
-  Eigen::MatrixXd Y(N, F);
-  Y.fill(0.0);
+  const int M = models.size();
+  std::vector<Eigen::MatrixXd> predictions(M);
+  #pragma omp parallel for schedule(dynamic, 1) num_threads(numThreads())
+  for(int m = 0; m < M; m++)
+    predictions[m] = (*models[m])(X);
 
-  for(std::list<Learner*>::iterator m = models.begin(); m != models.end(); m++)
-    Y += (**m)(X);
+  Eigen::MatrixXd Y(X.rows(), F);
+  Y.fill(0.0);
+  for(int m = 0; m < M; m++)
+    Y += predictions[m];
 
-  return Y / models.size();
+  return Y / M;
 }
 
 Eigen::VectorXd Bagging::operator()(Eigen::VectorXd& x)
 {
-  Eigen::MatrixXd X = X.transpose();
+  Eigen::MatrixXd X = x.transpose();
   return (*this)(X).transpose();
 }
 
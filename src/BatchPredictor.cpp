@@ -0,0 +1,147 @@
+#include <OpenANN/BatchPredictor.h>
+#include <OpenANN/Net.h>
+#include <OpenANN/io/DataSet.h>
+#include <OpenANN/util/AssertionMacros.h>
+#include <OpenANN/util/Random.h>
+#include <OpenANN/util/Threads.h>
+#include <OpenANN/util/Tracer.h>
+#include <algorithm>
+#include <sstream>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace OpenANN
+{
+
+namespace
+{
+
+//! Activations of a tile should fit into the L2 cache
+const int CACHE_BYTES = 256 * 1024;
+const int MIN_TILE_SIZE = 16;
+const int MAX_TILE_SIZE = 1024;
+
+class MatrixSink : public PredictionSink
+{
+  Eigen::MatrixXd& Y;
+public:
+  MatrixSink(Eigen::MatrixXd& Y) : Y(Y) {}
+  virtual void consume(int offset, const Eigen::MatrixXd& tile)
+  {
+    Y.middleRows(offset, tile.rows()) = tile;
+  }
+};
+
+}
+
+BatchPredictor::BatchPredictor(Net& net, int tileSize)
+  : net(net), tileSize(tileSize), replicable(net.isReplicable())
+{
+  const int L = net.numberOflayers();
+  int activations = 0;
+  for(int l = 0; l < L; l++)
+    activations += net.getOutputInfo(l).outputs();
+  // Each layer stores its activations and outputs
+  if(this->tileSize <= 0)
+    this->tileSize = std::max(MIN_TILE_SIZE, std::min(MAX_TILE_SIZE,
+        CACHE_BYTES / (2 * (int) sizeof(double) * std::max(1, activations))));
+  replicas.push_back(&net);
+}
+
+BatchPredictor::~BatchPredictor()
+{
+  for(size_t r = 1; r < replicas.size(); r++)
+    delete replicas[r];
+}
+
+Eigen::MatrixXd BatchPredictor::operator()(const Eigen::MatrixXd& X)
+{
+  Eigen::MatrixXd Y;
+  predict(X, Y);
+  return Y;
+}
+
+void BatchPredictor::predict(const Eigen::MatrixXd& X, Eigen::MatrixXd& Y)
+{
+  const int N = X.rows();
+  Y.resize(N, net.getOutputInfo(net.numberOflayers() - 1).outputs());
+  MatrixSink sink(Y);
+  predict(&X, 0, N, sink);
+}
+
+void BatchPredictor::predict(DataSet& dataSet, PredictionSink& sink)
+{
+  predict(0, &dataSet, dataSet.samples(), sink);
+}
+
+void BatchPredictor::predict(const Eigen::MatrixXd* X, DataSet* dataSet,
+                             int N, PredictionSink& sink)
+{
+  OPENANN_TRACE_SPAN("BatchPredictor::predict", "inference");
+  const int D = net.getOutputInfo(0).outputs();
+  const int tiles = (N + tileSize - 1) / tileSize;
+  const int workers = prepare(tiles);
+
+  // Thread t computes the tiles t, t + workers, ... and passes them to the
+  // sink in order while the other threads continue with their next tiles.
+  #pragma omp parallel for ordered schedule(static, 1) if(workers > 1) \
+    num_threads(workers)
+  for(int t = 0; t < tiles; t++)
+  {
+    int worker = 0;
+#ifdef _OPENMP
+    worker = omp_get_thread_num();
+#endif
+    const int offset = t * tileSize;
+    const int rows = std::min(tileSize, N - offset);
+    Eigen::MatrixXd& input = inputs[worker];
+    input.resize(rows, D);
+    if(X)
+    {
+      input = X->middleRows(offset, rows);
+    }
+    else
+    {
+      // Data sets usually return references to shared buffers
+      #pragma omp critical(openann_batch_predictor_input)
+      for(int n = 0; n < rows; n++)
+        input.row(n) = dataSet->getInstance(offset + n).transpose();
+    }
+    {
+      OPENANN_TRACE_SPAN("BatchPredictor::propagate", "parallel");
+      replicas[worker]->predict(input, outputs[worker]);
+    }
+    #pragma omp ordered
+    sink.consume(offset, outputs[worker]);
+  }
+}
+
+int BatchPredictor::prepare(int tiles)
+{
+  const int workers = replicable ? numThreads(tiles) : 1;
+  if((int) replicas.size() < workers)
+  {
+    std::stringstream stream;
+    net.save(stream);
+    const std::string model = stream.str();
+    // The initial parameters of the replicas will be overwritten, they must
+    // not consume the random numbers of a training that is in progress
+    RandomStream randomStream(0);
+    while((int) replicas.size() < workers)
+    {
+      std::istringstream modelStream(model);
+      Net* replica = new Net;
+      replica->load(modelStream);
+      replicas.push_back(replica);
+    }
+  }
+  // The parameters might have been changed since the last prediction
+  for(int r = 1; r < workers; r++)
+    replicas[r]->setParameters(net.currentParameters());
+  inputs.resize(std::max<size_t>(inputs.size(), workers));
+  outputs.resize(std::max<size_t>(outputs.size(), workers));
+  return workers;
+}
+
+} // namespace OpenANN
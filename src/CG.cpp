@@ -7,6 +7,8 @@
 #include <OpenANN/util/AssertionMacros.h>
 #include <OpenANN/util/Random.h>
 #include <OpenANN/util/OpenANNException.h>
+#include <OpenANN/util/Stopwatch.h>
+#include <OpenANN/util/Tracer.h>
 #include <OpenANN/io/Logger.h>
 #include <limits>
 
@@ -32,13 +34,23 @@ void CG::setStopCriteria(const StoppingCriteria& stop)
   this->stop = stop;
 }
 
+Optimizer* CG::clone()
+{
+  CG* cg = new CG;
+  cg->setStopCriteria(stop);
+  return cg;
+}
+
 bool CG::step()
 {
+  OPENANN_TRACE_SPAN("CG::step", "optimizer");
   OPENANN_CHECK(opt);
   if(iteration < 0)
     initialize();
   OPENANN_CHECK(n > 0);
 
+  Stopwatch stepTime;
+
   try
   {
     while(alglib_impl::mincgiteration(state.c_ptr(), &envState))
@@ -54,6 +66,9 @@ bool CG::step()
         {
           iteration = state.c_ptr()->repiterationscount;
           opt->finishedIteration();
+          metrics.finishedStep(stepTime.stop() / 1e6, opt->examples(),
+                               error, iteration,
+                               stop.maximalIterations);
           return true;
         }
         continue;
@@ -71,6 +86,9 @@ bool CG::step()
         {
           iteration = state.c_ptr()->repiterationscount;
           opt->finishedIteration();
+          metrics.finishedStep(stepTime.stop() / 1e6, opt->examples(),
+                               error, iteration,
+                               stop.maximalIterations);
           return true;
         }
         continue;
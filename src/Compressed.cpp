@@ -69,7 +69,7 @@ void Compressed::forwardPropagate(Eigen::MatrixXd* x, Eigen::MatrixXd*& y,
   this->y.conservativeResize(N, Eigen::NoChange);
   this->x = x;
   // Activate neurons
-  a = *x * W.leftCols(I).transpose();
+  a.noalias() = *x * W.leftCols(I).transpose();
   if(bias)
     a.rowwise() += W.col(I).transpose();
   // Compute output
@@ -1,4 +1,5 @@
 #include <OpenANN/Compressor.h>
+#include <OpenANN/util/BinaryIO.h>
 
 namespace OpenANN
 {
@@ -26,6 +27,29 @@ Eigen::MatrixXd Compressor::transform(const Eigen::MatrixXd& X)
   return X * cm.transpose();
 }
 
+bool Compressor::affine(Eigen::MatrixXd& W, Eigen::VectorXd& b)
+{
+  W = cm.transpose();
+  b.setZero(cm.rows());
+  return true;
+}
+
+bool Compressor::save(std::ostream& stream)
+{
+  writeBinary(stream, cm);
+  return (bool) stream;
+}
+
+bool Compressor::load(std::istream& stream)
+{
+  Eigen::MatrixXd cm;
+  if(!readBinary(stream, cm) || cm.rows() != this->cm.rows() ||
+     cm.cols() != this->cm.cols())
+    return false;
+  this->cm = cm;
+  return true;
+}
+
 int Compressor::getOutputs()
 {
   return cm.rows();
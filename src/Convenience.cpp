@@ -20,6 +20,13 @@ void train(Net& net, std::string algorithm, ErrorFunction errorFunction,
   net.setErrorFunction(errorFunction);
   net.useDropout(dropout);
 
+  if(algorithm == "ELM")
+  {
+    net.fitOutputLayer();
+    net.useDropout(false);
+    return;
+  }
+
   Optimizer* opt;
   if(algorithm == "MBSGD")
     opt = new MBSGD;
@@ -2,6 +2,8 @@
 #include <OpenANN/util/Random.h>
 #include <OpenANN/util/AssertionMacros.h>
 #include <OpenANN/util/OpenANNException.h>
+#include <OpenANN/util/Tracer.h>
+#include <OpenANN/util/Threads.h>
 
 namespace OpenANN
 {
@@ -108,35 +110,39 @@ void Convolutional::forwardPropagate(Eigen::MatrixXd* x, Eigen::MatrixXd*& y,
   const int N = x->rows();
   a.conservativeResize(N, Eigen::NoChange);
   a.setZero();
-  #pragma omp parallel for
-  for(int n = 0; n < N; n++)
+  #pragma omp parallel num_threads(numThreads(N))
   {
-    for(int fmo = 0; fmo < fmout; fmo++)
+    OPENANN_TRACE_SPAN("Convolutional::forwardPropagate", "parallel");
+    #pragma omp for
+    for(int n = 0; n < N; n++)
     {
-      int fmInBase = 0;
-      for(int fmi = 0; fmi < fmin; fmi++, fmInBase += fmInSize)
+      for(int fmo = 0; fmo < fmout; fmo++)
       {
-        Eigen::MatrixXd& Wtmp = W[fmo][fmi];
-        for(int row = 0, outputIdx = fmo * fmOutSize; row < maxRow; row++)
+        int fmInBase = 0;
+        for(int fmi = 0; fmi < fmin; fmi++, fmInBase += fmInSize)
         {
-          for(int col = 0; col < maxCol; col++, outputIdx++)
+          Eigen::MatrixXd& Wtmp = W[fmo][fmi];
+          for(int row = 0, outputIdx = fmo * fmOutSize; row < maxRow; row++)
           {
-            OPENANN_CHECK(outputIdx < a.cols());
-            double& out = a(n, outputIdx);
-            for(int kr = 0, colBase = fmInBase + row * inCols + col;
-                kr < kernelRows; kr++, colBase += inCols)
+            for(int col = 0; col < maxCol; col++, outputIdx++)
             {
-              out += (Wtmp.row(kr).array() *
-                  (*x).block(n, colBase, 1, kernelCols).array()).sum();
+              OPENANN_CHECK(outputIdx < a.cols());
+              double& out = a(n, outputIdx);
+              for(int kr = 0, colBase = fmInBase + row * inCols + col;
+                  kr < kernelRows; kr++, colBase += inCols)
+              {
+                out += (Wtmp.row(kr).array() *
+                    (*x).block(n, colBase, 1, kernelCols).array()).sum();
+              }
             }
           }
-        }
-        if(bias)
-        {
-          int outputIdx = fmo * fmOutSize;
-          for(int row = 0; row < maxRow; row++)
-            for(int col = 0; col < maxCol; col++, outputIdx++)
-              a(n, outputIdx) += Wb(fmo, fmi);
+          if(bias)
+          {
+            int outputIdx = fmo * fmOutSize;
+            for(int row = 0; row < maxRow; row++)
+              for(int col = 0; col < maxCol; col++, outputIdx++)
+                a(n, outputIdx) += Wb(fmo, fmi);
+          }
         }
       }
     }
@@ -170,7 +176,7 @@ void Convolutional::backpropagate(Eigen::MatrixXd* ein,
   e.conservativeResize(N, Eigen::NoChange);
   e.setZero();
   Wbd.setZero();
-  #pragma omp parallel for
+  #pragma omp parallel for num_threads(numThreads())
   for(int fmo = 0; fmo < fmout; fmo++)
     for(int fmi = 0; fmi < fmin; fmi++)
       Wd[fmo][fmi].setZero();
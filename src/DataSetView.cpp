@@ -49,11 +49,8 @@ void DataSetView::finishIteration(Learner& learner)
 
 DataSetView& DataSetView::shuffle()
 {
-#if __cplusplus < 201300L		
-  std::random_shuffle(indices.begin(), indices.end());
-#else
-  std::shuffle(indices.begin(), indices.end());
-#endif
+  RandomNumberGenerator rng;
+  rng.generateIndices(indices.size(), indices, true);
   return *this;
 }
 
@@ -71,14 +68,11 @@ void split(std::vector<DataSetView>& groups, DataSet& dataset,
 
   int samplesPerGroup = std::floor(dataset.samples() / numberOfGroups + 0.5);
 
-  if(shuffling) 
-	{
-		#if __cplusplus < 201300L		
-			std::random_shuffle(indices.begin(), indices.end());
-		#else
-			std::shuffle(indices.begin(), indices.end());
-		#endif
-	}
+  if(shuffling)
+  {
+    RandomNumberGenerator rng;
+    rng.generateIndices(indices.size(), indices, true);
+  }
   for(int i = 0; i < numberOfGroups; ++i)
   {
     std::vector<int>::iterator it = indices.begin() + i * samplesPerGroup;
@@ -105,13 +99,10 @@ void split(std::vector<DataSetView>& groups, DataSet& dataset, double ratio,
   int samples = std::ceil(ratio * dataset.samples());
 
   if(shuffling)
-	{
-		#if __cplusplus < 201300L		
-			std::random_shuffle(indices.begin(), indices.end());
-		#else
-			std::shuffle(indices.begin(), indices.end());
-		#endif	
-	}
+  {
+    RandomNumberGenerator rng;
+    rng.generateIndices(indices.size(), indices, true);
+  }
   groups.push_back(DataSetView(dataset, indices.begin(), indices.begin() + samples));
   groups.push_back(DataSetView(dataset, indices.begin() + samples, indices.end()));
 }
@@ -138,7 +129,7 @@ DataSetView sample(DataSet& dataSet, double fraction, bool replacement)
   RandomNumberGenerator rng;
   if(replacement)
     for(int n = 0; n < samples; n++)
-      indices[n] = rng.generateIndex(dataSet.samples());
+      indices.push_back(rng.generateIndex(dataSet.samples()));
   else
     rng.generateIndices(dataSet.samples(), indices, false);
 
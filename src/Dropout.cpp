@@ -1,12 +1,14 @@
 #include <OpenANN/layers/Dropout.h>
 #include <OpenANN/util/Random.h>
+#include <OpenANN/util/Threads.h>
+#include <algorithm>
 
 namespace OpenANN
 {
 
-Dropout::Dropout(OutputInfo info, double dropoutProbability)
-  : info(info), I(info.outputs()),
-    dropoutProbability(dropoutProbability), y(1, I), dropoutMask(1, I), e(1, I)
+Dropout::Dropout(OutputInfo info, double dropoutProbability, bool inverted)
+  : info(info), I(info.outputs()), dropoutProbability(dropoutProbability),
+    inverted(inverted), masked(false), output(&y), y(1, I), e(1, I)
 {
 }
 
@@ -19,39 +21,39 @@ OutputInfo Dropout::initialize(std::vector<double*>& parameterPointers,
 void Dropout::forwardPropagate(Eigen::MatrixXd* x, Eigen::MatrixXd*& y,
                                bool dropout, double* error)
 {
-  const int N = x->rows();
-  dropoutMask.conservativeResize(N, Eigen::NoChange);
-  dropoutMask.fill(1.0);
-  if(dropout)
+  masked = dropout && dropoutProbability > 0.0;
+  if(masked)
   {
-    // Sample dropout mask
+    // Sample dropout mask, a set bit means that the neuron is active
     RandomNumberGenerator rng;
-    for(int n = 0; n < N; n++)
-    {
-      for(int i = 0; i < I; i++)
-        if(rng.generate<double>(0.0, 1.0) < dropoutProbability)
-          dropoutMask(n, i) = 0.0;
-    }
+    rng.fillBernoulliMask(dropoutMask, x->rows() * x->cols(),
+                          1.0 - dropoutProbability);
+    applyMask(*x, this->y);
+    output = &this->y;
   }
-  else if(dropoutProbability > 0.0)
+  else
   {
-    // Scale down after training
-    dropoutMask *= 1.0 - dropoutProbability;
+    // Inverted dropout does not modify the input after training
+    scaleAfterTraining(x, output, this->y);
   }
-  this->y = dropoutMask.cwiseProduct(*x);
-  y = &this->y;
+  y = output;
 }
 
 void Dropout::backpropagate(Eigen::MatrixXd* ein, Eigen::MatrixXd*& eout,
                             bool backpropToPrevious)
 {
-  e = dropoutMask.cwiseProduct(*ein);
-  eout = &e;
+  if(masked)
+  {
+    applyMask(*ein, e);
+    eout = &e;
+  }
+  else
+    scaleAfterTraining(ein, eout, e);
 }
 
 Eigen::MatrixXd& Dropout::getOutput()
 {
-  return y;
+  return *output;
 }
 
 Eigen::VectorXd Dropout::getParameters()
@@ -59,4 +61,37 @@ Eigen::VectorXd Dropout::getParameters()
   return Eigen::VectorXd();
 }
 
+void Dropout::applyMask(const Eigen::MatrixXd& in, Eigen::MatrixXd& out)
+{
+  out.conservativeResize(in.rows(), in.cols());
+  const int size = in.rows() * in.cols();
+  const int words = (size + 31) / 32;
+  const double scale = inverted ? 1.0 / (1.0 - dropoutProbability) : 1.0;
+  const double* inPtr = in.data();
+  double* outPtr = out.data();
+  #pragma omp parallel for if(words > 256) num_threads(numThreads())
+  for(int w = 0; w < words; w++)
+  {
+    const uint32_t word = dropoutMask[w];
+    const int end = std::min(32, size - 32 * w);
+    for(int b = 0; b < end; b++)
+    {
+      const int idx = 32 * w + b;
+      outPtr[idx] = ((word >> b) & 1u) ? scale * inPtr[idx] : 0.0;
+    }
+  }
+}
+
+void Dropout::scaleAfterTraining(Eigen::MatrixXd* in, Eigen::MatrixXd*& out,
+                                 Eigen::MatrixXd& buffer)
+{
+  if(inverted || dropoutProbability == 0.0)
+    out = in;
+  else
+  {
+    buffer = (1.0 - dropoutProbability) * *in;
+    out = &buffer;
+  }
+}
+
 }
@@ -1,15 +1,191 @@
 #include <OpenANN/Evaluator.h>
 #include <OpenANN/Evaluation.h>
 #include <OpenANN/Learner.h>
+#include <OpenANN/Net.h>
 #include <OpenANN/io/DataSet.h>
+#include <OpenANN/util/Random.h>
 #include <OpenANN/util/Stopwatch.h>
+#include <OpenANN/util/Tracer.h>
+#include <Eigen/Core>
+#include <pthread.h>
+#include <algorithm>
+#include <deque>
+#include <sstream>
 
 namespace OpenANN
 {
 
-MulticlassEvaluator::MulticlassEvaluator(int interval, Logger::Target target)
+/**
+ * @class EvaluationWorker
+ *
+ * Evaluates parameter snapshots of a network in a background thread.
+ */
+class EvaluationWorker
+{
+  struct Job
+  {
+    int iteration;
+    unsigned long time;
+    Eigen::VectorXd parameters;
+  };
+
+  Logger& logger;
+  Net* replica;
+  DataSet* original;
+  Eigen::MatrixXd X, T;
+  std::deque<Job> jobs;
+  bool busy, stop;
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t changed;
+
+public:
+  EvaluationWorker(Logger& logger)
+    : logger(logger), replica(0), original(0), busy(false), stop(false)
+  {
+    pthread_mutex_init(&mutex, 0);
+    pthread_cond_init(&changed, 0);
+    pthread_create(&thread, 0, &EvaluationWorker::run, this);
+  }
+
+  ~EvaluationWorker()
+  {
+    pthread_mutex_lock(&mutex);
+    stop = true;
+    pthread_cond_broadcast(&changed);
+    pthread_mutex_unlock(&mutex);
+    pthread_join(thread, 0);
+    pthread_cond_destroy(&changed);
+    pthread_mutex_destroy(&mutex);
+    if(replica)
+      delete replica;
+  }
+
+  void push(Net& net, DataSet& dataSet, int iteration, unsigned long time)
+  {
+    // The replica and the data may only be modified by the training thread
+    // while the worker is idle.
+    if(!replica || original != &dataSet)
+    {
+      wait();
+      if(!replica)
+      {
+        std::stringstream architecture;
+        net.save(architecture);
+        // The initial parameters of the replica will be overwritten, they
+        // must not consume random numbers of the training
+        RandomStream stream(0);
+        replica = new Net;
+        replica->load(architecture);
+      }
+      copy(dataSet);
+    }
+
+    Job job;
+    job.iteration = iteration;
+    job.time = time;
+    job.parameters = net.currentParameters();
+    pthread_mutex_lock(&mutex);
+    jobs.push_back(job);
+    pthread_cond_broadcast(&changed);
+    pthread_mutex_unlock(&mutex);
+  }
+
+  void wait()
+  {
+    pthread_mutex_lock(&mutex);
+    while(busy || !jobs.empty())
+      pthread_cond_wait(&changed, &mutex);
+    pthread_mutex_unlock(&mutex);
+  }
+
+private:
+  void copy(DataSet& dataSet)
+  {
+    const int N = dataSet.samples();
+    X.resize(N, dataSet.inputs());
+    T.resize(N, dataSet.outputs());
+    for(int n = 0; n < N; n++)
+    {
+      X.row(n) = dataSet.getInstance(n);
+      T.row(n) = dataSet.getTarget(n);
+    }
+    original = &dataSet;
+  }
+
+  static void* run(void* self)
+  {
+    static_cast<EvaluationWorker*>(self)->process();
+    return 0;
+  }
+
+  void process()
+  {
+    while(true)
+    {
+      pthread_mutex_lock(&mutex);
+      while(!stop && jobs.empty())
+        pthread_cond_wait(&changed, &mutex);
+      if(jobs.empty())
+      {
+        pthread_mutex_unlock(&mutex);
+        break;
+      }
+      Job job = jobs.front();
+      jobs.pop_front();
+      busy = true;
+      pthread_mutex_unlock(&mutex);
+
+      evaluate(job);
+
+      pthread_mutex_lock(&mutex);
+      busy = false;
+      pthread_cond_broadcast(&changed);
+      pthread_mutex_unlock(&mutex);
+    }
+  }
+
+  void evaluate(const Job& job)
+  {
+    OPENANN_TRACE_SPAN("MulticlassEvaluator::evaluate", "evaluation");
+    replica->setParameters(job.parameters);
+
+    // Propagate blocks of instances to limit the size of the activations
+    const int blockSize = 256;
+    const int N = X.rows();
+    double e = 0.0;
+    int correct = 0;
+    int wrong = 0;
+    for(int n = 0; n < N; n += blockSize)
+    {
+      const int rows = std::min<int>(blockSize, N - n);
+      Eigen::MatrixXd Y = (*replica)(Eigen::MatrixXd(X.middleRows(n, rows)));
+      e += (Y - T.middleRows(n, rows)).squaredNorm();
+      for(int i = 0; i < rows; i++)
+      {
+        const int j1 = oneOfCDecoding(T.row(n + i).transpose());
+        const int j2 = oneOfCDecoding(Y.row(i).transpose());
+        if(j1 == j2)
+          correct++;
+        else
+          wrong++;
+      }
+    }
+    e /= N;
+
+    // Write the whole line at once, the console is shared with other threads
+    std::stringstream line;
+    line << job.iteration << " " << e << " " << correct << " " << wrong << " "
+        << job.time << "\n";
+    logger << line.str();
+  }
+};
+
+MulticlassEvaluator::MulticlassEvaluator(int interval, Logger::Target target,
+                                         bool asynchronous)
   : interval(interval), logger(new Logger(target, "evaluation")),
-    stopwatch(new Stopwatch), iteration(0)
+    stopwatch(new Stopwatch), iteration(0),
+    worker(asynchronous ? new EvaluationWorker(*logger) : 0)
 {
   *logger << "# Multiclass problem\n"
           << "# it. SSE corr. wrong time (ms)\n\n";
@@ -18,6 +194,8 @@ MulticlassEvaluator::MulticlassEvaluator(int interval, Logger::Target target)
 
 MulticlassEvaluator::~MulticlassEvaluator()
 {
+  if(worker)
+    delete worker;
   delete logger;
   delete stopwatch;
 }
@@ -26,6 +204,15 @@ void MulticlassEvaluator::evaluate(Learner& learner, DataSet& dataSet)
 {
   if(++iteration % interval == 0)
   {
+    Net* net = dynamic_cast<Net*>(&learner);
+    if(worker && net && net->isReplicable())
+    {
+      worker->push(*net, dataSet, iteration,
+                   stopwatch->stop(Stopwatch::MILLISECOND));
+      return;
+    }
+
+    OPENANN_TRACE_SPAN("MulticlassEvaluator::evaluate", "evaluation");
     const int N = dataSet.samples();
 
     double e = 0.0;
@@ -50,4 +237,10 @@ void MulticlassEvaluator::evaluate(Learner& learner, DataSet& dataSet)
   }
 }
 
+void MulticlassEvaluator::wait()
+{
+  if(worker)
+    worker->wait();
+}
+
 }
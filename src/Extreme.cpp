@@ -32,7 +32,7 @@ void Extreme::forwardPropagate(Eigen::MatrixXd* x, Eigen::MatrixXd*& y,
 {
   this->x = x;
   // Activate neurons
-  a = *x * W.leftCols(I).transpose();
+  a.noalias() = *x * W.leftCols(I).transpose();
   if(bias)
     a.rowwise() += W.col(I).transpose();
   // Compute output
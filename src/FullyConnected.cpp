@@ -67,7 +67,7 @@ void FullyConnected::forwardPropagate(Eigen::MatrixXd* x, Eigen::MatrixXd*& y,
   this->y.conservativeResize(N, Eigen::NoChange);
   this->x = x;
   // Activate neurons
-  a = *x * W.transpose();
+  a.noalias() = *x * W.transpose();
   if(bias)
     a.rowwise() += b.transpose();
   // Compute output
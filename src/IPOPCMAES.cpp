@@ -83,6 +83,14 @@ void IPOPCMAES::setStopCriteria(const StoppingCriteria& stop)
   }
 }
 
+Optimizer* IPOPCMAES::clone()
+{
+  IPOPCMAES* ipopcmaes = new IPOPCMAES;
+  ipopcmaes->setStopCriteria(stop);
+  ipopcmaes->setSigma0(sigma0);
+  return ipopcmaes;
+}
+
 bool IPOPCMAES::restart()
 {
   OPENANN_CHECK(opt);
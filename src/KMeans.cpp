@@ -1,22 +1,148 @@
 #include <OpenANN/KMeans.h>
+#include <OpenANN/util/AssertionMacros.h>
+#include <OpenANN/util/Threads.h>
+#include <OpenANN/util/BinaryIO.h>
+#include <algorithm>
+#include <cmath>
 #include <limits>
+#include <numeric>
 
 namespace OpenANN
 {
 
-KMeans::KMeans(int D, int K)
-  : D(D), K(K), C(K, D), v(K), initialized(false)
+//! Number of instances whose distances will be computed at once.
+const int KMEANS_BLOCK_SIZE = 256;
+
+KMeans::KMeans(int D, int K, int maxIterations)
+  : D(D), K(K), maxIterations(maxIterations), C(K, D), v(K),
+    initialized(false)
 {
 }
 
 Transformer& KMeans::fit(const Eigen::MatrixXd& X)
 {
   OPENANN_CHECK_EQUALS(X.cols(), D);
+  const int N = X.rows();
+  initialize(X, 2 + (int) std::log((double) K));
 
-  if(!initialized)
-    initialize(X);
+  // Hamerly's algorithm: we maintain an upper bound of the distance of each
+  // instance to its center and a lower bound of the distance to all other
+  // centers. The distances only have to be computed if the bounds overlap.
+  // The initial assignment computes the exact bounds.
+  clusterIndices.resize(N);
+  Eigen::VectorXd upper(N), lower(N);
+  #pragma omp parallel for num_threads(numThreads())
+  for(int n = 0; n < N; n++)
+  {
+    int cluster = 0;
+    double best = std::numeric_limits<double>::max();
+    double second = std::numeric_limits<double>::max();
+    for(int k = 0; k < K; k++)
+    {
+      const double distance = (X.row(n) - C.row(k)).squaredNorm();
+      if(distance < best)
+      {
+        second = best;
+        best = distance;
+        cluster = k;
+      }
+      else if(distance < second)
+        second = distance;
+    }
+    clusterIndices[n] = cluster;
+    upper(n) = std::sqrt(best);
+    lower(n) = std::sqrt(second);
+  }
+
+  Eigen::MatrixXd sums;
+  Eigen::VectorXi counts;
+  Eigen::VectorXd shift(K), halfDistance(K);
+  for(int iteration = 0; iteration < maxIterations; iteration++)
+  {
+    // Move centers to the means of their clusters
+    clusterSums(X, sums, counts);
+    for(int k = 0; k < K; k++)
+    {
+      shift(k) = 0.0;
+      if(counts(k) > 0)
+      {
+        Eigen::VectorXd mean = sums.row(k).transpose() / (double) counts(k);
+        shift(k) = (mean - C.row(k).transpose()).norm();
+        C.row(k) = mean.transpose();
+      }
+    }
+    v = counts;
+
+    int farthest = 0;
+    for(int k = 1; k < K; k++)
+      if(shift(k) > shift(farthest))
+        farthest = k;
+    double secondShift = 0.0;
+    for(int k = 0; k < K; k++)
+      if(k != farthest)
+        secondShift = std::max(secondShift, shift(k));
 
-  OPENANN_CHECK_EQUALS(X.rows(), clusterIndices.size());
+    for(int k = 0; k < K; k++)
+    {
+      double closest = std::numeric_limits<double>::max();
+      for(int j = 0; j < K; j++)
+        if(j != k)
+          closest = std::min(closest, (C.row(k) - C.row(j)).squaredNorm());
+      halfDistance(k) = 0.5 * std::sqrt(closest);
+    }
+
+    int changed = 0;
+    #pragma omp parallel for reduction(+:changed) num_threads(numThreads())
+    for(int n = 0; n < N; n++)
+    {
+      const int assigned = clusterIndices[n];
+      upper(n) += shift(assigned);
+      lower(n) -= assigned == farthest ? secondShift : shift(farthest);
+
+      const double bound = std::max(halfDistance(assigned), lower(n));
+      if(upper(n) <= bound)
+        continue;
+      upper(n) = (X.row(n) - C.row(assigned)).norm();
+      if(upper(n) <= bound)
+        continue;
+
+      int cluster = 0;
+      double best = std::numeric_limits<double>::max();
+      double second = std::numeric_limits<double>::max();
+      for(int k = 0; k < K; k++)
+      {
+        const double distance = (X.row(n) - C.row(k)).squaredNorm();
+        if(distance < best)
+        {
+          second = best;
+          best = distance;
+          cluster = k;
+        }
+        else if(distance < second)
+          second = distance;
+      }
+      if(cluster != assigned)
+      {
+        clusterIndices[n] = cluster;
+        changed++;
+      }
+      upper(n) = std::sqrt(best);
+      lower(n) = std::sqrt(second);
+    }
+
+    if(changed == 0)
+      break;
+  }
+
+  return *this;
+}
+
+Transformer& KMeans::fitPartial(const Eigen::MatrixXd& X)
+{
+  OPENANN_CHECK_EQUALS(X.cols(), D);
+
+  if(!initialized)
+    initialize(X, 1);
 
   findClusters(X);
   updateCenters(X);
@@ -27,55 +153,182 @@ Eigen::MatrixXd KMeans::operator()(const Eigen::MatrixXd& X)
 {
   const int N = X.rows();
   Eigen::MatrixXd Y(N, K);
-  for(int n = 0; n < N; ++n)
-    for(int k = 0; k < K; k++)
-      Y(n, k) = (X.row(n) - C.row(k)).norm();
+  const int blocks = (N + KMEANS_BLOCK_SIZE - 1) / KMEANS_BLOCK_SIZE;
+  #pragma omp parallel for num_threads(numThreads())
+  for(int b = 0; b < blocks; b++)
+  {
+    const int start = b * KMEANS_BLOCK_SIZE;
+    const int rows = std::min(KMEANS_BLOCK_SIZE, N - start);
+    Eigen::MatrixXd distances;
+    squaredDistances(X, start, rows, distances);
+    Y.middleRows(start, rows) =
+        (distances.array() < 0.0).select(0.0, distances).array().sqrt();
+  }
   return Y;
 }
 
+bool KMeans::save(std::ostream& stream)
+{
+  writeBinary(stream, initialized);
+  writeBinary(stream, C);
+  writeBinary(stream, v);
+  return (bool) stream;
+}
+
+bool KMeans::load(std::istream& stream)
+{
+  bool initialized = false;
+  Eigen::MatrixXd C;
+  Eigen::VectorXi v;
+  if(!readBinary(stream, initialized) || !readBinary(stream, C) ||
+     !readBinary(stream, v) || C.rows() != K || C.cols() != D ||
+     v.rows() != K)
+    return false;
+  this->initialized = initialized;
+  this->C = C;
+  this->v = v;
+  return true;
+}
+
 Eigen::MatrixXd KMeans::getCenters()
 {
   return C;
 }
 
-void KMeans::initialize(const Eigen::MatrixXd& X)
+void KMeans::initialize(const Eigen::MatrixXd& X, int candidates)
 {
-  rng.generateIndices(X.rows(), clusterIndices, false);
-  for(int k = 0; k < K; ++k)
-    C.row(k) = X.row(clusterIndices[k]);
+  // k-means++: candidates for each center will be drawn from the instances
+  // with a probability that is proportional to the squared distance to the
+  // closest center that has already been selected. We take the candidate
+  // that reduces the sum of these distances most.
+  const int N = X.rows();
+  OPENANN_CHECK(N >= K);
+  OPENANN_CHECK(candidates >= 1);
+  C.row(0) = X.row(rng.generateIndex(N));
+  Eigen::VectorXd closest(N);
+  #pragma omp parallel for num_threads(numThreads())
+  for(int n = 0; n < N; n++)
+    closest(n) = (X.row(n) - C.row(0)).squaredNorm();
+
+  std::vector<double> cumulative(N);
+  Eigen::VectorXd candidateClosest(N), bestClosest(N);
+  for(int k = 1; k < K; k++)
+  {
+    std::partial_sum(closest.data(), closest.data() + N, cumulative.begin());
+    const double total = cumulative.back();
+    double bestPotential = std::numeric_limits<double>::max();
+    for(int c = 0; c < candidates; c++)
+    {
+      // All instances coincide with a center if the total distance is zero
+      int idx;
+      if(total > 0.0)
+      {
+        const double p = rng.generate<double>(0.0, total);
+        idx = std::upper_bound(cumulative.begin(), cumulative.end(), p) -
+              cumulative.begin();
+        idx = std::min(idx, N-1);
+      }
+      else
+        idx = rng.generateIndex(N);
+
+      double potential = 0.0;
+      #pragma omp parallel for reduction(+:potential) \
+          num_threads(numThreads())
+      for(int n = 0; n < N; n++)
+      {
+        candidateClosest(n) = std::min(closest(n),
+                                       (X.row(n) - X.row(idx)).squaredNorm());
+        potential += candidateClosest(n);
+      }
+      if(potential < bestPotential)
+      {
+        bestPotential = potential;
+        C.row(k) = X.row(idx);
+        bestClosest.swap(candidateClosest);
+      }
+    }
+    closest.swap(bestClosest);
+  }
   v.setZero();
   initialized = true;
 }
 
+void KMeans::squaredDistances(const Eigen::MatrixXd& X, int start, int rows,
+                              Eigen::MatrixXd& Y)
+{
+  Y.noalias() = -2.0 * X.middleRows(start, rows) * C.transpose();
+  Y.colwise() += X.middleRows(start, rows).rowwise().squaredNorm();
+  Y.rowwise() += C.rowwise().squaredNorm().transpose();
+}
+
 void KMeans::findClusters(const Eigen::MatrixXd& X)
 {
   const int N = X.rows();
-  for(int n = 0; n < N; ++n)
+  clusterIndices.resize(N);
+  const int blocks = (N + KMEANS_BLOCK_SIZE - 1) / KMEANS_BLOCK_SIZE;
+  #pragma omp parallel for num_threads(numThreads())
+  for(int b = 0; b < blocks; b++)
   {
-    int cluster = 0;
-    double shortedDistance = std::numeric_limits<double>::max();
-    for(int k = 0; k < K; k++)
+    const int start = b * KMEANS_BLOCK_SIZE;
+    const int rows = std::min(KMEANS_BLOCK_SIZE, N - start);
+    Eigen::MatrixXd distances;
+    squaredDistances(X, start, rows, distances);
+    for(int i = 0; i < rows; i++)
     {
-      const double distance = (C.row(k) - X.row(n)).squaredNorm();
-      if(distance < shortedDistance)
-      {
-        cluster = k;
-        shortedDistance = distance;
-      }
+      int cluster;
+      distances.row(i).minCoeff(&cluster);
+      clusterIndices[start + i] = cluster;
     }
-    clusterIndices[n] = cluster;
   }
 }
 
-void KMeans::updateCenters(const Eigen::MatrixXd& X)
+void KMeans::clusterSums(const Eigen::MatrixXd& X, Eigen::MatrixXd& sums,
+                         Eigen::VectorXi& counts)
 {
+  // Each thread sums up a contiguous range of instances, the partial sums
+  // are merged in a fixed order
   const int N = X.rows();
-  for(int n = 0; n < N; ++n)
+  const int threads = numThreads(N);
+  std::vector<Eigen::MatrixXd> partialSums(threads);
+  std::vector<Eigen::VectorXi> partialCounts(threads);
+  #pragma omp parallel for schedule(static, 1) num_threads(threads)
+  for(int t = 0; t < threads; t++)
+  {
+    partialSums[t].setZero(K, D);
+    partialCounts[t].setZero(K);
+    const int first = (long) N * t / threads;
+    const int last = (long) N * (t + 1) / threads;
+    for(int n = first; n < last; n++)
+    {
+      partialSums[t].row(clusterIndices[n]) += X.row(n);
+      partialCounts[t](clusterIndices[n])++;
+    }
+  }
+
+  sums.setZero(K, D);
+  counts.setZero(K);
+  for(int t = 0; t < threads; t++)
+  {
+    sums += partialSums[t];
+    counts += partialCounts[t];
+  }
+}
+
+void KMeans::updateCenters(const Eigen::MatrixXd& X)
+{
+  // Mini-batch k-means updates each center with a learning rate of
+  // 1 / (number of assigned instances). The sequence of updates of a center
+  // is equivalent to the running mean of all instances assigned to it.
+  Eigen::MatrixXd sums;
+  Eigen::VectorXi counts;
+  clusterSums(X, sums, counts);
+  for(int k = 0; k < K; k++)
   {
-    const int cluster = clusterIndices[n];
-    v(cluster)++;
-    const double eta = 1.0 / (double) v(cluster);
-    C.row(cluster) += eta * (X.row(n) - C.row(cluster));
+    if(counts(k) == 0)
+      continue;
+    C.row(k) = ((double) v(k) * C.row(k) + sums.row(k)) /
+               (double) (v(k) + counts(k));
+    v(k) += counts(k);
   }
 }
 
@@ -0,0 +1,162 @@
+// Definitions of the kernels in OpenANN/util/Kernels.h. This file will be
+// included once per instruction set, each time with another
+// OPENANN_KERNEL_NAMESPACE and OPENANN_KERNEL_ISA. The translation units
+// are compiled with different flags (e.g. -mavx2 -mfma), hence the kernels
+// must not call inline functions or templates that would be emitted as weak
+// symbols: the linker could pick a variant the processor does not support.
+//
+// The exponential function and the hyperbolic tangent are computed without
+// calls into libm so that the compiler can vectorize the loops. All variants
+// evaluate exactly the same floating point operations and the files are
+// compiled with -ffp-contract=off, i.e. without fused multiply-adds, so that
+// the results do not depend on the processor. -fno-trapping-math allows the
+// compiler to evaluate both sides of the conditional expressions.
+
+#include <OpenANN/util/Kernels.h>
+#include <cstring>
+#include <stdint.h>
+
+namespace OpenANN
+{
+
+namespace OPENANN_KERNEL_NAMESPACE
+{
+
+/**
+ * exp(x) with a relative error of about 1e-16. Results below exp(-708) will
+ * be rounded up to exp(-708) and results above exp(708) down to exp(708).
+ */
+static inline __attribute__((always_inline)) double exponential(double x)
+{
+  x = x < -708.0 ? -708.0 : x;
+  x = x > 708.0 ? 708.0 : x;
+  // exp(x) = 2^n * exp(r), where n = round(x / ln 2) and |r| <= ln(2) / 2.
+  // Adding 1.5 * 2^52 rounds to an integer that is stored in the lowest bits
+  // of the mantissa.
+  const double shift = 6755399441055744.0;
+  const double t = x * 1.4426950408889634 + shift;
+  const double n = t - shift;
+  const double r = (x - n * 6.93147180369123816490e-01) -
+                   n * 1.90821492927058770002e-10;
+  // Taylor series of exp(r)
+  double p = 1.0 / 6227020800.0;
+  p = p * r + 1.0 / 479001600.0;
+  p = p * r + 1.0 / 39916800.0;
+  p = p * r + 1.0 / 3628800.0;
+  p = p * r + 1.0 / 362880.0;
+  p = p * r + 1.0 / 40320.0;
+  p = p * r + 1.0 / 5040.0;
+  p = p * r + 1.0 / 720.0;
+  p = p * r + 1.0 / 120.0;
+  p = p * r + 1.0 / 24.0;
+  p = p * r + 1.0 / 6.0;
+  p = p * r + 0.5;
+  p = p * r + 1.0;
+  p = p * r + 1.0;
+  // Construct 2^n from the bits of n
+  int64_t bits;
+  std::memcpy(&bits, &t, sizeof(bits));
+  bits = (bits + 1023) << 52;
+  double scale;
+  std::memcpy(&scale, &bits, sizeof(scale));
+  return p * scale;
+}
+
+/**
+ * tanh(a) with a relative error of about 1e-15.
+ */
+static inline __attribute__((always_inline))
+double hyperbolicTangent(double a)
+{
+  const double x = a < 0.0 ? -a : a;
+  const double e = exponential(-2.0 * x);
+  const double large = (1.0 - e) / (1.0 + e);
+  // 1 - e would lose precision for small x, use the Taylor series instead
+  const double x2 = x * x;
+  double p = 62.0 / 2835.0;
+  p = p * x2 - 17.0 / 315.0;
+  p = p * x2 + 2.0 / 15.0;
+  p = p * x2 - 1.0 / 3.0;
+  const double small = x + x * x2 * p;
+  const double y = x < 0.03 ? small : large;
+  return a < 0.0 ? -y : y;
+}
+
+void logistic(const double* a, double* z, int n)
+{
+  for(int i = 0; i < n; i++)
+  {
+    const double y = 1.0 / (1.0 + exponential(-a[i]));
+    z[i] = a[i] < -45.0 ? 0.0 : (a[i] > 45.0 ? 1.0 : y);
+  }
+}
+
+void logisticDerivative(const double* z, double* gd, int n)
+{
+  for(int i = 0; i < n; i++)
+    gd[i] = z[i] * (1.0 - z[i]);
+}
+
+void tanh(const double* a, double* z, int n)
+{
+  for(int i = 0; i < n; i++)
+    z[i] = hyperbolicTangent(a[i]);
+}
+
+void tanhDerivative(const double* z, double* gd, int n)
+{
+  for(int i = 0; i < n; i++)
+    gd[i] = 1.0 - z[i] * z[i];
+}
+
+void scaledTanh(const double* a, double* z, int n)
+{
+  for(int i = 0; i < n; i++)
+    z[i] = 1.7159 * hyperbolicTangent(0.66666667 * a[i]);
+}
+
+void scaledTanhDerivative(const double* z, double* gd, int n)
+{
+  for(int i = 0; i < n; i++)
+    gd[i] = 0.66666667 / 1.7159 * (1.7159 + z[i]) * (1.7159 - z[i]);
+}
+
+void rectifier(const double* a, double* z, int n)
+{
+  for(int i = 0; i < n; i++)
+    z[i] = a[i] > 0.0 ? a[i] : 0.0;
+}
+
+void rectifierDerivative(const double* z, double* gd, int n)
+{
+  for(int i = 0; i < n; i++)
+    gd[i] = z[i] > 0.0 ? 1.0 : 0.0;
+}
+
+void momentumUpdate(double* parameters, double* momentum,
+                    const double* gradient, double eta, double alpha, int n)
+{
+  for(int i = 0; i < n; i++)
+  {
+    momentum[i] = eta * momentum[i] - alpha * gradient[i];
+    parameters[i] += momentum[i];
+  }
+}
+
+extern const Kernels kernels =
+{
+  OPENANN_KERNEL_ISA,
+  &logistic,
+  &logisticDerivative,
+  &tanh,
+  &tanhDerivative,
+  &scaledTanh,
+  &scaledTanhDerivative,
+  &rectifier,
+  &rectifierDerivative,
+  &momentumUpdate
+};
+
+} // namespace OPENANN_KERNEL_NAMESPACE
+
+} // namespace OpenANN
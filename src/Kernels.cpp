@@ -0,0 +1,75 @@
+#define OPENANN_KERNEL_NAMESPACE generic
+#define OPENANN_KERNEL_ISA "generic"
+#include "KernelImplementation.h"
+#include <cstdlib>
+
+namespace OpenANN
+{
+
+#ifdef OPENANN_KERNELS_AVX2
+namespace avx2 { extern const Kernels kernels; }
+#endif
+#ifdef OPENANN_KERNELS_AVX512
+namespace avx512 { extern const Kernels kernels; }
+#endif
+
+namespace
+{
+
+/**
+ * Get the kernels for the given instruction set.
+ * @return kernels or 0 if the instruction set is not available
+ */
+const Kernels* kernelsFor(const std::string& isa)
+{
+  if(isa == "generic")
+    return &generic::kernels;
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  __builtin_cpu_init();
+#ifdef OPENANN_KERNELS_AVX2
+  if(isa == "avx2" && __builtin_cpu_supports("avx2") &&
+     __builtin_cpu_supports("fma"))
+    return &avx2::kernels;
+#endif
+#ifdef OPENANN_KERNELS_AVX512
+  if(isa == "avx512" && __builtin_cpu_supports("avx512f"))
+    return &avx512::kernels;
+#endif
+#endif
+  return 0;
+}
+
+const Kernels* bestKernels()
+{
+  const char* isa = std::getenv("OPENANN_KERNELS");
+  const Kernels* selected = isa ? kernelsFor(isa) : 0;
+  if(!selected)
+    selected = kernelsFor("avx512");
+  if(!selected)
+    selected = kernelsFor("avx2");
+  if(!selected)
+    selected = kernelsFor("generic");
+  return selected;
+}
+
+const Kernels* selectedKernels = 0;
+
+}
+
+const Kernels& kernels()
+{
+  // Might be called during static initialization of other translation units
+  if(!selectedKernels)
+    selectedKernels = bestKernels();
+  return *selectedKernels;
+}
+
+bool useKernels(const std::string& isa)
+{
+  const Kernels* selected = kernelsFor(isa);
+  if(selected)
+    selectedKernels = selected;
+  return selected != 0;
+}
+
+} // namespace OpenANN
@@ -0,0 +1,6 @@
+// Compiled with -mavx2 -mfma if RUNTIME_CPU_DISPATCH is enabled
+#ifdef OPENANN_KERNELS_AVX2
+#define OPENANN_KERNEL_NAMESPACE avx2
+#define OPENANN_KERNEL_ISA "avx2"
+#include "KernelImplementation.h"
+#endif
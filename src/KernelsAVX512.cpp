@@ -0,0 +1,6 @@
+// Compiled with -mavx512f -mavx2 -mfma if RUNTIME_CPU_DISPATCH is enabled
+#ifdef OPENANN_KERNELS_AVX512
+#define OPENANN_KERNEL_NAMESPACE avx512
+#define OPENANN_KERNEL_ISA "avx512"
+#include "KernelImplementation.h"
+#endif
@@ -5,6 +5,8 @@
 #include <OpenANN/optimization/StoppingInterrupt.h>
 #include <OpenANN/util/AssertionMacros.h>
 #include <OpenANN/util/OpenANNException.h>
+#include <OpenANN/util/Stopwatch.h>
+#include <OpenANN/util/Tracer.h>
 #include <OpenANN/io/Logger.h>
 
 namespace OpenANN
@@ -20,6 +22,13 @@ void LBFGS::setStopCriteria(const StoppingCriteria& stop)
   this->stop = stop;
 }
 
+Optimizer* LBFGS::clone()
+{
+  LBFGS* lbfgs = new LBFGS(m);
+  lbfgs->setStopCriteria(stop);
+  return lbfgs;
+}
+
 void LBFGS::setOptimizable(Optimizable& optimizable)
 {
   this->opt = &optimizable;
@@ -43,11 +52,14 @@ void LBFGS::optimize()
 
 bool LBFGS::step()
 {
+  OPENANN_TRACE_SPAN("LBFGS::step", "optimizer");
   OPENANN_CHECK(opt);
   if(iteration < 0)
     initialize();
   OPENANN_CHECK(n > 0);
 
+  Stopwatch stepTime;
+
   try
   {
     while(alglib_impl::minlbfgsiteration(state.c_ptr(), &envState))
@@ -63,6 +75,9 @@ bool LBFGS::step()
         {
           iteration = state.c_ptr()->repiterationscount;
           opt->finishedIteration();
+          metrics.finishedStep(stepTime.stop() / 1e6, opt->examples(),
+                               error, iteration,
+                               stop.maximalIterations);
           return true;
         }
         continue;
@@ -80,6 +95,9 @@ bool LBFGS::step()
         {
           iteration = state.c_ptr()->repiterationscount;
           opt->finishedIteration();
+          metrics.finishedStep(stepTime.stop() / 1e6, opt->examples(),
+                               error, iteration,
+                               stop.maximalIterations);
           return true;
         }
         continue;
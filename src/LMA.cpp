@@ -6,6 +6,8 @@
 #include <OpenANN/util/AssertionMacros.h>
 #include <OpenANN/util/Random.h>
 #include <OpenANN/util/OpenANNException.h>
+#include <OpenANN/util/Stopwatch.h>
+#include <OpenANN/util/Tracer.h>
 #include <OpenANN/io/Logger.h>
 #include <limits>
 
@@ -31,6 +33,13 @@ void LMA::setStopCriteria(const StoppingCriteria& stop)
   this->stop = stop;
 }
 
+Optimizer* LMA::clone()
+{
+  LMA* lma = new LMA;
+  lma->setStopCriteria(stop);
+  return lma;
+}
+
 void LMA::optimize()
 {
   OPENANN_CHECK(opt);
@@ -50,11 +59,14 @@ void LMA::optimize()
 
 bool LMA::step()
 {
+  OPENANN_TRACE_SPAN("LMA::step", "optimizer");
   OPENANN_CHECK(opt);
   if(iteration < 0)
     initialize();
   OPENANN_CHECK(n > 0);
 
+  Stopwatch stepTime;
+
   try
   {
     while(alglib_impl::minlmiteration(state.c_ptr(), &envState))
@@ -70,6 +82,9 @@ bool LMA::step()
         {
           iteration = state.c_ptr()->repiterationscount;
           opt->finishedIteration();
+          metrics.finishedStep(stepTime.stop() / 1e6, opt->examples(),
+                               errorValues.mean(), iteration,
+                               stop.maximalIterations);
           return true;
         }
         continue;
@@ -90,6 +105,9 @@ bool LMA::step()
         {
           iteration = state.c_ptr()->repiterationscount;
           opt->finishedIteration();
+          metrics.finishedStep(stepTime.stop() / 1e6, opt->examples(),
+                               errorValues.mean(), iteration,
+                               stop.maximalIterations);
           return true;
         }
         continue;
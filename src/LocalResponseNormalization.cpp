@@ -1,5 +1,7 @@
 #include <OpenANN/layers/LocalResponseNormalization.h>
 #include <OpenANN/util/Random.h>
+#include <OpenANN/util/Tracer.h>
+#include <OpenANN/util/Threads.h>
 
 namespace OpenANN
 {
@@ -36,26 +38,30 @@ void LocalResponseNormalization::forwardPropagate(Eigen::MatrixXd* x,
   denoms.conservativeResize(N, Eigen::NoChange);
   this->x = x;
 
-  #pragma omp parallel for
-  for(int n = 0; n < N; n++)
+  #pragma omp parallel num_threads(numThreads(N))
   {
-    for(int fmOut = 0, outputIdx = 0; fmOut < fm; fmOut++)
+    OPENANN_TRACE_SPAN("LocalResponseNormalization::forwardPropagate", "parallel");
+    #pragma omp for
+    for(int n = 0; n < N; n++)
     {
-      for(int r = 0; r < rows; r++)
+      for(int fmOut = 0, outputIdx = 0; fmOut < fm; fmOut++)
       {
-        for(int c = 0; c < cols; c++, outputIdx++)
+        for(int r = 0; r < rows; r++)
         {
-          double denom = 0.0;
-          const int fmInMin = std::max(0, fmOut - n / 2);
-          const int fmInMax = std::min(fm - 1, fmOut + n / 2);
-          for(int fmIn = fmInMin; fmIn < fmInMax; fmIn++)
+          for(int c = 0; c < cols; c++, outputIdx++)
           {
-            register double a = (*x)(n, fmIn * fmSize + r * cols + c);
-            denom += a * a;
+            double denom = 0.0;
+            const int fmInMin = std::max(0, fmOut - n / 2);
+            const int fmInMax = std::min(fm - 1, fmOut + n / 2);
+            for(int fmIn = fmInMin; fmIn < fmInMax; fmIn++)
+            {
+              register double a = (*x)(n, fmIn * fmSize + r * cols + c);
+              denom += a * a;
+            }
+            denom = k + alpha * denom;
+            denoms(n, outputIdx) = denom;
+            this->y(n, outputIdx) = (*x)(n, outputIdx) * std::pow(denom, -beta);
           }
-          denom = k + alpha * denom;
-          denoms(n, outputIdx) = denom;
-          this->y(n, outputIdx) = (*x)(n, outputIdx) * std::pow(denom, -beta);
         }
       }
     }
@@ -72,22 +78,26 @@ void LocalResponseNormalization::backpropagate(Eigen::MatrixXd* ein,
   etmp = (*ein).cwiseProduct(y).cwiseProduct(denoms.cwiseInverse()).array() *
          (-2.0 * alpha * beta);
 
-  #pragma omp parallel for
-  for(int n = 0; n < N; n++)
+  #pragma omp parallel num_threads(numThreads(N))
   {
-    for(int fmOut = 0, outputIdx = 0; fmOut < fm; fmOut++)
+    OPENANN_TRACE_SPAN("LocalResponseNormalization::backpropagate", "parallel");
+    #pragma omp for
+    for(int n = 0; n < N; n++)
     {
-      for(int r = 0; r < rows; r++)
+      for(int fmOut = 0, outputIdx = 0; fmOut < fm; fmOut++)
       {
-        for(int c = 0; c < cols; c++, outputIdx++)
+        for(int r = 0; r < rows; r++)
         {
-          double nom = 0.0;
-          const int fmInMin = std::max(0, fmOut - n / 2);
-          const int fmInMax = std::min(fm - 1, fmOut + n / 2);
-          for(int fmIn = fmInMin; fmIn < fmInMax; fmIn++)
-            nom += etmp(fmIn * fmSize + r * cols + c);
-          e(n, outputIdx) = (*x)(n, outputIdx) * nom + (*ein)(n, outputIdx) *
-                            std::pow(denoms(n, outputIdx), -beta);
+          for(int c = 0; c < cols; c++, outputIdx++)
+          {
+            double nom = 0.0;
+            const int fmInMin = std::max(0, fmOut - n / 2);
+            const int fmInMax = std::min(fm - 1, fmOut + n / 2);
+            for(int fmIn = fmInMin; fmIn < fmInMax; fmIn++)
+              nom += etmp(fmIn * fmSize + r * cols + c);
+            e(n, outputIdx) = (*x)(n, outputIdx) * nom + (*ein)(n, outputIdx) *
+                              std::pow(denoms(n, outputIdx), -beta);
+          }
         }
       }
     }
@@ -2,10 +2,213 @@
 #include <OpenANN/util/AssertionMacros.h>
 #include <iomanip>
 #include <ctime>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include <pthread.h>
+#include <sched.h>
 
 namespace OpenANN
 {
 
+namespace
+{
+
+/**
+ * Writes messages in a background thread.
+ *
+ * Producers reserve slots of a bounded ring buffer with a compare-and-swap
+ * (Vyukov's MPMC queue), i.e. they never take a lock unless the writer is
+ * sleeping. When the buffer is full, producers wait for the writer.
+ */
+class AsynchronousWriter
+{
+  struct Record
+  {
+    volatile unsigned long sequence;
+    std::ostream* stream;
+    std::string text;
+  };
+
+  static const unsigned long CAPACITY = 4096;
+  std::vector<Record> ring;
+  volatile unsigned long enqueuePosition;
+  volatile unsigned long dequeuePosition;
+  //! Number of records that have been written and flushed
+  volatile unsigned long written;
+  volatile bool sleeping;
+  volatile bool asynchronous;
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t wakeUp;
+
+public:
+  AsynchronousWriter()
+    : ring(CAPACITY), enqueuePosition(0), dequeuePosition(0), written(0),
+      sleeping(false), asynchronous(true)
+  {
+    for(unsigned long i = 0; i < CAPACITY; i++)
+      ring[i].sequence = i;
+    pthread_mutex_init(&mutex, 0);
+    pthread_cond_init(&wakeUp, 0);
+    pthread_create(&thread, 0, &AsynchronousWriter::run, this);
+    // The writer is never destroyed because messages might be logged by
+    // destructors of static objects. Remaining messages are written at exit.
+    std::atexit(&AsynchronousWriter::shutdown);
+  }
+
+  static AsynchronousWriter& instance()
+  {
+    static AsynchronousWriter* writer = new AsynchronousWriter;
+    return *writer;
+  }
+
+  void write(std::ostream& stream, const std::string& text)
+  {
+    if(!asynchronous)
+    {
+      stream << text << std::flush;
+      return;
+    }
+
+    unsigned long position = enqueuePosition;
+    Record* record;
+    while(true)
+    {
+      record = &ring[position % CAPACITY];
+      const long difference = (long) record->sequence - (long) position;
+      if(difference == 0)
+      {
+        if(__sync_bool_compare_and_swap(&enqueuePosition, position,
+                                        position + 1))
+          break;
+      }
+      else if(difference < 0)
+      {
+        // The buffer is full
+        notify();
+        sched_yield();
+      }
+      position = enqueuePosition;
+    }
+    record->stream = &stream;
+    record->text = text;
+    __sync_synchronize();
+    record->sequence = position + 1;
+    if(sleeping)
+      notify();
+  }
+
+  void flush()
+  {
+    const unsigned long target = enqueuePosition;
+    while(written < target)
+    {
+      notify();
+      sched_yield();
+    }
+  }
+
+  void setAsynchronous(bool asynchronous)
+  {
+    if(!asynchronous)
+      flush();
+    this->asynchronous = asynchronous;
+  }
+
+private:
+  static void* run(void* self)
+  {
+    static_cast<AsynchronousWriter*>(self)->process();
+    return 0;
+  }
+
+  static void shutdown()
+  {
+    instance().setAsynchronous(false);
+  }
+
+  void notify()
+  {
+    pthread_mutex_lock(&mutex);
+    pthread_cond_signal(&wakeUp);
+    pthread_mutex_unlock(&mutex);
+  }
+
+  void process()
+  {
+    std::vector<std::ostream*> streams;
+    while(true)
+    {
+      while(true)
+      {
+        Record& record = ring[dequeuePosition % CAPACITY];
+        if(record.sequence != dequeuePosition + 1)
+          break;
+        __sync_synchronize();
+        *record.stream << record.text;
+        if(std::find(streams.begin(), streams.end(), record.stream) ==
+           streams.end())
+          streams.push_back(record.stream);
+        __sync_synchronize();
+        record.sequence = dequeuePosition + CAPACITY;
+        dequeuePosition++;
+      }
+
+      if(!streams.empty())
+      {
+        for(size_t i = 0; i < streams.size(); i++)
+          streams[i]->flush();
+        streams.clear();
+        __sync_synchronize();
+        written = dequeuePosition;
+        continue;
+      }
+
+      // Producers only take the lock if the writer is sleeping, the timeout
+      // prevents lost wake-ups
+      pthread_mutex_lock(&mutex);
+      sleeping = true;
+      __sync_synchronize();
+      if(ring[dequeuePosition % CAPACITY].sequence != dequeuePosition + 1)
+      {
+        timespec timeout;
+        clock_gettime(CLOCK_REALTIME, &timeout);
+        timeout.tv_nsec += 100000000;
+        if(timeout.tv_nsec >= 1000000000)
+        {
+          timeout.tv_sec++;
+          timeout.tv_nsec -= 1000000000;
+        }
+        pthread_cond_timedwait(&wakeUp, &mutex, &timeout);
+      }
+      sleeping = false;
+      pthread_mutex_unlock(&mutex);
+    }
+  }
+};
+
+/**
+ * Formatting the local time is expensive, hence each thread caches the
+ * timestamp of the current second.
+ */
+const char* currentTime()
+{
+  static __thread time_t cachedSecond = -1;
+  static __thread char cachedTime[32];
+  const time_t now = std::time(0);
+  if(now != cachedSecond)
+  {
+    struct tm current;
+    localtime_r(&now, &current);
+    std::strftime(cachedTime, sizeof(cachedTime), "%F %X", &current);
+    cachedSecond = now;
+  }
+  return cachedTime;
+}
+
+}
+
 const char* LevelToString[] =
 {
   "DISABLED",
@@ -43,7 +246,11 @@ Logger::Logger(Target target, std::string name)
 Logger::~Logger()
 {
   if(file.is_open())
+  {
+    // Pending messages refer to the file
+    Log::flush();
     file.close();
+  }
 }
 
 bool Logger::isActive()
@@ -51,21 +258,30 @@ bool Logger::isActive()
   return target != NONE && !deactivate;
 }
 
-Logger& operator<<(Logger& logger, const FloatingPointFormatter& t)
+void Logger::write(const std::string& text)
 {
-  switch(logger.target)
+  switch(target)
   {
-  case Logger::CONSOLE:
-    std::cout << std::fixed << std::setprecision(t.precision) << t.value
-              << std::resetiosflags(std::ios_base::fixed) << std::flush;
+  case CONSOLE:
+    Log::write(std::cout, text);
     break;
-  case Logger::APPEND_FILE:
-  case Logger::FILE:
-    logger.file << std::fixed << std::setprecision(t.precision) << t.value << std::flush;
+  case APPEND_FILE:
+  case FILE:
+    Log::write(file, text);
     break;
   default: // do not log
     break;
   }
+}
+
+Logger& operator<<(Logger& logger, const FloatingPointFormatter& t)
+{
+  if(logger.target != Logger::NONE)
+  {
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(t.precision) << t.value;
+    logger.write(text.str());
+  }
   return logger;
 }
 
@@ -78,24 +294,20 @@ Log::Log()
 
 Log::~Log()
 {
-  getStream() << message.str() << std::endl;
+  message << "\n";
+  write(getStream(), message.str());
+  if(level == ERROR)
+    flush();
 }
 
 std::ostream& Log::get(LogLevel level, const char* name_space)
 {
   OPENANN_CHECK(level != DISABLED);
 
-  time_t now;
-  std::time(&now);
-  struct tm* current = std::localtime(&now);
-  char current_time[32];
-
   this->level = level;
 
-  std::strftime(current_time, sizeof(current_time), "%F %X", current);
-
   message << std::setw(6) << LevelToString[level] << "  "
-          << current_time << "  ";
+          << currentTime() << "  ";
 
   if(name_space != NULL)
     message << name_space << ": ";
@@ -105,6 +317,9 @@ std::ostream& Log::get(LogLevel level, const char* name_space)
 
 void Log::setStream(std::ostream& stream)
 {
+  // Pending messages refer to the old stream that might be destroyed
+  // afterwards
+  flush();
   Log::stream = &stream;
 }
 
@@ -119,6 +334,21 @@ Log::LogLevel& Log::getLevel()
   return gLevel;
 }
 
+void Log::setAsynchronous(bool asynchronous)
+{
+  AsynchronousWriter::instance().setAsynchronous(asynchronous);
+}
+
+void Log::flush()
+{
+  AsynchronousWriter::instance().flush();
+}
+
+void Log::write(std::ostream& stream, const std::string& text)
+{
+  AsynchronousWriter::instance().write(stream, text);
+}
+
 void Log::setDisabled()
 {
   Log::getLevel() = Log::DISABLED;
@@ -7,6 +7,8 @@
 #include <OpenANN/util/AssertionMacros.h>
 #include <OpenANN/util/OpenANNException.h>
 #include <OpenANN/util/EigenWrapper.h>
+#include <OpenANN/util/Kernels.h>
+#include <OpenANN/util/Tracer.h>
 #include <OpenANN/io/Logger.h>
 #include <Test/Stopwatch.h>
 #include <numeric>
@@ -19,8 +21,9 @@ MBSGD::MBSGD(double learningRate, double momentum, int batchSize,
              double minimalLearningRate, double momentumGain,
              double maximalMomentum, double minGain, double maxGain)
   : opt(0), nesterov(nesterov), P(-1), N(-1), batches(-1),
-    accumulatedError(0.0), alpha(learningRate), alphaDecay(learningRateDecay),
-    minAlpha(minimalLearningRate), eta(momentum), etaGain(momentumGain),
+    accumulatedError(0.0), alpha0(learningRate), alpha(learningRate),
+    alphaDecay(learningRateDecay), minAlpha(minimalLearningRate),
+    eta0(momentum), eta(momentum), etaGain(momentumGain),
     maxEta(maximalMomentum), batchSize(batchSize), minGain(minGain),
     maxGain(maxGain), useGain(minGain != 1.0 || maxGain != 1.0),
     iteration(-1)
@@ -55,6 +58,14 @@ void MBSGD::setStopCriteria(const StoppingCriteria& stop)
   this->stop = stop;
 }
 
+Optimizer* MBSGD::clone()
+{
+  MBSGD* mbsgd = new MBSGD(alpha0, eta0, batchSize, nesterov, alphaDecay,
+                           minAlpha, etaGain, maxEta, minGain, maxGain);
+  mbsgd->setStopCriteria(stop);
+  return mbsgd;
+}
+
 void MBSGD::optimize()
 {
   OPENANN_CHECK(opt);
@@ -79,6 +90,7 @@ void MBSGD::optimize()
 
 bool MBSGD::step()
 {
+  OPENANN_TRACE_SPAN("MBSGD::step", "optimizer");
   OPENANN_CHECK(opt);
   if(iteration < 0)
     initialize();
@@ -86,6 +98,8 @@ bool MBSGD::step()
   OPENANN_CHECK(N > 0);
   OPENANN_CHECK(batches > 0);
 
+  Stopwatch stepTime;
+  opt->setMetrics(&metrics);
   accumulatedError = 0.0;
   rng.generateIndices<std::vector<int> >(N, randomIndices, true);
   std::vector<int>::const_iterator startN = randomIndices.begin();
@@ -95,6 +109,7 @@ bool MBSGD::step()
 
   for(int b = 0; b < batches; b++)
   {
+    Stopwatch batchTime;
     if(nesterov)
       opt->setParameters(parameters + eta * momentum);
 
@@ -102,6 +117,7 @@ bool MBSGD::step()
     opt->errorGradient(startN, endN, error, gradient);
     accumulatedError += error;
     OPENANN_CHECK_MATRIX_BROKEN(gradient);
+    const unsigned long gradientTime = batchTime.stop();
 
     if(useGain)
     {
@@ -116,9 +132,9 @@ bool MBSGD::step()
       }
     }
 
-    momentum = eta * momentum - alpha * gradient;
+    kernels().momentumUpdate(parameters.data(), momentum.data(),
+                             gradient.data(), eta, alpha, P);
     OPENANN_CHECK_MATRIX_BROKEN(momentum);
-    parameters += momentum;
     OPENANN_CHECK_MATRIX_BROKEN(parameters);
     if(!nesterov)
       opt->setParameters(parameters);
@@ -135,11 +151,21 @@ bool MBSGD::step()
     endN += batchSize;
     if(endN > randomIndices.end())
       endN = randomIndices.end();
+
+    const unsigned long duration = batchTime.stop();
+    metrics.increment("update_seconds_total",
+                      (duration - gradientTime) / 1e6);
+    metrics.observe("batch_seconds", duration / 1e6);
   }
 
   iteration++;
+  opt->setMetrics(0);
 
+  Stopwatch evaluationTime;
   opt->finishedIteration();
+  metrics.increment("evaluation_seconds_total", evaluationTime.stop() / 1e6);
+  metrics.finishedStep(stepTime.stop() / 1e6, N, accumulatedError /
+                       (double) batches, iteration, stop.maximalIterations);
 
   const bool run = (stop.maximalIterations == // Maximum iterations reached?
                     StoppingCriteria::defaultValue.maximalIterations ||
@@ -1,6 +1,8 @@
 #include <OpenANN/layers/MaxPooling.h>
 #include <OpenANN/util/AssertionMacros.h>
 #include <OpenANN/util/OpenANNException.h>
+#include <OpenANN/util/Tracer.h>
+#include <OpenANN/util/Threads.h>
 #include <limits>
 #include <algorithm>
 
@@ -58,24 +60,28 @@ void MaxPooling::forwardPropagate(Eigen::MatrixXd* x, Eigen::MatrixXd*& y,
   OPENANN_CHECK(x->cols() == fm * inRows * inCols);
   OPENANN_CHECK_EQUALS(this->y.cols(), fm * outRows * outCols);
 
-  #pragma omp parallel for
-  for(int n = 0; n < N; n++)
+  #pragma omp parallel num_threads(numThreads(N))
   {
-    int outputIdx = 0;
-    for(int fmo = 0; fmo < fm; fmo++)
+    OPENANN_TRACE_SPAN("MaxPooling::forwardPropagate", "parallel");
+    #pragma omp for
+    for(int n = 0; n < N; n++)
     {
-      for(int ri = 0, ro = 0; ri < maxRow; ri += kernelRows, ro++)
+      int outputIdx = 0;
+      for(int fmo = 0; fmo < fm; fmo++)
       {
-        int rowBase = fmo * fmInSize + ri * inCols;
-        for(int ci = 0; ci < maxCol; ci += kernelCols)
+        for(int ri = 0, ro = 0; ri < maxRow; ri += kernelRows, ro++)
         {
-          double m = -std::numeric_limits<double>::max();
-          for(int kr = 0; kr < kernelRows; kr++)
+          int rowBase = fmo * fmInSize + ri * inCols;
+          for(int ci = 0; ci < maxCol; ci += kernelCols)
           {
-            for(int kc = 0, inputIdx = rowBase + ci; kc < kernelCols; kc++)
-              m = std::max(m, (*x)(n, inputIdx++));
+            double m = -std::numeric_limits<double>::max();
+            for(int kr = 0; kr < kernelRows; kr++)
+            {
+              for(int kc = 0, inputIdx = rowBase + ci; kc < kernelCols; kc++)
+                m = std::max(m, (*x)(n, inputIdx++));
+            }
+            this->y(n, outputIdx++) = m;
           }
-          this->y(n, outputIdx++) = m;
         }
       }
     }
@@ -92,30 +98,34 @@ void MaxPooling::backpropagate(Eigen::MatrixXd* ein, Eigen::MatrixXd*& eout,
   e.setZero();
   Eigen::MatrixXd& deltas = *ein;
 
-  #pragma omp parallel for
-  for(int n = 0; n < N; n++)
+  #pragma omp parallel num_threads(numThreads(N))
   {
-    int outputIdx = 0;
-    for(int fmo = 0; fmo < fm; fmo++)
+    OPENANN_TRACE_SPAN("MaxPooling::backpropagate", "parallel");
+    #pragma omp for
+    for(int n = 0; n < N; n++)
     {
-      for(int ri = 0; ri < maxRow; ri += kernelRows)
+      int outputIdx = 0;
+      for(int fmo = 0; fmo < fm; fmo++)
       {
-        int rowBase = fmo * fmInSize + ri * inCols;
-        for(int ci = 0; ci < maxCol; ci += kernelCols, outputIdx++)
+        for(int ri = 0; ri < maxRow; ri += kernelRows)
         {
-          double m = -std::numeric_limits<double>::max();
-          int idx = -1;
-          for(int kr = 0; kr < kernelRows; kr++)
+          int rowBase = fmo * fmInSize + ri * inCols;
+          for(int ci = 0; ci < maxCol; ci += kernelCols, outputIdx++)
           {
-            for(int kc = 0, inputIdx = rowBase + ci; kc < kernelCols;
-                kc++, inputIdx++)
-              if((*x)(n, inputIdx) > m)
-              {
-                m = (*x)(n, inputIdx);
-                idx = inputIdx;
-              }
+            double m = -std::numeric_limits<double>::max();
+            int idx = -1;
+            for(int kr = 0; kr < kernelRows; kr++)
+            {
+              for(int kc = 0, inputIdx = rowBase + ci; kc < kernelCols;
+                  kc++, inputIdx++)
+                if((*x)(n, inputIdx) > m)
+                {
+                  m = (*x)(n, inputIdx);
+                  idx = inputIdx;
+                }
+            }
+            e(n, idx) = deltas(n, outputIdx);
           }
-          e(n, idx) = deltas(n, outputIdx);
         }
       }
     }
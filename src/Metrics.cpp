@@ -0,0 +1,184 @@
+#include <OpenANN/util/Metrics.h>
+#include <OpenANN/io/Logger.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace OpenANN
+{
+
+namespace
+{
+
+//! Upper bounds of the histogram buckets in seconds
+const double BUCKETS[] = {1e-4, 2.5e-4, 5e-4, 1e-3, 2.5e-3, 5e-3, 1e-2,
+                          2.5e-2, 5e-2, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0,
+                          25.0, 50.0, 100.0};
+const int NUM_BUCKETS = sizeof(BUCKETS) / sizeof(BUCKETS[0]);
+
+}
+
+Metrics::Metrics()
+  : interval(10.0), exported(false)
+{
+}
+
+void Metrics::increment(const std::string& name, double value)
+{
+  counters[name] += value;
+}
+
+void Metrics::set(const std::string& name, double value)
+{
+  gauges[name] = value;
+}
+
+void Metrics::observe(const std::string& name, double seconds)
+{
+  Histogram& histogram = histograms[name];
+  if(histogram.counts.empty())
+  {
+    histogram.counts.resize(NUM_BUCKETS + 1, 0);
+    histogram.count = 0;
+    histogram.sum = 0.0;
+  }
+  int b = 0;
+  while(b < NUM_BUCKETS && seconds > BUCKETS[b])
+    b++;
+  histogram.counts[b]++;
+  histogram.count++;
+  histogram.sum += seconds;
+}
+
+double Metrics::value(const std::string& name) const
+{
+  std::map<std::string, double>::const_iterator it = counters.find(name);
+  if(it != counters.end())
+    return it->second;
+  it = gauges.find(name);
+  if(it != gauges.end())
+    return it->second;
+  std::map<std::string, Histogram>::const_iterator h = histograms.find(name);
+  if(h != histograms.end())
+    return h->second.sum;
+  return 0.0;
+}
+
+unsigned long Metrics::count(const std::string& name) const
+{
+  std::map<std::string, Histogram>::const_iterator h = histograms.find(name);
+  return h == histograms.end() ? 0 : h->second.count;
+}
+
+double Metrics::quantile(const std::string& name, double q) const
+{
+  std::map<std::string, Histogram>::const_iterator h = histograms.find(name);
+  if(h == histograms.end() || h->second.count == 0)
+    return 0.0;
+  const Histogram& histogram = h->second;
+  const double rank = q * histogram.count;
+  unsigned long cumulative = 0;
+  for(int b = 0; b < NUM_BUCKETS; b++)
+  {
+    const unsigned long next = cumulative + histogram.counts[b];
+    if(next >= rank && histogram.counts[b] > 0)
+    {
+      const double lower = b == 0 ? 0.0 : BUCKETS[b-1];
+      return lower + (BUCKETS[b] - lower) * (rank - cumulative) /
+             histogram.counts[b];
+    }
+    cumulative = next;
+  }
+  // Observations in the +Inf bucket
+  return BUCKETS[NUM_BUCKETS-1];
+}
+
+void Metrics::reset()
+{
+  counters.clear();
+  gauges.clear();
+  histograms.clear();
+}
+
+std::string Metrics::exposition() const
+{
+  std::stringstream text;
+  text.precision(12);
+  for(std::map<std::string, double>::const_iterator it = counters.begin();
+      it != counters.end(); ++it)
+  {
+    text << "# TYPE openann_" << it->first << " counter\n"
+         << "openann_" << it->first << " " << it->second << "\n";
+  }
+  for(std::map<std::string, double>::const_iterator it = gauges.begin();
+      it != gauges.end(); ++it)
+  {
+    text << "# TYPE openann_" << it->first << " gauge\n"
+         << "openann_" << it->first << " " << it->second << "\n";
+  }
+  for(std::map<std::string, Histogram>::const_iterator it = histograms.begin();
+      it != histograms.end(); ++it)
+  {
+    const Histogram& histogram = it->second;
+    text << "# TYPE openann_" << it->first << " histogram\n";
+    unsigned long cumulative = 0;
+    for(int b = 0; b < NUM_BUCKETS; b++)
+    {
+      cumulative += histogram.counts[b];
+      text << "openann_" << it->first << "_bucket{le=\"" << BUCKETS[b]
+           << "\"} " << cumulative << "\n";
+    }
+    text << "openann_" << it->first << "_bucket{le=\"+Inf\"} "
+         << histogram.count << "\n"
+         << "openann_" << it->first << "_sum " << histogram.sum << "\n"
+         << "openann_" << it->first << "_count " << histogram.count << "\n";
+  }
+  return text.str();
+}
+
+void Metrics::exportPeriodically(const std::string& fileName, double interval)
+{
+  this->fileName = fileName;
+  this->interval = interval;
+  exported = false;
+}
+
+void Metrics::finishedStep(double seconds, int samples, double error,
+                           int iteration, int maximalIterations)
+{
+  increment("steps_total");
+  increment("samples_total", samples);
+  observe("step_seconds", seconds);
+  if(seconds > 0.0)
+    set("samples_per_second", samples / seconds);
+  set("error", error);
+  if(maximalIterations > 0)
+  {
+    const double meanStep = value("step_seconds") / count("step_seconds");
+    set("eta_seconds", std::max(0, maximalIterations - iteration) * meanStep);
+  }
+  exportIfDue();
+}
+
+void Metrics::exportIfDue()
+{
+  if(fileName.empty())
+    return;
+  if(exported && sinceExport.stop() < interval * 1e6)
+    return;
+  exported = true;
+  sinceExport.start();
+
+  // Readers must never see a partially written file
+  const std::string temporary = fileName + ".tmp";
+  std::ofstream file(temporary.c_str());
+  file << exposition();
+  file.close();
+  if(!file || std::rename(temporary.c_str(), fileName.c_str()) != 0)
+  {
+    OPENANN_ERROR << "Could not export metrics to '" << fileName << "'.";
+  }
+}
+
+} // namespace OpenANN
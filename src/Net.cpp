@@ -16,13 +16,84 @@
 #include <OpenANN/io/DirectStorageDataSet.h>
 #include <OpenANN/util/OpenANNException.h>
 #include <OpenANN/util/AssertionMacros.h>
+#include <OpenANN/util/Tracer.h>
+#include <Eigen/Cholesky>
 #include <fstream>
+#include <algorithm>
+#include <iomanip>
+#include <typeinfo>
+#include <ctime>
+#ifdef __GNUG__
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
 
 namespace OpenANN
 {
 
+namespace
+{
+
+//! Monotonic wall time in seconds.
+inline double wallTime()
+{
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (double) t.tv_sec + 1e-9 * (double) t.tv_nsec;
+}
+
+std::string layerName(const Layer& layer)
+{
+  std::string name = typeid(layer).name();
+#ifdef __GNUG__
+  int status = 0;
+  char* demangled = abi::__cxa_demangle(name.c_str(), 0, 0, &status);
+  if(status == 0 && demangled)
+    name = demangled;
+  std::free(demangled);
+#endif
+  const std::string ns = "OpenANN::";
+  if(name.compare(0, ns.size(), ns) == 0)
+    name = name.substr(ns.size());
+  return name;
+}
+
+//! Multiply-adds per instance, weights are shared across output positions.
+double multiplyAdds(const LayerProfile& profile, const OutputInfo& info)
+{
+  double positions = 1.0;
+  if(info.dimensions.size() == 3)
+    positions = (double) info.dimensions[1] * info.dimensions[2];
+  return (double) profile.parameters * positions;
+}
+
+}
+
+LayerProfile::LayerProfile()
+  : inputs(0), outputs(0), parameters(0)
+{
+  reset();
+}
+
+void LayerProfile::reset()
+{
+  forwardCalls = 0;
+  backwardCalls = 0;
+  forwardInstances = 0;
+  backwardInstances = 0;
+  forwardTime = 0.0;
+  backwardTime = 0.0;
+  forwardFlops = 0.0;
+  backwardFlops = 0.0;
+  bytes = 0.0;
+  allocations = 0;
+  allocatedBytes = 0.0;
+}
+
 Net::Net()
-  : errorFunction(MSE), dropout(false), initialized(false), P(-1), L(0)
+  : errorFunction(MSE), dropout(false), profiling(false), metrics(0),
+    initialized(false), storable(true),
+    P(-1), L(0)
 {
   layers.reserve(3);
   infos.reserve(3);
@@ -41,13 +112,13 @@ Net::~Net()
 Net& Net::inputLayer(int dim1, int dim2, int dim3)
 {
   architecture << "input " << dim1 << " " << dim2 << " " << dim3 << " ";
-  return addLayer(new Input(dim1, dim2, dim3));
+  return appendLayer(new Input(dim1, dim2, dim3));
 }
 
 Net& Net::alphaBetaFilterLayer(double deltaT, double stdDev)
 {
   architecture << "alpha_beta_filter " << deltaT << " " << stdDev << " ";
-  return addLayer(new AlphaBetaFilter(infos.back(), deltaT, stdDev));
+  return appendLayer(new AlphaBetaFilter(infos.back(), deltaT, stdDev));
 }
 
 Net& Net::fullyConnectedLayer(int units, ActivationFunction act, double stdDev,
@@ -55,17 +126,22 @@ Net& Net::fullyConnectedLayer(int units, ActivationFunction act, double stdDev,
 {
   architecture << "fully_connected " << units << " " << (int) act << " "
       << stdDev << " " << bias << " ";
-  return addLayer(new FullyConnected(infos.back(), units, bias, act, stdDev,
-                                     regularization));
+  return appendLayer(new FullyConnected(infos.back(), units, bias, act, stdDev,
+                                        regularization));
 }
 
 Net& Net::restrictedBoltzmannMachineLayer(int H, int cdN, double stdDev,
-                                          bool backprop)
+                                          bool backprop, int persistentChains)
 {
-  architecture << "rbm " << H << " " << cdN << " " << stdDev << " "
-      << backprop << " ";
-  return addLayer(new RBM(infos.back().outputs(), H, cdN, stdDev,
-                          backprop, regularization));
+  // Plain CD-n RBMs are stored in the old format
+  if(persistentChains > 0)
+    architecture << "pcd_rbm " << H << " " << cdN << " " << stdDev << " "
+        << backprop << " " << persistentChains << " ";
+  else
+    architecture << "rbm " << H << " " << cdN << " " << stdDev << " "
+        << backprop << " ";
+  return appendLayer(new RBM(infos.back().outputs(), H, cdN, stdDev,
+                             backprop, regularization, persistentChains));
 }
 
 Net& Net::sparseAutoEncoderLayer(int H, double beta, double rho,
@@ -73,8 +149,9 @@ Net& Net::sparseAutoEncoderLayer(int H, double beta, double rho,
 {
   architecture << "sae " << H << " " << beta << " " << rho << " " << (int) act
       << " ";
-  return addLayer(new SparseAutoEncoder(infos.back().outputs(), H, beta, rho,
-                                        regularization.l2Penalty, act));
+  return appendLayer(new SparseAutoEncoder(infos.back().outputs(), H, beta,
+                                           rho, regularization.l2Penalty,
+                                           act));
 }
 
 Net& Net::compressedLayer(int units, int params, ActivationFunction act,
@@ -83,8 +160,8 @@ Net& Net::compressedLayer(int units, int params, ActivationFunction act,
 {
   architecture << "compressed " << units << " " << params << " " << (int) act
       << " " << compression << " " << stdDev << " " << bias << " ";
-  return addLayer(new Compressed(infos.back(), units, params, bias, act,
-                                 compression, stdDev, regularization));
+  return appendLayer(new Compressed(infos.back(), units, params, bias, act,
+                                    compression, stdDev, regularization));
 }
 
 Net& Net::extremeLayer(int units, ActivationFunction act, double stdDev,
@@ -92,14 +169,14 @@ Net& Net::extremeLayer(int units, ActivationFunction act, double stdDev,
 {
   architecture << "extreme " << units << " " << (int) act << " " << stdDev
       << " " << bias << " ";
-  return addLayer(new Extreme(infos.back(), units, bias, act, stdDev));
+  return appendLayer(new Extreme(infos.back(), units, bias, act, stdDev));
 }
 
 Net& Net::intrinsicPlasticityLayer(double targetMean, double stdDev)
 {
   architecture << "intrinsic_plasticity " << targetMean << " " << stdDev << " ";
-  return addLayer(new IntrinsicPlasticity(infos.back().outputs(), targetMean,
-                                          stdDev));
+  return appendLayer(new IntrinsicPlasticity(infos.back().outputs(),
+                                             targetMean, stdDev));
 }
 
 Net& Net::convolutionalLayer(int featureMaps, int kernelRows, int kernelCols,
@@ -107,8 +184,9 @@ Net& Net::convolutionalLayer(int featureMaps, int kernelRows, int kernelCols,
 {
   architecture << "convolutional " << featureMaps << " " << kernelRows << " "
       << kernelCols << " " << (int) act << " " << stdDev << " " << bias << " ";
-  return addLayer(new Convolutional(infos.back(), featureMaps, kernelRows,
-                                    kernelCols, bias, act, stdDev, regularization));
+  return appendLayer(new Convolutional(infos.back(), featureMaps, kernelRows,
+                                       kernelCols, bias, act, stdDev,
+                                       regularization));
 }
 
 Net& Net::subsamplingLayer(int kernelRows, int kernelCols,
@@ -116,14 +194,14 @@ Net& Net::subsamplingLayer(int kernelRows, int kernelCols,
 {
   architecture << "subsampling " << kernelRows << " " << kernelCols << " "
       << (int) act << " " << stdDev << " " << bias << " ";
-  return addLayer(new Subsampling(infos.back(), kernelRows, kernelCols, bias,
-                                  act, stdDev, regularization));
+  return appendLayer(new Subsampling(infos.back(), kernelRows, kernelCols,
+                                     bias, act, stdDev, regularization));
 }
 
 Net& Net::maxPoolingLayer(int kernelRows, int kernelCols)
 {
   architecture << "max_pooling " << kernelRows << " " << kernelCols << " ";
-  return addLayer(new MaxPooling(infos.back(), kernelRows, kernelCols));
+  return appendLayer(new MaxPooling(infos.back(), kernelRows, kernelCols));
 }
 
 Net& Net::localReponseNormalizationLayer(double k, int n, double alpha,
@@ -131,25 +209,24 @@ Net& Net::localReponseNormalizationLayer(double k, int n, double alpha,
 {
   architecture << "local_response_normalization " << k << " " << n << " "
       << alpha << " " << beta << " ";
-  return addLayer(new LocalResponseNormalization(infos.back(), k, n, alpha,
-                                                 beta));
+  return appendLayer(new LocalResponseNormalization(infos.back(), k, n, alpha,
+                                                    beta));
 }
 
-Net& Net::dropoutLayer(double dropoutProbability)
+Net& Net::dropoutLayer(double dropoutProbability, bool inverted)
 {
-  architecture << "dropout " << dropoutProbability << " ";
-  return addLayer(new Dropout(infos.back(), dropoutProbability));
+  // Networks with the token "dropout" have been trained without inverted
+  // dropout and must be scaled after training
+  architecture << (inverted ? "inverted_dropout " : "dropout ")
+      << dropoutProbability << " ";
+  return appendLayer(new Dropout(infos.back(), dropoutProbability, inverted));
 }
 
 Net& Net::addLayer(Layer* layer)
 {
-  OPENANN_CHECK(layer != 0);
-
-  OutputInfo info = layer->initialize(parameters, derivatives);
-  layers.push_back(layer);
-  infos.push_back(info);
-  L++;
-  return *this;
+  // The architecture of arbitrary layers cannot be saved
+  storable = false;
+  return appendLayer(layer);
 }
 
 Net& Net::addOutputLayer(Layer* layer)
@@ -159,13 +236,32 @@ Net& Net::addOutputLayer(Layer* layer)
   return *this;
 }
 
+Net& Net::appendLayer(Layer* layer)
+{
+  OPENANN_CHECK(layer != 0);
+
+  const int previousParameters = parameters.size();
+  OutputInfo info = layer->initialize(parameters, derivatives);
+  LayerProfile profile;
+  profile.name = layerName(*layer);
+  profile.outputs = info.outputs();
+  profile.inputs = infos.empty() ? profile.outputs : infos.back().outputs();
+  profile.parameters = parameters.size() - previousParameters;
+  layers.push_back(layer);
+  infos.push_back(info);
+  profiles.push_back(profile);
+  spanNames.push_back(Tracer::intern(profile.name));
+  L++;
+  return *this;
+}
+
 
 Net& Net::outputLayer(int units, ActivationFunction act, double stdDev, bool bias)
 {
   architecture << "output " << units << " " << (int) act << " " << stdDev
       << " " << bias << " ";
-  addLayer(new FullyConnected(infos.back(), units, bias, act, stdDev,
-                              regularization));
+  appendLayer(new FullyConnected(infos.back(), units, bias, act, stdDev,
+                                 regularization));
   initializeNetwork();
   return *this;
 }
@@ -176,8 +272,8 @@ Net& Net::compressedOutputLayer(int units, int params, ActivationFunction act,
 {
   architecture << "compressed_output " << units << " " << params << " "
       << (int) act << " " << compression << " " << stdDev << " " << bias << " ";
-  addLayer(new Compressed(infos.back(), units, params, bias, act, compression,
-                          stdDev, regularization));
+  appendLayer(new Compressed(infos.back(), units, params, bias, act,
+                             compression, stdDev, regularization));
   initializeNetwork();
   return *this;
 }
@@ -228,6 +324,25 @@ void Net::save(const std::string& fileName)
   file.close();
 }
 
+bool Net::isStorable()
+{
+  return storable;
+}
+
+bool Net::isReplicable()
+{
+  if(!storable)
+    return false;
+  for(int l = 0; l < L; l++)
+  {
+    if(dynamic_cast<Compressed*>(layers[l]) ||
+       dynamic_cast<Extreme*>(layers[l]) ||
+       dynamic_cast<AlphaBetaFilter*>(layers[l]))
+      return false;
+  }
+  return true;
+}
+
 void Net::save(std::ostream& stream)
 {
   stream << architecture.str() << "parameters " << currentParameters();
@@ -284,6 +399,19 @@ void Net::load(std::istream& stream)
           << backprop;
       restrictedBoltzmannMachineLayer(H, cdN, stdDev, backprop);
     }
+    else if(type == "pcd_rbm")
+    {
+      int H;
+      int cdN;
+      double stdDev;
+      bool backprop;
+      int persistentChains;
+      stream >> H >> cdN >> stdDev >> backprop >> persistentChains;
+      OPENANN_DEBUG << "pcd_rbm " << H << " " << cdN << " " << stdDev << " "
+          << backprop << " " << persistentChains;
+      restrictedBoltzmannMachineLayer(H, cdN, stdDev, backprop,
+                                      persistentChains);
+    }
     else if(type == "sae")
     {
       int H;
@@ -364,12 +492,12 @@ void Net::load(std::istream& stream)
           << alpha << " " << beta;
       localReponseNormalizationLayer(k, n, alpha, beta);
     }
-    else if(type == "dropout")
+    else if(type == "inverted_dropout" || type == "dropout")
     {
       double dropoutProbability;
       stream >> dropoutProbability;
-      OPENANN_DEBUG << "dropout " << dropoutProbability;
-      dropoutLayer(dropoutProbability);
+      OPENANN_DEBUG << type << " " << dropoutProbability;
+      dropoutLayer(dropoutProbability, type == "inverted_dropout");
     }
     else if(type == "output")
     {
@@ -449,6 +577,68 @@ Net& Net::setErrorFunction(ErrorFunction errorFunction)
   return *this;
 }
 
+Net& Net::fitOutputLayer(int blockSize)
+{
+  OPENANN_CHECK(initialized);
+  if(!trainSet)
+    throw OpenANNException("Net::fitOutputLayer: no training set available");
+  FullyConnected* outputLayer = dynamic_cast<FullyConnected*>(layers.back());
+  if(!outputLayer)
+    throw OpenANNException("Net::fitOutputLayer: output layer must be a "
+                           "fully connected layer");
+
+  const int N = trainSet->samples();
+  const int I = infos[L-2].outputs();
+  const int J = infos.back().outputs();
+  const int outputParameters = outputLayer->getParameters().rows();
+  const bool bias = outputParameters == J * (I + 1);
+  const int K = I + bias;
+
+  // Accumulate H^T H and H^T T, the last column of H is the bias
+  Eigen::MatrixXd HtH = Eigen::MatrixXd::Zero(K, K);
+  Eigen::MatrixXd HtT = Eigen::MatrixXd::Zero(K, J);
+  Eigen::MatrixXd H, T;
+  for(int n = 0; n < N; n += blockSize)
+  {
+    const int rows = std::min(blockSize, N - n);
+    tempInput.conservativeResize(rows, trainSet->inputs());
+    T.conservativeResize(rows, J);
+    for(int i = 0; i < rows; i++)
+    {
+      tempInput.row(i) = trainSet->getInstance(n + i);
+      T.row(i) = trainSet->getTarget(n + i);
+    }
+    Eigen::MatrixXd* y = &tempInput;
+    for(int l = 0; l < L-1; l++)
+      layers[l]->forwardPropagate(y, y, false);
+    H.conservativeResize(rows, K);
+    H.leftCols(I) = *y;
+    if(bias)
+      H.col(I).setOnes();
+    HtH.noalias() += H.transpose() * H;
+    HtT.noalias() += H.transpose() * T;
+  }
+
+  // The bias will not be penalized
+  HtH.diagonal().head(I).array() += regularization.l2Penalty;
+  Eigen::MatrixXd B;
+  Eigen::LLT<Eigen::MatrixXd> llt(HtH);
+  if(llt.info() == Eigen::Success)
+    B = llt.solve(HtT);
+  else
+    B = HtH.ldlt().solve(HtT);
+
+  // The parameters of the output layer are stored at the end, row by row
+  // with an optional bias at the end of each row
+  Eigen::VectorXd newParameters = parameterVector;
+  int p = P - outputParameters;
+  for(int j = 0; j < J; j++)
+    for(int k = 0; k < K; k++)
+      newParameters(p++) = B(k, j);
+  setParameters(newParameters);
+  return *this;
+}
+
 void Net::finishedIteration()
 {
   bool dropout = this->dropout;
@@ -460,6 +650,123 @@ void Net::finishedIteration()
   this->dropout = dropout;
 }
 
+Net& Net::useProfiling(bool activate)
+{
+  profiling = activate;
+  return *this;
+}
+
+Net& Net::resetProfile()
+{
+  for(int l = 0; l < L; l++)
+    profiles[l].reset();
+  return *this;
+}
+
+const std::vector<LayerProfile>& Net::getProfile()
+{
+  return profiles;
+}
+
+std::string Net::profileReport(bool json)
+{
+  double totalTime = 0.0;
+  for(int l = 0; l < L; l++)
+    totalTime += profiles[l].forwardTime + profiles[l].backwardTime;
+
+  std::stringstream report;
+  if(json)
+  {
+    report << "{\"total_time\": " << totalTime << ", \"layers\": [";
+    for(int l = 0; l < L; l++)
+    {
+      const LayerProfile& p = profiles[l];
+      report << (l > 0 ? ", " : "") << "{\"layer\": " << l
+          << ", \"type\": \"" << p.name << "\""
+          << ", \"inputs\": " << p.inputs
+          << ", \"outputs\": " << p.outputs
+          << ", \"parameters\": " << p.parameters
+          << ", \"forward_calls\": " << p.forwardCalls
+          << ", \"forward_instances\": " << p.forwardInstances
+          << ", \"forward_time\": " << p.forwardTime
+          << ", \"forward_flops\": " << p.forwardFlops
+          << ", \"backward_calls\": " << p.backwardCalls
+          << ", \"backward_instances\": " << p.backwardInstances
+          << ", \"backward_time\": " << p.backwardTime
+          << ", \"backward_flops\": " << p.backwardFlops
+          << ", \"bytes\": " << p.bytes
+          << ", \"allocations\": " << p.allocations
+          << ", \"allocated_bytes\": " << p.allocatedBytes << "}";
+    }
+    report << "]}";
+    return report.str();
+  }
+
+  report << std::left << std::setw(4) << "#" << std::setw(28) << "type"
+      << std::right << std::setw(10) << "fw calls" << std::setw(11) << "fw ms"
+      << std::setw(10) << "bw calls" << std::setw(11) << "bw ms"
+      << std::setw(10) << "batch" << std::setw(10) << "GFLOP/s"
+      << std::setw(10) << "GB/s" << std::setw(8) << "%";
+  if(AllocationTracker::available())
+    report << std::setw(10) << "allocs";
+  report << "\n";
+  report << std::fixed;
+  for(int l = 0; l < L; l++)
+  {
+    const LayerProfile& p = profiles[l];
+    const double time = p.forwardTime + p.backwardTime;
+    const unsigned long calls = p.forwardCalls + p.backwardCalls;
+    const double batch = calls > 0 ?
+        (double) (p.forwardInstances + p.backwardInstances) / calls : 0.0;
+    const double gflops = time > 0.0 ?
+        1e-9 * (p.forwardFlops + p.backwardFlops) / time : 0.0;
+    const double gbytes = time > 0.0 ? 1e-9 * p.bytes / time : 0.0;
+    const double share = totalTime > 0.0 ? 100.0 * time / totalTime : 0.0;
+    report << std::left << std::setw(4) << l << std::setw(28)
+        << p.name.substr(0, 27) << std::right
+        << std::setw(10) << p.forwardCalls << std::setprecision(3)
+        << std::setw(11) << 1e3 * p.forwardTime
+        << std::setw(10) << p.backwardCalls
+        << std::setw(11) << 1e3 * p.backwardTime << std::setprecision(1)
+        << std::setw(10) << batch << std::setprecision(3)
+        << std::setw(10) << gflops << std::setw(10) << gbytes
+        << std::setprecision(1) << std::setw(8) << share;
+    if(AllocationTracker::available())
+      report << std::setw(10) << p.allocations;
+    report << "\n";
+  }
+  report << std::setprecision(3) << "total " << 1e3 * totalTime << " ms\n";
+  return report.str();
+}
+
+void Net::predict(const Eigen::VectorXd& x, Eigen::VectorXd& y)
+{
+  OPENANN_CHECK_EQUALS(x.rows(), infos[0].outputs());
+  tempInput.resize(1, x.rows());
+  tempInput.row(0) = x.transpose();
+  Eigen::MatrixXd* out = &tempInput;
+  for(int l = 0; l < L; l++)
+    layers[l]->forwardPropagate(out, out, false, 0);
+  y = out->row(0).transpose();
+  if(errorFunction == CE)
+  {
+    y.array() = (y.array() - y.maxCoeff()).exp();
+    y /= y.sum();
+  }
+}
+
+void Net::predict(const Eigen::MatrixXd& X, Eigen::MatrixXd& Y)
+{
+  OPENANN_CHECK_EQUALS(X.cols(), infos[0].outputs());
+  tempInput = X;
+  Eigen::MatrixXd* out = &tempInput;
+  for(int l = 0; l < L; l++)
+    layers[l]->forwardPropagate(out, out, false, 0);
+  Y = *out;
+  if(errorFunction == CE)
+    OpenANN::softmax(Y);
+}
+
 Eigen::VectorXd Net::operator()(const Eigen::VectorXd& x)
 {
   tempInput = x.transpose();
@@ -579,15 +886,21 @@ void Net::errorGradient(std::vector<int>::const_iterator startN,
                         std::vector<int>::const_iterator endN,
                         double& value, Eigen::VectorXd& grad)
 {
+  OPENANN_TRACE_SPAN("Net::errorGradient", "net");
+  const double begin = metrics ? wallTime() : 0.0;
   const int N = endN - startN;
   tempInput.conservativeResize(N, trainSet->inputs());
   Eigen::MatrixXd T(N, trainSet->outputs());
-  int n = 0;
-  for(std::vector<int>::const_iterator it = startN; it != endN; ++it, ++n)
   {
-    tempInput.row(n) = trainSet->getInstance(*it);
-    T.row(n) = trainSet->getTarget(*it);
+    OPENANN_TRACE_SPAN("Net::gather", "data");
+    int n = 0;
+    for(std::vector<int>::const_iterator it = startN; it != endN; ++it, ++n)
+    {
+      tempInput.row(n) = trainSet->getInstance(*it);
+      T.row(n) = trainSet->getTarget(*it);
+    }
   }
+  const double gathered = metrics ? wallTime() : 0.0;
 
   value = 0;
   forwardPropagate(&value);
@@ -599,6 +912,17 @@ void Net::errorGradient(std::vector<int>::const_iterator startN,
   for(int p = 0; p < P; p++)
     grad(p) = *derivatives[p];
   grad /= N;
+
+  if(metrics)
+  {
+    metrics->increment("gather_seconds_total", gathered - begin);
+    metrics->increment("compute_seconds_total", wallTime() - gathered);
+  }
+}
+
+void Net::setMetrics(Metrics* metrics)
+{
+  this->metrics = metrics;
 }
 
 void Net::initializeNetwork()
@@ -617,9 +941,26 @@ void Net::initializeNetwork()
 void Net::forwardPropagate(double* error)
 {
   Eigen::MatrixXd* y = &tempInput;
-  for(std::vector<Layer*>::iterator layer = layers.begin();
-      layer != layers.end(); ++layer)
-    (**layer).forwardPropagate(y, y, dropout, error);
+  if(profiling)
+  {
+    for(int l = 0; l < L; l++)
+    {
+      OPENANN_TRACE_SPAN(spanNames[l], "forward");
+      const int N = y->rows();
+      const AllocationTracker tracker;
+      const double begin = wallTime();
+      layers[l]->forwardPropagate(y, y, dropout, error);
+      recordForward(l, N, wallTime() - begin, tracker);
+    }
+  }
+  else
+  {
+    for(int l = 0; l < L; l++)
+    {
+      OPENANN_TRACE_SPAN(spanNames[l], "forward");
+      layers[l]->forwardPropagate(y, y, dropout, error);
+    }
+  }
   tempOutput = *y;
   OPENANN_CHECK_EQUALS(y->cols(), infos.back().outputs());
   if(errorFunction == CE)
@@ -635,8 +976,51 @@ void Net::backpropagate()
   {
     // Backprop of dE/dX is not required in input layer and first hidden layer
     const bool backpropToPrevious = l > 2;
-    (**layer).backpropagate(e, e, backpropToPrevious);
+    OPENANN_TRACE_SPAN(spanNames[l - 1], "backward");
+    if(profiling)
+    {
+      // The errors of the first layers might not be computed
+      const int N = tempError.rows();
+      const AllocationTracker tracker;
+      const double begin = wallTime();
+      (**layer).backpropagate(e, e, backpropToPrevious);
+      recordBackward(l - 1, N, wallTime() - begin, tracker);
+    }
+    else
+      (**layer).backpropagate(e, e, backpropToPrevious);
   }
 }
 
+void Net::recordForward(int l, int N, double time,
+                        const AllocationTracker& tracker)
+{
+  LayerProfile& profile = profiles[l];
+  profile.forwardCalls++;
+  profile.forwardInstances += N;
+  profile.forwardTime += time;
+  profile.forwardFlops += N * (2.0 * multiplyAdds(profile, infos[l]) +
+                               profile.outputs);
+  profile.bytes += sizeof(double) * ((double) N * (profile.inputs +
+                                     profile.outputs) + profile.parameters);
+  profile.allocations += tracker.allocations();
+  profile.allocatedBytes += tracker.bytes();
+}
+
+void Net::recordBackward(int l, int N, double time,
+                         const AllocationTracker& tracker)
+{
+  // Derivatives with respect to the weights and the inputs
+  LayerProfile& profile = profiles[l];
+  profile.backwardCalls++;
+  profile.backwardInstances += N;
+  profile.backwardTime += time;
+  profile.backwardFlops += N * (4.0 * multiplyAdds(profile, infos[l]) +
+                                profile.outputs);
+  profile.bytes += sizeof(double) * ((double) N * (profile.inputs +
+                                     2.0 * profile.outputs) +
+                                     2.0 * profile.parameters);
+  profile.allocations += tracker.allocations();
+  profile.allocatedBytes += tracker.bytes();
+}
+
 }
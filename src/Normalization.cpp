@@ -1,48 +1,114 @@
 #include <OpenANN/Normalization.h>
 #include <OpenANN/util/AssertionMacros.h>
+#include <OpenANN/util/Threads.h>
+#include <OpenANN/util/BinaryIO.h>
+#include <algorithm>
+#include <vector>
 
 namespace OpenANN
 {
 
 Normalization::Normalization()
+  : samples(0)
 {
 }
 
 Transformer& Normalization::fit(const Eigen::MatrixXd& X)
 {
-  mean = X.colwise().mean();
+  samples = 0;
+  return fitPartial(X);
+}
 
-  // Unfortunately there does not seem to be a function for the standard
-  // deviation in Eigen
-  std.resize(mean.rows(), mean.cols());
-  std.setZero();
-  for(int n = 0; n < X.rows(); ++n)
+Transformer& Normalization::fitPartial(const Eigen::MatrixXd& X)
+{
+  OPENANN_CHECK(samples == 0 || X.cols() == mean.cols());
+  const int N = X.rows();
+  if(N == 0)
+    return *this;
+  if(samples == 0)
+  {
+    mean.setZero(1, X.cols());
+    sumOfSquares.setZero(1, X.cols());
+  }
+
+  // Each thread computes the statistics of a contiguous chunk, the chunks
+  // are merged in a fixed order
+  const int threads = numThreads(N / 1024);
+  std::vector<Eigen::MatrixXd> chunkMeans(threads), chunkSumsOfSquares(threads);
+  #pragma omp parallel for schedule(static, 1) num_threads(threads)
+  for(int t = 0; t < threads; t++)
+  {
+    const int first = (long) N * t / threads;
+    const int rows = (long) N * (t + 1) / threads - first;
+    chunkMeans[t] = X.middleRows(first, rows).colwise().mean();
+    chunkSumsOfSquares[t] = (X.middleRows(first, rows).rowwise() -
+                             chunkMeans[t].row(0)).colwise().squaredNorm();
+  }
+  for(int t = 0; t < threads; t++)
   {
-    for(int d = 0; d < X.cols(); ++d)
-    {
-      register double tmp = X(n, d) - mean(d);
-      std(0, d) += tmp*tmp;
-    }
+    const int first = (long) N * t / threads;
+    const int rows = (long) N * (t + 1) / threads - first;
+    merge(rows, chunkMeans[t], chunkSumsOfSquares[t]);
   }
-  std /= X.rows();
-  std.array() = std.array().sqrt();
 
+  std.array() = (sumOfSquares / (double) samples).array().sqrt();
   // To avoid division by zero, we do not modify the corresponding features
-  for(int d = 0; d < X.cols(); ++d)
+  for(int d = 0; d < std.cols(); ++d)
     if(std(0, d) == 0.0)
       std(0, d) = 1.0;
   return *this;
 }
 
 Eigen::MatrixXd Normalization::transform(const Eigen::MatrixXd& X)
+{
+  Eigen::MatrixXd normalized = X;
+  transformInPlace(normalized);
+  return normalized;
+}
+
+void Normalization::transformInPlace(Eigen::MatrixXd& X)
 {
   OPENANN_CHECK(mean.cols() > 0);
   OPENANN_CHECK_EQUALS(X.cols(), mean.cols());
-  Eigen::MatrixXd normalized(X.rows(), X.cols());
-  for(int n = 0; n < X.rows(); ++n)
-    normalized.row(n).array() = (X.row(n).array() - mean.array()) *
-        std.array().inverse();
-  return normalized;
+  // Features are stored contiguously
+  const int D = X.cols();
+  #pragma omp parallel for num_threads(numThreads())
+  for(int d = 0; d < D; ++d)
+    X.col(d).array() = (X.col(d).array() - mean(0, d)) * (1.0 / std(0, d));
+}
+
+bool Normalization::affine(Eigen::MatrixXd& W, Eigen::VectorXd& b)
+{
+  OPENANN_CHECK(mean.cols() > 0);
+  W.setZero(mean.cols(), mean.cols());
+  W.diagonal() = std.array().inverse().matrix().transpose();
+  b = -(mean.array() / std.array()).matrix().transpose();
+  return true;
+}
+
+bool Normalization::save(std::ostream& stream)
+{
+  writeBinary(stream, samples);
+  writeBinary(stream, mean);
+  writeBinary(stream, sumOfSquares);
+  writeBinary(stream, std);
+  return (bool) stream;
+}
+
+bool Normalization::load(std::istream& stream)
+{
+  int samples = -1;
+  Eigen::MatrixXd mean, sumOfSquares, std;
+  if(!readBinary(stream, samples) || !readBinary(stream, mean) ||
+     !readBinary(stream, sumOfSquares) || !readBinary(stream, std) ||
+     samples < 0 || sumOfSquares.cols() != mean.cols() ||
+     std.cols() != mean.cols())
+    return false;
+  this->samples = samples;
+  this->mean = mean;
+  this->sumOfSquares = sumOfSquares;
+  this->std = std;
+  return true;
 }
 
 Eigen::VectorXd Normalization::getMean()
@@ -55,4 +121,17 @@ Eigen::VectorXd Normalization::getStd()
   return std.transpose();
 }
 
+void Normalization::merge(int samples, const Eigen::MatrixXd& mean,
+                          const Eigen::MatrixXd& sumOfSquares)
+{
+  if(samples == 0)
+    return;
+  const double total = (double) this->samples + (double) samples;
+  Eigen::MatrixXd delta = mean - this->mean;
+  this->sumOfSquares += sumOfSquares + delta.cwiseAbs2() *
+      ((double) this->samples * (double) samples / total);
+  this->mean += delta * ((double) samples / total);
+  this->samples += samples;
+}
+
 } // namespace OpenANN
@@ -0,0 +1,120 @@
+#include <OpenANN/util/OnlineCovariance.h>
+#include <OpenANN/util/AssertionMacros.h>
+#include <OpenANN/util/Threads.h>
+#include <OpenANN/util/BinaryIO.h>
+#include <algorithm>
+#include <vector>
+
+namespace OpenANN
+{
+
+OnlineCovariance::OnlineCovariance()
+  : n(0)
+{
+}
+
+OnlineCovariance& OnlineCovariance::reset()
+{
+  n = 0;
+  mean.resize(0);
+  scatter.resize(0, 0);
+  return *this;
+}
+
+OnlineCovariance& OnlineCovariance::add(const Eigen::MatrixXd& X)
+{
+  OPENANN_CHECK(n == 0 || X.cols() == mean.rows());
+  // Each thread accumulates a contiguous range of blocks, the partial
+  // results are merged in a fixed order
+  const int blockSize = 1024;
+  const int N = X.rows();
+  const int blocks = (N + blockSize - 1) / blockSize;
+  const int threads = numThreads(blocks);
+  std::vector<OnlineCovariance> partial(threads);
+  #pragma omp parallel for schedule(static, 1) num_threads(threads)
+  for(int t = 0; t < threads; t++)
+  {
+    const int first = (long) blocks * t / threads;
+    const int last = (long) blocks * (t + 1) / threads;
+    for(int b = first; b < last; b++)
+    {
+      const int start = b * blockSize;
+      partial[t].addBlock(X.middleRows(start, std::min(blockSize, N - start)));
+    }
+  }
+  for(int t = 0; t < threads; t++)
+    merge(partial[t]);
+  return *this;
+}
+
+OnlineCovariance& OnlineCovariance::merge(const OnlineCovariance& other)
+{
+  if(other.n == 0)
+    return *this;
+  if(n == 0)
+  {
+    *this = other;
+    return *this;
+  }
+  OPENANN_CHECK_EQUALS(mean.rows(), other.mean.rows());
+
+  const double total = (double) n + (double) other.n;
+  Eigen::VectorXd delta = other.mean - mean;
+  scatter += other.scatter;
+  scatter.selfadjointView<Eigen::Lower>().rankUpdate(
+      delta, (double) n * (double) other.n / total);
+  mean += delta * ((double) other.n / total);
+  n += other.n;
+  return *this;
+}
+
+int OnlineCovariance::samples() const
+{
+  return n;
+}
+
+const Eigen::VectorXd& OnlineCovariance::getMean() const
+{
+  return mean;
+}
+
+Eigen::MatrixXd OnlineCovariance::getCovariance(bool unbiased) const
+{
+  OPENANN_CHECK(n > (unbiased ? 1 : 0));
+  Eigen::MatrixXd C = scatter;
+  C.triangularView<Eigen::StrictlyUpper>() = C.transpose();
+  return C / (double) (unbiased ? n - 1 : n);
+}
+
+void OnlineCovariance::save(std::ostream& stream) const
+{
+  writeBinary(stream, n);
+  writeBinary(stream, mean);
+  writeBinary(stream, scatter);
+}
+
+bool OnlineCovariance::load(std::istream& stream)
+{
+  OnlineCovariance loaded;
+  if(!readBinary(stream, loaded.n) || !readBinary(stream, loaded.mean) ||
+     !readBinary(stream, loaded.scatter) || loaded.n < 0 ||
+     loaded.scatter.rows() != loaded.mean.rows() ||
+     loaded.scatter.cols() != loaded.mean.rows())
+    return false;
+  *this = loaded;
+  return true;
+}
+
+void OnlineCovariance::addBlock(const Eigen::MatrixXd& X)
+{
+  OnlineCovariance block;
+  block.n = X.rows();
+  block.mean = X.colwise().mean();
+  Eigen::MatrixXd aligned = X;
+  aligned.rowwise() -= block.mean.transpose();
+  block.scatter.setZero(X.cols(), X.cols());
+  block.scatter.selfadjointView<Eigen::Lower>().rankUpdate(aligned.transpose());
+  merge(block);
+}
+
+} // namespace OpenANN
@@ -1,49 +1,229 @@
 #include <OpenANN/PCA.h>
 #include <OpenANN/util/AssertionMacros.h>
+#include <OpenANN/util/Random.h>
+#include <OpenANN/util/BinaryIO.h>
 #include <Eigen/SVD>
+#include <Eigen/Eigenvalues>
+#include <Eigen/QR>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace OpenANN
 {
 
-PCA::PCA(int components, bool whiten)
-  : components(components), whiten(whiten)
+//! Number of additional random directions of the randomized SVD.
+const int RANDOMIZED_OVERSAMPLING = 10;
+//! Number of power iterations of the randomized SVD.
+const int RANDOMIZED_POWER_ITERATIONS = 2;
+//! Number of instances that will be centered at once.
+const int BLOCK_SIZE = 1024;
+
+PCA::PCA(int components, bool whiten, Solver solver)
+  : components(components), whiten(whiten), solver(solver), outdated(false)
 {
 }
 
 Transformer& PCA::fit(const Eigen::MatrixXd& X)
 {
   const int N = X.rows();
+  const int D = X.cols();
+  OPENANN_CHECK_WITHIN(components, 1, D);
+  statistics.reset();
+  outdated = false;
+
+  const Solver selected = selectSolver(N, D);
+  if(selected == COVARIANCE)
+    return fitPartial(X);
+
   mean = X.colwise().mean();
-  Eigen::MatrixXd aligned = X;
-  aligned.rowwise() -= mean.transpose();
+  // Variances of the principal components, i.e. squared singular values of
+  // the centered data divided by N
+  Eigen::VectorXd S;
+  if(selected == RANDOMIZED)
+    fitRandomized(X, S);
+  else
+    fitSVD(X, S);
 
-  Eigen::JacobiSVD<Eigen::MatrixXd> svd(aligned, Eigen::ComputeFullV);
-  Eigen::VectorXd S = svd.singularValues() / std::sqrt((double) N);
-  W = svd.matrixV();
-  if(whiten)
-    for(int d = 0; d < X.cols(); ++d)
-      W.col(d).array() /= S.array();
+  // The total variance is the trace of the covariance matrix
+  double totalVariance = 0.0;
+  for(int n = 0; n < N; n += BLOCK_SIZE)
+  {
+    const int rows = std::min(BLOCK_SIZE, N - n);
+    totalVariance += (X.middleRows(n, rows).rowwise() -
+                      mean.transpose()).squaredNorm();
+  }
+  finish(S, totalVariance / (double) N);
 
-  evr.resize(S.rows());
-  evr.array() = S.array().square();
-  evr /= evr.sum();
-  evr.conservativeResize(components);
+  return *this;
+}
 
+Transformer& PCA::fitPartial(const Eigen::MatrixXd& X)
+{
+  OPENANN_CHECK_WITHIN(components, 1, X.cols());
+  statistics.add(X);
+  outdated = true;
   return *this;
 }
 
 Eigen::MatrixXd PCA::transform(const Eigen::MatrixXd& X)
 {
+  update();
   OPENANN_CHECK(mean.rows() > 0);
   OPENANN_CHECK_EQUALS(X.cols(), mean.rows());
   Eigen::MatrixXd Y = X;
   Y.rowwise() -= mean.transpose();
-  return Y * W.topRows(components).transpose();
+  return Y * W;
+}
+
+bool PCA::affine(Eigen::MatrixXd& W, Eigen::VectorXd& b)
+{
+  update();
+  OPENANN_CHECK(mean.rows() > 0);
+  W = this->W;
+  b = -this->W.transpose() * mean;
+  return true;
+}
+
+bool PCA::save(std::ostream& stream)
+{
+  update();
+  writeBinary(stream, components);
+  writeBinary(stream, whiten);
+  statistics.save(stream);
+  writeBinary(stream, mean);
+  writeBinary(stream, W);
+  writeBinary(stream, evr);
+  return (bool) stream;
+}
+
+bool PCA::load(std::istream& stream)
+{
+  int components = -1;
+  bool whiten = false;
+  OnlineCovariance statistics;
+  Eigen::VectorXd mean, evr;
+  Eigen::MatrixXd W;
+  if(!readBinary(stream, components) || !readBinary(stream, whiten) ||
+     !statistics.load(stream) || !readBinary(stream, mean) ||
+     !readBinary(stream, W) || !readBinary(stream, evr) ||
+     components != this->components || whiten != this->whiten ||
+     W.rows() != mean.rows() || W.cols() != components ||
+     evr.rows() != components)
+    return false;
+  this->statistics = statistics;
+  this->mean = mean;
+  this->W = W;
+  this->evr = evr;
+  outdated = false;
+  return true;
 }
 
 Eigen::VectorXd PCA::explainedVarianceRatio()
 {
+  update();
   return evr;
 }
 
+PCA::Solver PCA::selectSolver(int N, int D)
+{
+  if(solver != AUTO)
+    return solver;
+  // Each pass of the randomized SVD multiplies the data with a D x l or
+  // N x l matrix, the covariance matrix requires one multiplication with a
+  // N x D matrix
+  const int l = components + RANDOMIZED_OVERSAMPLING;
+  if(2 * (RANDOMIZED_POWER_ITERATIONS + 1) * l < std::min(N, D))
+    return RANDOMIZED;
+  else if(N >= D)
+    return COVARIANCE;
+  else
+    return SVD;
+}
+
+void PCA::fitSVD(const Eigen::MatrixXd& X, Eigen::VectorXd& S)
+{
+  const int N = X.rows();
+  OPENANN_CHECK(components <= N);
+  Eigen::MatrixXd aligned = X;
+  aligned.rowwise() -= mean.transpose();
+
+  Eigen::JacobiSVD<Eigen::MatrixXd> svd(aligned, Eigen::ComputeThinV);
+  S = svd.singularValues().array().square() / (double) N;
+  W = svd.matrixV().leftCols(components);
+}
+
+void PCA::fitRandomized(const Eigen::MatrixXd& X, Eigen::VectorXd& S)
+{
+  const int N = X.rows();
+  const int D = X.cols();
+  const int l = std::min(components + RANDOMIZED_OVERSAMPLING,
+                         std::min(N, D));
+
+  // The data will be centered implicitly: (X - 1 m^T) B = X B - 1 (m^T B)
+  RandomNumberGenerator rng;
+  Eigen::MatrixXd Omega(D, l);
+  rng.fillNormalDistribution(Omega);
+  Eigen::MatrixXd Y = X * Omega;
+  Y.rowwise() -= mean.transpose() * Omega;
+  Eigen::MatrixXd Q = Eigen::HouseholderQR<Eigen::MatrixXd>(Y).householderQ() *
+      Eigen::MatrixXd::Identity(N, l);
+
+  // Power iterations improve the approximation for slowly decaying spectra
+  Eigen::MatrixXd Z;
+  for(int i = 0; i < RANDOMIZED_POWER_ITERATIONS; i++)
+  {
+    Z = X.transpose() * Q;
+    Z -= mean * Q.colwise().sum();
+    Z = Eigen::HouseholderQR<Eigen::MatrixXd>(Z).householderQ() *
+        Eigen::MatrixXd::Identity(D, l);
+    Y = X * Z;
+    Y.rowwise() -= mean.transpose() * Z;
+    Q = Eigen::HouseholderQR<Eigen::MatrixXd>(Y).householderQ() *
+        Eigen::MatrixXd::Identity(N, l);
+  }
+
+  // Project the data onto the approximated range and decompose the small
+  // l x D matrix
+  Eigen::MatrixXd B = Q.transpose() * X;
+  B -= Q.colwise().sum().transpose() * mean.transpose();
+  Eigen::JacobiSVD<Eigen::MatrixXd> svd(B, Eigen::ComputeThinV);
+  S = svd.singularValues().array().square() / (double) N;
+  W = svd.matrixV().leftCols(components);
+}
+
+void PCA::update()
+{
+  if(!outdated)
+    return;
+  outdated = false;
+
+  mean = statistics.getMean();
+  Eigen::MatrixXd C = statistics.getCovariance(false);
+  // Eigenvalues are sorted in increasing order
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(C);
+  Eigen::VectorXd S = eig.eigenvalues().reverse();
+  S = (S.array() < 0.0).select(0.0, S);
+  W = eig.eigenvectors().rightCols(components).rowwise().reverse();
+  finish(S, C.trace());
+}
+
+void PCA::finish(const Eigen::VectorXd& S, double totalVariance)
+{
+  // Constant features have no variance, we must not divide by zero
+  if(totalVariance > 0.0)
+    evr = S.head(components) / totalVariance;
+  else
+    evr.setZero(components);
+  if(whiten)
+  {
+    // Components without variance (up to rounding errors) will not be scaled
+    const double minVariance = std::numeric_limits<double>::epsilon() *
+                               totalVariance;
+    for(int c = 0; c < components; ++c)
+      if(S(c) > minVariance)
+        W.col(c) /= std::sqrt(S(c));
+  }
+}
+
 } // namespace OpenANN
@@ -1,6 +1,9 @@
 #include <OpenANN/Preprocessing.h>
+#include <OpenANN/util/AssertionMacros.h>
 #include <OpenANN/util/OpenANNException.h>
 #include <OpenANN/util/Random.h>
+#include <OpenANN/util/Threads.h>
+#include <algorithm>
 #include <vector>
 
 namespace OpenANN
@@ -18,44 +21,105 @@ void scaleData(Eigen::MatrixXd& data, double min, double max)
   data = data.array() * scaling + (min - minData * scaling);
 }
 
-void filter(const Eigen::MatrixXd& x, Eigen::MatrixXd& y, const Eigen::MatrixXd& b, const Eigen::MatrixXd& a)
+/**
+ * Index of a sample of a signal whose beginning is mirrored.
+ */
+static inline int mirror(int t)
 {
-  y.setZero();
+  return t < 0 ? -t : t;
+}
+
+/**
+ * FIR filter that only computes every downSamplingFactor-th output.
+ */
+static void firFilter(const Eigen::MatrixXd& x, Eigen::MatrixXd& d,
+                      const Eigen::VectorXd& b, int downSamplingFactor)
+{
+  const int J = d.cols();
+  const int K = b.rows();
+  // Columns contain the samples of all channels at one point in time
+  #pragma omp parallel for num_threads(numThreads())
+  for(int j = 0; j < J; j++)
+  {
+    const int t = j * downSamplingFactor;
+    d.col(j) = b(0) * x.col(t);
+    for(int k = 1; k < K; k++)
+      d.col(j) += b(k) * x.col(mirror(t - k));
+  }
+}
 
-  for(int c = 0; c < x.rows(); c++)
+/**
+ * IIR filter in transposed direct form II that stores every
+ * downSamplingFactor-th output.
+ */
+static void iirFilter(const Eigen::MatrixXd& x, Eigen::MatrixXd& d,
+                      const Eigen::VectorXd& b, const Eigen::VectorXd& a,
+                      int downSamplingFactor)
+{
+  const int C = x.rows();
+  const int T = std::min<int>(x.cols(), d.cols() * downSamplingFactor);
+  const int P = b.rows() - 1;
+  const int threads = numThreads(C);
+  // The recursion is sequential in time, hence we split the channels
+  #pragma omp parallel for schedule(static, 1) num_threads(threads)
+  for(int thread = 0; thread < threads; thread++)
   {
-    for(int t = 0; t < x.cols(); t++)
+    const int first = C * thread / threads;
+    const int rows = C * (thread + 1) / threads - first;
+    Eigen::MatrixXd z = Eigen::MatrixXd::Zero(rows, P);
+    Eigen::VectorXd xt(rows), yt(rows);
+    // The mirrored beginning of the signal initializes the state
+    for(int t = -P; t < T; t++)
     {
-      const int maxPQ = std::max(b.rows(), a.rows());
-      for(int pq = 0; pq < maxPQ; pq++)
-      {
-        const double tSource = t - pq;
-        if(pq < b.rows())
-        {
-          if(tSource >= 0)
-            y(c, t) += b(pq) * x(c, tSource);
-          else
-            y(c, t) += b(pq) * x(c, -tSource);
-        }
-        if(pq > 0 && pq < a.rows())
-        {
-          if(tSource >= 0)
-            y(c, t) += a(pq) * x(c, tSource);
-          else
-            y(c, t) += a(pq) * x(c, -tSource);
-        }
-      }
-      y(c, t) /= a(0);
+      xt = x.block(first, mirror(t), rows, 1);
+      yt = b(0) * xt + z.col(0);
+      for(int k = 1; k < P; k++)
+        z.col(k-1) = b(k) * xt - a(k) * yt + z.col(k);
+      z.col(P-1) = b(P) * xt - a(P) * yt;
+      if(t >= 0 && t % downSamplingFactor == 0)
+        d.block(first, t / downSamplingFactor, rows, 1) = yt;
     }
   }
 }
 
+void filter(const Eigen::MatrixXd& x, Eigen::MatrixXd& y, const Eigen::MatrixXd& b, const Eigen::MatrixXd& a)
+{
+  y.resize(x.rows(), x.cols());
+  filterAndDownsample(x, y, b, a, 1);
+}
+
 void downsample(const Eigen::MatrixXd& y, Eigen::MatrixXd& d, int downSamplingFactor)
 {
-  for(int c = 0; c < y.rows(); c++)
-    for(int target = 0, source = 0; target < d.cols();
-        target++, source += downSamplingFactor)
-      d(c, target) = y(c, source);
+  OPENANN_CHECK_EQUALS(y.rows(), d.rows());
+  for(int target = 0, source = 0; target < d.cols();
+      target++, source += downSamplingFactor)
+    d.col(target) = y.col(source);
+}
+
+void filterAndDownsample(const Eigen::MatrixXd& x, Eigen::MatrixXd& d,
+                         const Eigen::MatrixXd& b, const Eigen::MatrixXd& a,
+                         int downSamplingFactor)
+{
+  OPENANN_CHECK(downSamplingFactor > 0);
+  OPENANN_CHECK_EQUALS(x.rows(), d.rows());
+  OPENANN_CHECK(d.cols() == 0 ||
+                (d.cols() - 1) * downSamplingFactor < x.cols());
+  OPENANN_CHECK(a.size() > 0 && a(0) != 0.0);
+
+  // Normalize coefficients so that a(0) = 1
+  const int P = std::max(b.size(), a.size()) - 1;
+  OPENANN_CHECK(P < x.cols());
+  Eigen::VectorXd bn = Eigen::VectorXd::Zero(P + 1);
+  Eigen::VectorXd an = Eigen::VectorXd::Zero(P + 1);
+  for(int k = 0; k < b.size(); k++)
+    bn(k) = b(k) / a(0);
+  for(int k = 0; k < a.size(); k++)
+    an(k) = a(k) / a(0);
+
+  if(P == 0 || an.tail(P).isZero(0.0))
+    firFilter(x, d, bn, downSamplingFactor);
+  else
+    iirFilter(x, d, bn, an, downSamplingFactor);
 }
 
 Eigen::MatrixXd sampleRandomPatches(const Eigen::MatrixXd& images,
@@ -75,7 +139,7 @@ Eigen::MatrixXd sampleRandomPatches(const Eigen::MatrixXd& images,
       rng.generateInt(0, rows - patchRows + 1),
       rng.generateInt(0, cols - patchCols + 1)));
 
-#pragma omp parallel for
+#pragma omp parallel for num_threads(numThreads())
   for(int m = 0; m < images.rows(); ++m)
   {
     for(int n = 0; n < samples; ++n)
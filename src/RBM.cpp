@@ -4,13 +4,15 @@
 #include <OpenANN/util/OpenANNException.h>
 #include <OpenANN/util/Random.h>
 #include <OpenANN/io/Logger.h>
+#include <algorithm>
 
 namespace OpenANN
 {
 
 RBM::RBM(int D, int H, int cdN, double stdDev, bool backprop,
-         Regularization regularization)
-  : rng(new RandomNumberGenerator), D(D), H(H), cdN(cdN), stdDev(stdDev),
+         Regularization regularization, int persistentChains)
+  : rng(new RandomNumberGenerator), D(D), H(H), cdN(cdN),
+    persistentChains(persistentChains), stdDev(stdDev),
     W(H, D), posGradW(H, D), negGradW(H, D), Wd(H, D),
     bv(D), posGradBv(D), negGradBv(D),
     bh(H), posGradBh(H), negGradBh(H), bhd(H),
@@ -50,6 +52,7 @@ void RBM::initialize()
   rng->fillNormalDistribution(W, stdDev);
   bv.setZero();
   bh.setZero();
+  fantasy.resize(0, D);
   pack(params, 3, W.size(), W.data(), bv.size(), bv.data(), bh.size(),
        bh.data());
   setParameters(params);
@@ -97,10 +100,23 @@ bool RBM::providesGradient()
 
 Eigen::VectorXd RBM::gradient()
 {
-  Eigen::VectorXd grad(K);
+  // Contrastive divergence is computed for blocks of instances at once so
+  // that the expensive parts are matrix products
+  const int N = trainSet->samples();
+  const int blockSize = 256;
+  std::vector<int> indices(N);
+  for(int n = 0; n < N; n++)
+    indices[n] = n;
+  Eigen::VectorXd grad(K), blockGrad(K);
   grad.setZero();
-  for(int n = 0; n < trainSet->samples(); n++)
-    grad += gradient(n);
+  double value = 0.0;
+  for(int n = 0; n < N; n += blockSize)
+  {
+    const int end = std::min(n + blockSize, N);
+    errorGradient(indices.begin() + n, indices.begin() + end, value,
+                  blockGrad);
+    grad += blockGrad;
+  }
   return grad;
 }
 
@@ -123,13 +139,26 @@ void RBM::errorGradient(std::vector<int>::const_iterator startN,
   for(std::vector<int>::const_iterator it = startN; it != endN; ++it, ++n)
     v.row(n) = trainSet->getInstance(*it);
   reality();
+  if(persistentChains > 0)
+  {
+    // The negative phase does not start at the data, so we compute the
+    // error of a mean-field reconstruction before the fantasy particles
+    // replace the mini-batch
+    pv = ph * W;
+    pv.rowwise() += bv.transpose();
+    activationFunction(LOGISTIC, pv, pv);
+    value = (pv - v).squaredNorm();
+  }
   daydream();
   fillGradient();
   grad = this->grad;
-  n = 0;
-  value = 0.0;
-  for(std::vector<int>::const_iterator it = startN; it != endN; ++it, ++n)
-    value += (trainSet->getInstance(*it) - pv.row(n).transpose()).squaredNorm();
+  if(persistentChains == 0)
+  {
+    n = 0;
+    value = 0.0;
+    for(std::vector<int>::const_iterator it = startN; it != endN; ++it, ++n)
+      value += (trainSet->getInstance(*it) - pv.row(n).transpose()).squaredNorm();
+  }
 }
 
 OutputInfo RBM::initialize(std::vector<double*>& parameterPointers,
@@ -204,6 +233,11 @@ int RBM::hiddenUnits()
   return H;
 }
 
+int RBM::persistentGibbsChains()
+{
+  return persistentChains;
+}
+
 const Eigen::MatrixXd& RBM::getWeights()
 {
   return W;
@@ -237,21 +271,28 @@ void RBM::sampleHgivenV()
   h.conservativeResize(N, Eigen::NoChange);
   ph = v * W.transpose();
   ph.rowwise() += bh.transpose();
-  activationFunction(LOGISTIC, ph, ph);
-  for(int n = 0; n < N; n++)
-    for(int j = 0; j < H; j++)
-      h(n, j) = (double)(ph(n, j) > rng->generate<double>(0.0, 1.0));
+  sample(ph, h);
 }
 
 void RBM::sampleVgivenH()
 {
   const int N = h.rows();
+  v.conservativeResize(N, Eigen::NoChange);
   pv = h * W;
   pv.rowwise() += bv.transpose();
-  activationFunction(LOGISTIC, pv, pv);
-  for(int n = 0; n < N; n++)
-    for(int i = 0; i < D; i++)
-      v(n, i) = (double)(pv(n, i) > rng->generate<double>(0.0, 1.0));
+  sample(pv, v);
+}
+
+void RBM::sample(Eigen::MatrixXd& p, Eigen::MatrixXd& s)
+{
+  const int N = p.rows();
+  const int M = p.cols();
+  u.conservativeResize(N, M);
+  rng->fillUniformDistribution(u);
+
+  // Logistic activation and Bernoulli sampling of the instances
+  activationFunction(LOGISTIC, p, p);
+  s = (p.array() > u.array()).cast<double>();
 }
 
 void RBM::reality()
@@ -265,6 +306,20 @@ void RBM::reality()
 
 void RBM::daydream()
 {
+  const int N = v.rows();
+  if(persistentChains > 0)
+  {
+    // Initialize the fantasy particles with the first mini-batch
+    if(fantasy.rows() != persistentChains)
+    {
+      fantasy.resize(persistentChains, D);
+      for(int c = 0; c < persistentChains; c++)
+        fantasy.row(c) = v.row(c % N);
+    }
+    v = fantasy;
+    sampleHgivenV();
+  }
+
   for(int n = 0; n < cdN; n++)
   {
     sampleVgivenH();
@@ -274,32 +329,29 @@ void RBM::daydream()
   negGradW = ph.transpose() * pv;
   negGradBv = pv.colwise().sum().transpose();
   negGradBh = ph.colwise().sum().transpose();
+
+  if(persistentChains > 0)
+  {
+    fantasy = v;
+    // The positive phase is a sum over the mini-batch
+    const double scale = (double) N / (double) persistentChains;
+    negGradW *= scale;
+    negGradBv *= scale;
+    negGradBh *= scale;
+  }
 }
 
 void RBM::fillGradient()
 {
-  int idx = 0;
-  for(int i = 0; i < D; i++)
-    for(int j = 0; j < H; j++)
-      grad(idx++) = -posGradW(j, i) + negGradW(j, i);
-  for(int i = 0; i < D; i++)
-    grad(idx++) = -posGradBv(i) + negGradBv(i);
-  for(int j = 0; j < H; j++)
-    grad(idx++) = -posGradBh(j) + negGradBh(j);
+  // The weights are stored column-major in the parameter vector
+  Eigen::Map<Eigen::MatrixXd> gradW(grad.data(), H, D);
+  gradW = negGradW - posGradW;
+  grad.segment(D * H, D) = negGradBv - posGradBv;
+  grad.tail(H) = negGradBh - posGradBh;
   if(regularization.l1Penalty > 0.0)
-  {
-    idx = 0;
-    for(int i = 0; i < D; i++)
-      for(int j = 0; j < H; j++)
-        grad(idx++) -= regularization.l1Penalty * W(j, i) / std::abs(W(j, i));
-  }
+    gradW.array() -= regularization.l1Penalty * W.array() / W.array().abs();
   if(regularization.l2Penalty > 0.0)
-  {
-    idx = 0;
-    for(int i = 0; i < D; i++)
-      for(int j = 0; j < H; j++)
-        grad(idx++) -= regularization.l2Penalty * W(j, i);
-  }
+    gradW -= regularization.l2Penalty * W;
 }
 
 }
@@ -1,15 +1,66 @@
 #include <OpenANN/util/Random.h>
+#include <OpenANN/util/Threads.h>
 #include <ctime>
 
 namespace OpenANN
 {
 
+namespace
+{
+
+// Seed of the generator and the next unused counter of the shared stream
+uint32_t key = 0;
+uint64_t counter = 0;
+// Stream of the current thread, 0 selects the shared stream
+__thread RandomStream* currentStream = 0;
+
+const uint32_t SHARED_STREAM = 0xCA01F9DD;
+
+//! Distinct ids are mapped to distinct keys that differ from the shared one
+inline uint32_t streamKey(uint32_t id)
+{
+  return SHARED_STREAM ^ ((id + 1) * 0x9E3779B9);
+}
+
+/**
+ * Philox4x32-10 block: maps a 64 bit counter to 128 random bits.
+ */
+inline void philox(uint32_t seed, uint32_t stream, uint64_t n,
+                   uint32_t out[4])
+{
+  uint32_t c0 = (uint32_t) n, c1 = (uint32_t) (n >> 32), c2 = 0, c3 = 0;
+  uint32_t k0 = seed, k1 = stream;
+  for(int r = 0; r < 10; r++)
+  {
+    const uint64_t p0 = (uint64_t) 0xD2511F53 * c0;
+    const uint64_t p1 = (uint64_t) 0xCD9E8D57 * c2;
+    c0 = (uint32_t) (p1 >> 32) ^ c1 ^ k0;
+    c1 = (uint32_t) p1;
+    c2 = (uint32_t) (p0 >> 32) ^ c3 ^ k1;
+    c3 = (uint32_t) p0;
+    k0 += 0x9E3779B9;
+    k1 += 0xBB67AE85;
+  }
+  out[0] = c0;
+  out[1] = c1;
+  out[2] = c2;
+  out[3] = c3;
+}
+
+//! Uniform number from [0, 1) with 53 random bits.
+inline double toUniform(uint32_t hi, uint32_t lo)
+{
+  return (double) ((((uint64_t) hi << 32) | lo) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+}
+
 RandomNumberGenerator::RandomNumberGenerator()
 {
   static bool seedInitialized = false;
   if(!seedInitialized)
   {
-    srand(std::time(0));
+    seed(std::time(0));
     seedInitialized = true;
   }
 }
@@ -17,6 +68,8 @@ RandomNumberGenerator::RandomNumberGenerator()
 void RandomNumberGenerator::seed(unsigned int seed)
 {
   srand(seed);
+  key = seed;
+  counter = 0;
 }
 
 int RandomNumberGenerator::generateInt(int min, int range) const
@@ -24,8 +77,9 @@ int RandomNumberGenerator::generateInt(int min, int range) const
   OPENANN_CHECK(range >= 0);
   if(range == 0)
     return min;
-  else
-    return rand() % range + min;
+  Key key;
+  const uint64_t n = reserve(1, key);
+  return (int) indexAt(key, n, range) + min;
 }
 
 size_t RandomNumberGenerator::generateIndex(size_t size) const
@@ -33,4 +87,142 @@ size_t RandomNumberGenerator::generateIndex(size_t size) const
   return (size_t) generateInt(0, size);
 }
 
+double RandomNumberGenerator::uniform() const
+{
+  Key key;
+  const uint64_t n = reserve(1, key);
+  uint32_t bits[4];
+  philox(key.seed, key.stream, n, bits);
+  return toUniform(bits[0], bits[1]);
+}
+
+double RandomNumberGenerator::normal() const
+{
+  Key key;
+  const uint64_t n = reserve(1, key);
+  uint32_t bits[4];
+  philox(key.seed, key.stream, n, bits);
+  const double u1 = 1.0 - toUniform(bits[0], bits[1]);
+  const double u2 = toUniform(bits[2], bits[3]);
+  return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * M_PI * u2);
+}
+
+uint64_t RandomNumberGenerator::reserve(uint64_t n, Key& k)
+{
+  RandomStream* stream = currentStream;
+  if(stream)
+  {
+    k.seed = stream->seed;
+    k.stream = streamKey(stream->id);
+    const uint64_t first = stream->counter;
+    stream->counter += n;
+    return first;
+  }
+  k.seed = key;
+  k.stream = SHARED_STREAM;
+  return __sync_fetch_and_add(&counter, n);
+}
+
+size_t RandomNumberGenerator::indexAt(const Key& key, uint64_t n, size_t size)
+{
+  uint32_t bits[4];
+  philox(key.seed, key.stream, n, bits);
+  const uint64_t r = ((uint64_t) bits[0] << 32) | bits[1];
+  return (size_t) (r % size);
+}
+
+void RandomNumberGenerator::fillUniform(double* data, int n, double min,
+                                        double range)
+{
+  // Each block of random bits is used for two entries
+  const int blocks = (n + 1) / 2;
+  Key key;
+  const uint64_t first = reserve(blocks, key);
+  #pragma omp parallel for if(blocks > 1024) num_threads(numThreads())
+  for(int b = 0; b < blocks; b++)
+  {
+    uint32_t bits[4];
+    philox(key.seed, key.stream, first + b, bits);
+    data[2*b] = toUniform(bits[0], bits[1]) * range + min;
+    if(2*b + 1 < n)
+      data[2*b+1] = toUniform(bits[2], bits[3]) * range + min;
+  }
+}
+
+void RandomNumberGenerator::fillNormal(double* data, int n, double stdDev)
+{
+  // Box-Muller transform generates two independent samples at once
+  const int blocks = (n + 1) / 2;
+  Key key;
+  const uint64_t first = reserve(blocks, key);
+  #pragma omp parallel for if(blocks > 1024) num_threads(numThreads())
+  for(int b = 0; b < blocks; b++)
+  {
+    uint32_t bits[4];
+    philox(key.seed, key.stream, first + b, bits);
+    const double r = stdDev *
+        std::sqrt(-2.0 * std::log(1.0 - toUniform(bits[0], bits[1])));
+    const double phi = 2.0 * M_PI * toUniform(bits[2], bits[3]);
+    data[2*b] = r * std::cos(phi);
+    if(2*b + 1 < n)
+      data[2*b+1] = r * std::sin(phi);
+  }
+}
+
+void RandomNumberGenerator::fillBernoulliMask(std::vector<uint32_t>& mask,
+                                              int n, double p)
+{
+  const uint64_t threshold = (uint64_t) (std::max(0.0, std::min(1.0, p)) *
+                                         4294967296.0);
+  const int words = (n + 31) / 32;
+  mask.resize(words);
+  // Each word requires 8 blocks of random bits
+  Key key;
+  const uint64_t first = reserve(8 * (uint64_t) words, key);
+  #pragma omp parallel for if(words > 256) num_threads(numThreads())
+  for(int w = 0; w < words; w++)
+  {
+    uint32_t word = 0;
+    uint32_t bits[4];
+    for(int b = 0; b < 8; b++)
+    {
+      philox(key.seed, key.stream, first + 8 * (uint64_t) w + b,
+             bits);
+      for(int i = 0; i < 4; i++)
+        word |= (uint32_t) ((uint64_t) bits[i] < threshold) << (4*b + i);
+    }
+    mask[w] = word;
+  }
+}
+
+void RandomNumberGenerator::fillBernoulli(double* data, int n, double p)
+{
+  // A 32 bit threshold is sufficient, each block is used for four entries
+  const uint64_t threshold = (uint64_t) (std::max(0.0, std::min(1.0, p)) *
+                                         4294967296.0);
+  const int blocks = (n + 3) / 4;
+  Key key;
+  const uint64_t first = reserve(blocks, key);
+  #pragma omp parallel for if(blocks > 1024) num_threads(numThreads())
+  for(int b = 0; b < blocks; b++)
+  {
+    uint32_t bits[4];
+    philox(key.seed, key.stream, first + b, bits);
+    const int end = std::min(4, n - 4*b);
+    for(int i = 0; i < end; i++)
+      data[4*b+i] = (double) ((uint64_t) bits[i] < threshold);
+  }
+}
+
+RandomStream::RandomStream(unsigned int id)
+  : seed(key), id(id), counter(0), previous(currentStream)
+{
+  currentStream = this;
+}
+
+RandomStream::~RandomStream()
+{
+  currentStream = previous;
+}
+
 }
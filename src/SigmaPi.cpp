@@ -1,6 +1,8 @@
 #include <OpenANN/layers/SigmaPi.h>
 #include <OpenANN/util/Random.h>
 #include <OpenANN/util/OpenANNException.h>
+#include <OpenANN/util/Tracer.h>
+#include <OpenANN/util/Threads.h>
 
 namespace OpenANN
 {
@@ -72,28 +74,32 @@ void SigmaPi::forwardPropagate(Eigen::MatrixXd* x, Eigen::MatrixXd*& y,
   this->y.conservativeResize(N, Eigen::NoChange);
   this->x.leftCols(info.outputs()) = *x;
 
-  #pragma omp parallel for
-  for(int instance = 0; instance < N; instance++)
+  #pragma omp parallel num_threads(numThreads(N))
   {
-    int i = 0;
-    for(HigherOrderNeuron* n = &nodes.front(); n <= &nodes.back(); ++n)
+    OPENANN_TRACE_SPAN("SigmaPi::forwardPropagate", "parallel");
+    #pragma omp for
+    for(int instance = 0; instance < N; instance++)
     {
-      double sum = 0.0;
-
-      for(HigherOrderUnit* u = &n->front(); u <= &n->back(); ++u)
+      int i = 0;
+      for(HigherOrderNeuron* n = &nodes.front(); n <= &nodes.back(); ++n)
       {
+        double sum = 0.0;
 
-        double korrelation = 1.0;
-
-        for(int k = 0; k < u->position.size(); ++k)
+        for(HigherOrderUnit* u = &n->front(); u <= &n->back(); ++u)
         {
-          korrelation *= (*x)(instance, u->position.at(k));
+
+          double korrelation = 1.0;
+
+          for(int k = 0; k < u->position.size(); ++k)
+          {
+            korrelation *= (*x)(instance, u->position.at(k));
+          }
+
+          sum = sum + w[u->weight] * korrelation;
         }
 
-        sum = sum + w[u->weight] * korrelation;
+        a(instance, i++) = sum;
       }
-
-      a(instance, i++) = sum;
     }
   }
 
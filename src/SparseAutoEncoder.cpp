@@ -10,7 +10,8 @@ namespace OpenANN
 SparseAutoEncoder::SparseAutoEncoder(int D, int H, double beta, double rho,
                                      double lambda, ActivationFunction act)
   : D(D), H(H), beta(beta), rho(rho), lambda(lambda), act(act), W1(H, D),
-    W2(D, H), W1d(H, D), W2d(D, H), b1(H), b2(D), b1d(H), b2d(D)
+    W2(D, H), W1d(H, D), W2d(D, H), b1(H), b2(D), b1d(H), b2d(D),
+    batchEvaluated(false)
 {
   parameters.resize(dimension());
   grad.resize(dimension());
@@ -25,7 +26,7 @@ Eigen::VectorXd SparseAutoEncoder::operator()(const Eigen::VectorXd& x)
 
 Eigen::MatrixXd SparseAutoEncoder::operator()(const Eigen::MatrixXd& X)
 {
-  A1 = X * W1.transpose();
+  A1.noalias() = X * W1.transpose();
   A1.rowwise() += b1.transpose();
   Z1.conservativeResize(A1.rows(), A1.cols());
   activationFunction(act, A1, Z1);
@@ -40,6 +41,7 @@ bool SparseAutoEncoder::providesInitialization()
 void SparseAutoEncoder::initialize()
 {
   initializeParameters();
+  runningMeanActivation.resize(0);
   pack(parameters, 4, W1.size(), W1.data(), W2.size(), W2.data(),
        b1.size(), b1.data(), b2.size(), b2.data());
 }
@@ -51,6 +53,11 @@ unsigned int SparseAutoEncoder::dimension()
 
 void SparseAutoEncoder::setParameters(const Eigen::VectorXd& parameters)
 {
+  // The running mean activation belongs to the previous parameters unless
+  // they have been updated after a mini-batch
+  if(!batchEvaluated)
+    runningMeanActivation.resize(0);
+  batchEvaluated = false;
   this->parameters = parameters;
   unpack(parameters, 4, W1.size(), W1.data(), W2.size(), W2.data(),
          b1.size(), b1.data(), b2.size(), b2.data());
@@ -61,25 +68,25 @@ const Eigen::VectorXd& SparseAutoEncoder::currentParameters()
   return parameters;
 }
 
+unsigned int SparseAutoEncoder::examples()
+{
+  return X.rows();
+}
+
 double SparseAutoEncoder::error()
 {
   const int N = X.rows();
-  (*this)(X);
-  A2 = Z1 * W2.transpose();
-  A2.rowwise() += b2.transpose();
-  Z2.conservativeResize(A2.rows(), A2.cols());
-  activationFunction(act, A2, Z2);
-
+  double err = reconstructionError(X);
   meanActivation = Z1.colwise().sum().transpose() / N;
+  return err + sparsityPenalty(meanActivation);
+}
 
-  dEdZ2 = Z2 - X;
-  double err = dEdZ2.array().square().sum() / (2.0*N);
-  err += lambda/2.0 * (W1.array().square().sum() + W2.array().square().sum());
-  // KL divergence to target distribution:
-  // beta * sum[(rho * log(rho/rho_hat)) + (1-rho) * log((1-rho)/(1-rho_hat))]
-  err += beta * (rho * (rho * meanActivation.array().inverse()).log() +
-      (1-rho) * ((1-rho) * (1-meanActivation.array()).inverse()).log()).sum();
-  return err;
+double SparseAutoEncoder::error(unsigned int n)
+{
+  XBatch = X.row(n);
+  double err = reconstructionError(XBatch);
+  batchMeanActivation = Z1.row(0).transpose();
+  return err + sparsityPenalty(batchMeanActivation);
 }
 
 bool SparseAutoEncoder::providesGradient()
@@ -96,27 +103,32 @@ Eigen::VectorXd SparseAutoEncoder::gradient()
 
 void SparseAutoEncoder::errorGradient(double& value, Eigen::VectorXd& grad)
 {
-  const int N = X.rows();
-  // Forward propagation and error calculation
   value = error();
+  backpropagateError(X, meanActivation, grad);
+}
 
-  G2D.conservativeResize(Z2.rows(), Z2.cols());
-  activationFunctionDerivative(act, Z2, G2D);
-  Eigen::MatrixXd deltas2 = dEdZ2.cwiseProduct(G2D);
-  W2d = deltas2.transpose() * Z1 / N + lambda * W2;
-  b2d = deltas2.colwise().sum().transpose() / N;
-  Eigen::MatrixXd dEdZ1 = deltas2 * W2;
-  dEdZ1.array().rowwise() += beta *
-      (-rho * meanActivation.array().inverse()
-       +(1.0-rho) * (1.0-meanActivation.array()).inverse()).transpose();
-  G1D.conservativeResize(Z1.rows(), Z1.cols());
-  activationFunctionDerivative(act, Z1, G1D);
-  Eigen::MatrixXd deltas1 = dEdZ1.cwiseProduct(G1D);
-  W1d = deltas1.transpose() * X / N + lambda * W1;
-  b1d = deltas1.colwise().sum().transpose() / N;
+void SparseAutoEncoder::errorGradient(std::vector<int>::const_iterator startN,
+                                      std::vector<int>::const_iterator endN,
+                                      double& value, Eigen::VectorXd& grad)
+{
+  const int N = endN - startN;
+  XBatch.conservativeResize(N, D);
+  int n = 0;
+  for(std::vector<int>::const_iterator it = startN; it != endN; ++it, ++n)
+    XBatch.row(n) = X.row(*it);
 
-  pack(grad, 4, W1d.size(), W1d.data(), W2d.size(), W2d.data(),
-       b1d.size(), b1d.data(), b2d.size(), b2d.data());
+  value = reconstructionError(XBatch);
+  batchMeanActivation = Z1.colwise().sum().transpose() / N;
+  // A single mini-batch is usually too small to estimate the mean activation
+  const double decay = 0.9;
+  if(runningMeanActivation.rows() != H)
+    runningMeanActivation = batchMeanActivation;
+  else
+    runningMeanActivation = decay * runningMeanActivation +
+                            (1.0 - decay) * batchMeanActivation;
+  value += sparsityPenalty(runningMeanActivation);
+  backpropagateError(XBatch, runningMeanActivation, grad);
+  batchEvaluated = true;
 }
 
 Learner& SparseAutoEncoder::trainingSet(DataSet& trainingSet)
@@ -124,6 +136,7 @@ Learner& SparseAutoEncoder::trainingSet(DataSet& trainingSet)
   X.conservativeResize(trainingSet.samples(), trainingSet.inputs());
   for(int n = 0; n < trainingSet.samples(); n++)
     X.row(n) = trainingSet.getInstance(n);
+  runningMeanActivation.resize(0);
   return *this;
 }
 
@@ -166,6 +179,7 @@ Eigen::VectorXd SparseAutoEncoder::getParameters()
       params(idx++) = W1(h, d);
   for(int h = 0; h < H; h++)
     params(idx++) = b1(h);
+  return params;
 }
 
 OutputInfo SparseAutoEncoder::initialize(std::vector<double*>& parameterPointers,
@@ -224,4 +238,59 @@ Eigen::VectorXd SparseAutoEncoder::reconstruct(const Eigen::VectorXd& x)
   return Z2.transpose();
 }
 
+double SparseAutoEncoder::reconstructionError(const Eigen::MatrixXd& X)
+{
+  const int N = X.rows();
+  A1.noalias() = X * W1.transpose();
+  A1.rowwise() += b1.transpose();
+  Z1.conservativeResize(A1.rows(), A1.cols());
+  activationFunction(act, A1, Z1);
+  A2.noalias() = Z1 * W2.transpose();
+  A2.rowwise() += b2.transpose();
+  Z2.conservativeResize(A2.rows(), A2.cols());
+  activationFunction(act, A2, Z2);
+
+  dEdZ2 = Z2 - X;
+  double err = dEdZ2.array().square().sum() / (2.0*N);
+  err += lambda/2.0 * (W1.array().square().sum() + W2.array().square().sum());
+  return err;
+}
+
+double SparseAutoEncoder::sparsityPenalty(const Eigen::VectorXd& rhoHat)
+{
+  // KL divergence to target distribution:
+  // beta * sum[(rho * log(rho/rho_hat)) + (1-rho) * log((1-rho)/(1-rho_hat))]
+  return beta * (rho * (rho * rhoHat.array().inverse()).log() +
+      (1-rho) * ((1-rho) * (1-rhoHat.array()).inverse()).log()).sum();
+}
+
+void SparseAutoEncoder::backpropagateError(const Eigen::MatrixXd& X,
+                                           const Eigen::VectorXd& rhoHat,
+                                           Eigen::VectorXd& grad)
+{
+  // Requires the activations of the forward pass through reconstructionError
+  const int N = X.rows();
+  G2D.conservativeResize(Z2.rows(), Z2.cols());
+  activationFunctionDerivative(act, Z2, G2D);
+  deltas2 = dEdZ2.cwiseProduct(G2D);
+  W2d.noalias() = deltas2.transpose() * Z1;
+  W2d /= N;
+  W2d += lambda * W2;
+  b2d = deltas2.colwise().sum().transpose() / N;
+  dEdZ1.noalias() = deltas2 * W2;
+  dEdZ1.array().rowwise() += beta *
+      (-rho * rhoHat.array().inverse()
+       +(1.0-rho) * (1.0-rhoHat.array()).inverse()).transpose();
+  G1D.conservativeResize(Z1.rows(), Z1.cols());
+  activationFunctionDerivative(act, Z1, G1D);
+  deltas1 = dEdZ1.cwiseProduct(G1D);
+  W1d.noalias() = deltas1.transpose() * X;
+  W1d /= N;
+  W1d += lambda * W1;
+  b1d = deltas1.colwise().sum().transpose() / N;
+
+  pack(grad, 4, W1d.size(), W1d.data(), W2d.size(), W2d.data(),
+       b1d.size(), b1d.data(), b2d.size(), b2d.data());
+}
+
 } // namespace OpenANN
@@ -2,6 +2,8 @@
 #include <OpenANN/util/Random.h>
 #include <OpenANN/util/AssertionMacros.h>
 #include <OpenANN/util/OpenANNException.h>
+#include <OpenANN/util/Tracer.h>
+#include <OpenANN/util/Threads.h>
 
 namespace OpenANN
 {
@@ -103,24 +105,29 @@ void Subsampling::forwardPropagate(Eigen::MatrixXd* x, Eigen::MatrixXd*& y,
   OPENANN_CHECK_EQUALS(this->y.cols(), fm * outRows * outCols);
 
   a.setZero();
-  #pragma omp parallel for
-  for(int n = 0; n < N; n++)
+  #pragma omp parallel num_threads(numThreads(N))
   {
-    int outputIdx = 0;
-    for(int fmo = 0; fmo < fm; fmo++)
+    OPENANN_TRACE_SPAN("Subsampling::forwardPropagate", "parallel");
+    #pragma omp for
+    for(int n = 0; n < N; n++)
     {
-      for(int ri = 0, ro = 0; ri < maxRow; ri += kernelRows, ro++)
+      int outputIdx = 0;
+      for(int fmo = 0; fmo < fm; fmo++)
       {
-        int rowBase = fmo * fmInSize + ri * inCols;
-        for(int ci = 0, co = 0; ci < maxCol; ci += kernelCols, co++, outputIdx++)
+        for(int ri = 0, ro = 0; ri < maxRow; ri += kernelRows, ro++)
         {
-          for(int kr = 0; kr < kernelRows; kr++)
+          int rowBase = fmo * fmInSize + ri * inCols;
+          for(int ci = 0, co = 0; ci < maxCol;
+              ci += kernelCols, co++, outputIdx++)
           {
-            for(int kc = 0, inputIdx = rowBase + ci; kc < kernelCols; kc++)
-              a(n, outputIdx) += (*x)(n, inputIdx++) * W[fmo](ro, co);
+            for(int kr = 0; kr < kernelRows; kr++)
+            {
+              for(int kc = 0, inputIdx = rowBase + ci; kc < kernelCols; kc++)
+                a(n, outputIdx) += (*x)(n, inputIdx++) * W[fmo](ro, co);
+            }
+            if(bias)
+              a(n, outputIdx) += Wb[fmo](ro, co);
           }
-          if(bias)
-            a(n, outputIdx) += Wb[fmo](ro, co);
         }
       }
     }
@@ -0,0 +1,116 @@
+#ifdef __linux__
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <sched.h>
+#endif
+#include <OpenANN/util/Threads.h>
+#include <Eigen/Core>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace OpenANN
+{
+
+namespace
+{
+
+int threadsFromEnvironment()
+{
+  const char* value = std::getenv("OPENANN_NUM_THREADS");
+  const int threads = value ? std::atoi(value) : 0;
+  if(threads > 0)
+    Eigen::setNbThreads(threads);
+  return std::max(threads, 0);
+}
+
+//! Number of threads set by setNumThreads(), 0 means default
+int configuredThreads = 0;
+//! Number of threads from OPENANN_NUM_THREADS, 0 if it is not set
+const int environmentThreads = threadsFromEnvironment();
+
+#ifdef __linux__
+//! Affinity of the calling thread before pinThreads() pinned it
+cpu_set_t originalCpus;
+//! Whether originalCpus has to be restored
+bool pinned = false;
+#endif
+
+}
+
+void setNumThreads(int threads)
+{
+  configuredThreads = std::max(threads, 0);
+  // Eigen falls back to the default number of OpenMP threads for 0
+  Eigen::setNbThreads(configuredThreads > 0 ? configuredThreads :
+                      environmentThreads);
+}
+
+int numThreads()
+{
+  if(configuredThreads > 0)
+    return configuredThreads;
+  if(environmentThreads > 0)
+    return environmentThreads;
+#ifdef _OPENMP
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+int numThreads(int work)
+{
+  return std::max(1, std::min(numThreads(), work));
+}
+
+void setNestedParallelism(bool nested)
+{
+#ifdef _OPENMP
+  omp_set_nested(nested);
+#endif
+}
+
+bool pinThreads(bool pin)
+{
+#if defined(_OPENMP) && defined(__linux__)
+  // The calling thread is a member of the team, its affinity before the
+  // first call is the set of processors that we are allowed to use
+  if(!pinned)
+  {
+    if(!pin)
+      return true;
+    if(sched_getaffinity(0, sizeof(originalCpus), &originalCpus) != 0)
+      return false;
+  }
+  std::vector<int> allowed;
+  for(int p = 0; p < CPU_SETSIZE; p++)
+    if(CPU_ISSET(p, &originalCpus))
+      allowed.push_back(p);
+  if(allowed.empty())
+    return false;
+
+  int failures = 0;
+  #pragma omp parallel num_threads(numThreads()) reduction(+:failures)
+  {
+    cpu_set_t cpus = originalCpus;
+    if(pin)
+    {
+      CPU_ZERO(&cpus);
+      CPU_SET(allowed[omp_get_thread_num() % allowed.size()], &cpus);
+    }
+    if(sched_setaffinity(0, sizeof(cpus), &cpus) != 0)
+      failures++;
+  }
+  pinned = pin;
+  return failures == 0;
+#else
+  return false;
+#endif
+}
+
+} // namespace OpenANN
@@ -0,0 +1,186 @@
+#include <OpenANN/util/Tracer.h>
+#include <OpenANN/util/OpenANNException.h>
+#include <pthread.h>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <vector>
+
+namespace OpenANN
+{
+
+namespace
+{
+
+struct Event
+{
+  const char* name;
+  const char* category;
+  double begin;
+  double duration;
+};
+
+//! Each thread records its events in its own buffer, the lock of a buffer
+//! is only contended while the trace is started or exported
+struct ThreadBuffer
+{
+  int id;
+  pthread_mutex_t lock;
+  std::vector<Event> events;
+};
+
+pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+__thread ThreadBuffer* localBuffer = 0;
+double origin = 0.0;
+
+// Buffers and names are never released so that threads that terminate
+// after main() can still record spans.
+std::vector<ThreadBuffer*>& buffers()
+{
+  static std::vector<ThreadBuffer*>* buffers = new std::vector<ThreadBuffer*>;
+  return *buffers;
+}
+
+std::set<std::string>& names()
+{
+  static std::set<std::string>* names = new std::set<std::string>;
+  return *names;
+}
+
+double monotonicTime()
+{
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e6 + t.tv_nsec * 1e-3;
+}
+
+ThreadBuffer& threadBuffer()
+{
+  if(!localBuffer)
+  {
+    ThreadBuffer* buffer = new ThreadBuffer;
+    pthread_mutex_init(&buffer->lock, 0);
+    buffer->events.reserve(1024);
+    pthread_mutex_lock(&mutex);
+    buffer->id = buffers().size() + 1;
+    buffers().push_back(buffer);
+    pthread_mutex_unlock(&mutex);
+    localBuffer = buffer;
+  }
+  return *localBuffer;
+}
+
+void writeString(std::ostream& stream, const char* str)
+{
+  stream << '"';
+  for(; *str; ++str)
+  {
+    if(*str == '"' || *str == '\\')
+      stream << '\\' << *str;
+    else if((unsigned char) *str < 0x20)
+      stream << ' ';
+    else
+      stream << *str;
+  }
+  stream << '"';
+}
+
+}
+
+volatile bool Tracer::enabled = false;
+
+void Tracer::start()
+{
+  pthread_mutex_lock(&mutex);
+  for(size_t t = 0; t < buffers().size(); t++)
+  {
+    ThreadBuffer& buffer = *buffers()[t];
+    pthread_mutex_lock(&buffer.lock);
+    buffer.events.clear();
+    pthread_mutex_unlock(&buffer.lock);
+  }
+  origin = monotonicTime();
+  pthread_mutex_unlock(&mutex);
+  enabled = true;
+}
+
+void Tracer::stop()
+{
+  enabled = false;
+}
+
+std::string Tracer::json()
+{
+  std::stringstream stream;
+  stream << std::fixed << std::setprecision(3);
+  stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  pthread_mutex_lock(&mutex);
+  for(size_t t = 0; t < buffers().size(); t++)
+  {
+    ThreadBuffer& buffer = *buffers()[t];
+    pthread_mutex_lock(&buffer.lock);
+    if(buffer.events.empty())
+    {
+      pthread_mutex_unlock(&buffer.lock);
+      continue;
+    }
+    if(!first)
+      stream << ",";
+    first = false;
+    stream << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+           << buffer.id << ",\"args\":{\"name\":\"thread " << buffer.id
+           << "\"}}";
+    for(size_t e = 0; e < buffer.events.size(); e++)
+    {
+      const Event& event = buffer.events[e];
+      stream << ",\n{\"name\":";
+      writeString(stream, event.name);
+      stream << ",\"cat\":";
+      writeString(stream, event.category);
+      stream << ",\"ph\":\"X\",\"ts\":" << event.begin << ",\"dur\":"
+             << event.duration << ",\"pid\":1,\"tid\":" << buffer.id << "}";
+    }
+    pthread_mutex_unlock(&buffer.lock);
+  }
+  pthread_mutex_unlock(&mutex);
+  stream << "\n]}\n";
+  return stream.str();
+}
+
+void Tracer::save(const std::string& fileName)
+{
+  std::ofstream file(fileName.c_str());
+  if(!file.is_open())
+    throw OpenANNException("Could not open '" + fileName + "'.");
+  file << json();
+}
+
+double Tracer::now()
+{
+  return monotonicTime() - origin;
+}
+
+void Tracer::record(const char* name, const char* category, double begin,
+                    double duration)
+{
+  if(!enabled)
+    return;
+  Event event = {name, category, begin, duration};
+  ThreadBuffer& buffer = threadBuffer();
+  pthread_mutex_lock(&buffer.lock);
+  buffer.events.push_back(event);
+  pthread_mutex_unlock(&buffer.lock);
+}
+
+const char* Tracer::intern(const std::string& name)
+{
+  pthread_mutex_lock(&mutex);
+  const char* str = names().insert(name).first->c_str();
+  pthread_mutex_unlock(&mutex);
+  return str;
+}
+
+} // namespace OpenANN
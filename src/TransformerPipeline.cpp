@@ -0,0 +1,329 @@
+#include <OpenANN/TransformerPipeline.h>
+#include <OpenANN/util/AssertionMacros.h>
+#include <OpenANN/util/BinaryIO.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <typeinfo>
+#include <stdint.h>
+#include <unistd.h>
+
+namespace OpenANN
+{
+
+/**
+ * 64 bit FNV-1a hash of a byte sequence.
+ */
+static uint64_t hashBytes(const void* data, size_t size, uint64_t hash)
+{
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+  for(size_t i = 0; i < size; i++)
+  {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+/**
+ * 64 bit FNV-1a hash of a matrix including its shape.
+ */
+static uint64_t hashMatrix(const Eigen::MatrixXd& X, uint64_t hash)
+{
+  const int shape[2] = {(int) X.rows(), (int) X.cols()};
+  hash = hashBytes(shape, sizeof(shape), hash);
+  return hashBytes(X.data(), X.size() * sizeof(double), hash);
+}
+
+/**
+ * Name of a temporary file next to the given file. The name is unique for
+ * each process and for each matrix that will be written concurrently.
+ */
+static std::string temporaryFileName(const std::string& fileName,
+                                     const Eigen::MatrixXd& Y)
+{
+  std::stringstream temporary;
+  temporary << fileName << "." << getpid() << "-"
+            << static_cast<const void*>(Y.data()) << ".tmp";
+  return temporary.str();
+}
+
+/**
+ * Replace a file by a completely written temporary file.
+ */
+static void replaceFile(std::ofstream& out, const std::string& temporary,
+                        const std::string& fileName)
+{
+  out.close();
+  if(!out || std::rename(temporary.c_str(), fileName.c_str()) != 0)
+    std::remove(temporary.c_str());
+}
+
+TransformerPipeline::TransformerPipeline(int blockSize)
+  : blockSize(blockSize)
+{
+  OPENANN_CHECK(blockSize > 0);
+}
+
+TransformerPipeline& TransformerPipeline::add(Transformer& transformer)
+{
+  transformers.push_back(&transformer);
+  return *this;
+}
+
+TransformerPipeline& TransformerPipeline::cache(const std::string& directory)
+{
+  cacheDirectory = directory;
+  return *this;
+}
+
+Transformer& TransformerPipeline::fit(const Eigen::MatrixXd& X)
+{
+  if(!transformers.empty())
+    transformers[0]->fit(X);
+  for(size_t i = 1; i < transformers.size(); i++)
+  {
+    // The input of this stage only exists while it is being fitted
+    std::vector<Stage> stages;
+    fuse(stages, i);
+    transformers[i]->fit(apply(stages, X));
+  }
+  return *this;
+}
+
+Transformer& TransformerPipeline::fitPartial(const Eigen::MatrixXd& X)
+{
+  const int N = X.rows();
+  for(size_t i = 0; i < transformers.size(); i++)
+  {
+    std::vector<Stage> stages;
+    fuse(stages, i);
+    for(int start = 0; start < N; start += blockSize)
+    {
+      const int rows = std::min(blockSize, N - start);
+      transformers[i]->fitPartial(apply(stages, X.middleRows(start, rows)));
+    }
+  }
+  return *this;
+}
+
+std::string TransformerPipeline::cacheFileName(const Eigen::MatrixXd& X)
+{
+  if(cacheDirectory.empty())
+    return "";
+  std::vector<Stage> stages;
+  fuse(stages, transformers.size());
+  int outputs;
+  return cacheFileName(stages, X, outputs);
+}
+
+std::string TransformerPipeline::fittedCacheFileName(const Eigen::MatrixXd& X)
+{
+  if(cacheDirectory.empty())
+    return "";
+  // The parameters of the transformations are not part of the name,
+  // Transformer::load() rejects states of differently constructed objects
+  std::stringstream configuration;
+  configuration << blockSize;
+  for(size_t i = 0; i < transformers.size(); i++)
+    configuration << " " << typeid(*transformers[i]).name();
+  const std::string description = configuration.str();
+  const uint64_t hash = hashBytes(description.data(), description.size(),
+                                  hashMatrix(X, 14695981039346656037ULL));
+  std::stringstream fileName;
+  fileName << cacheDirectory << "/fitted-" << std::hex << hash << ".bin";
+  return fileName.str();
+}
+
+Eigen::MatrixXd TransformerPipeline::fitTransform(const Eigen::MatrixXd& X)
+{
+  const std::string fileName = fittedCacheFileName(X);
+  if(!fileName.empty())
+  {
+    // Transformations that have been loaded before a mismatch will be
+    // fitted again
+    std::ifstream in(fileName.c_str(), std::ios::binary);
+    bool loaded = in.is_open();
+    for(size_t i = 0; loaded && i < transformers.size(); i++)
+      loaded = transformers[i]->load(in);
+    Eigen::MatrixXd Y;
+    if(loaded && readBinary(in, Y) && Y.rows() == X.rows() &&
+       in.peek() == std::ifstream::traits_type::eof())
+      return Y;
+  }
+
+  fit(X);
+  std::vector<Stage> stages;
+  fuse(stages, transformers.size());
+  Eigen::MatrixXd Y = apply(stages, X);
+  if(!fileName.empty())
+  {
+    const std::string temporary = temporaryFileName(fileName, Y);
+    std::ofstream out(temporary.c_str(), std::ios::binary);
+    bool stored = out.is_open();
+    for(size_t i = 0; stored && i < transformers.size(); i++)
+      stored = transformers[i]->save(out);
+    if(stored)
+    {
+      writeBinary(out, Y);
+      replaceFile(out, temporary, fileName);
+    }
+    else
+    {
+      out.close();
+      std::remove(temporary.c_str());
+    }
+  }
+  return Y;
+}
+
+Eigen::MatrixXd TransformerPipeline::transform(const Eigen::MatrixXd& X)
+{
+  std::vector<Stage> stages;
+  fuse(stages, transformers.size());
+  if(cacheDirectory.empty())
+    return apply(stages, X);
+
+  int outputs;
+  const std::string fileName = cacheFileName(stages, X, outputs);
+  std::ifstream in(fileName.c_str(), std::ios::binary);
+  if(in.is_open())
+  {
+    // The header must match the expected size exactly, a corrupt or foreign
+    // file will be overwritten
+    int rows = -1, cols = -1;
+    in.read(reinterpret_cast<char*>(&rows), sizeof(rows));
+    in.read(reinterpret_cast<char*>(&cols), sizeof(cols));
+    if(in && rows == X.rows() && cols == outputs)
+    {
+      Eigen::MatrixXd Y(rows, cols);
+      in.read(reinterpret_cast<char*>(Y.data()), Y.size() * sizeof(double));
+      if(in && in.peek() == std::ifstream::traits_type::eof())
+        return Y;
+    }
+    in.close();
+  }
+
+  // Concurrent readers must never see a partially written file
+  Eigen::MatrixXd Y = apply(stages, X);
+  const std::string temporary = temporaryFileName(fileName, Y);
+  std::ofstream out(temporary.c_str(), std::ios::binary);
+  if(out.is_open())
+  {
+    writeBinary(out, Y);
+    replaceFile(out, temporary, fileName);
+  }
+  return Y;
+}
+
+bool TransformerPipeline::affine(Eigen::MatrixXd& W, Eigen::VectorXd& b)
+{
+  std::vector<Stage> stages;
+  fuse(stages, transformers.size());
+  if(stages.size() != 1 || stages[0].transformer)
+    return false;
+  W = stages[0].W;
+  b = stages[0].b;
+  return true;
+}
+
+std::string TransformerPipeline::cacheFileName(std::vector<Stage>& stages,
+                                               const Eigen::MatrixXd& X,
+                                               int& outputs)
+{
+  // The transformed first instances identify the fitted transformations
+  const int probeSize = std::min<int>(X.rows(), 8);
+  const Eigen::MatrixXd probe = apply(stages, X.topRows(probeSize));
+  outputs = probe.cols();
+  const uint64_t hash = hashMatrix(probe,
+                                   hashMatrix(X, 14695981039346656037ULL));
+  std::stringstream fileName;
+  fileName << cacheDirectory << "/transformed-" << std::hex << hash << ".bin";
+  return fileName.str();
+}
+
+void TransformerPipeline::fuse(std::vector<Stage>& stages, size_t count)
+{
+  // Stages with a transformer will be applied through Transformer::transform(),
+  // others through Y = X W + 1 b^T. Only the first count transformers will
+  // be used.
+  OPENANN_CHECK(count <= transformers.size());
+  Stage stage;
+  int affineTransformers = 0;
+  for(size_t i = 0; i <= count; i++)
+  {
+    Eigen::MatrixXd W;
+    Eigen::VectorXd b;
+    const bool isAffine = i < count &&
+                          transformers[i]->affine(W, b);
+    if(isAffine)
+    {
+      if(affineTransformers == 0)
+      {
+        stage.transformer = transformers[i];
+        stage.W = W;
+        stage.b = b;
+      }
+      else
+      {
+        // (X W1 + 1 b1^T) W2 + 1 b2^T = X (W1 W2) + 1 (W2^T b1 + b2)^T
+        stage.transformer = 0;
+        stage.b = W.transpose() * stage.b + b;
+        stage.W = stage.W * W;
+      }
+      affineTransformers++;
+      continue;
+    }
+
+    if(affineTransformers > 0)
+    {
+      // A single affine transformation might be implemented more
+      // efficiently, e.g. Normalization does not need a matrix product
+      if(affineTransformers == 1)
+      {
+        stage.W.resize(0, 0);
+        stage.b.resize(0);
+      }
+      stages.push_back(stage);
+      affineTransformers = 0;
+    }
+    if(i < count)
+    {
+      stage.transformer = transformers[i];
+      stage.W.resize(0, 0);
+      stage.b.resize(0);
+      stages.push_back(stage);
+    }
+  }
+}
+
+Eigen::MatrixXd TransformerPipeline::apply(std::vector<Stage>& stages,
+                                           const Eigen::MatrixXd& X)
+{
+  const int N = X.rows();
+  Eigen::MatrixXd Y;
+  Eigen::MatrixXd block;
+  for(int start = 0; start < N; start += blockSize)
+  {
+    const int rows = std::min(blockSize, N - start);
+    block = X.middleRows(start, rows);
+    for(size_t s = 0; s < stages.size(); s++)
+    {
+      if(stages[s].transformer)
+        block = stages[s].transformer->transform(block);
+      else
+      {
+        Eigen::MatrixXd product = block * stages[s].W;
+        product.rowwise() += stages[s].b.transpose();
+        block.swap(product);
+      }
+    }
+    if(start == 0)
+      Y.resize(N, block.cols());
+    Y.middleRows(start, rows) = block;
+  }
+  return Y;
+}
+
+} // namespace OpenANN
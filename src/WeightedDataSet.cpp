@@ -1,5 +1,7 @@
 #include <OpenANN/io/WeightedDataSet.h>
 #include <OpenANN/util/Random.h>
+#include <algorithm>
+#include <numeric>
 
 namespace OpenANN
 {
@@ -15,6 +17,7 @@ WeightedDataSet& WeightedDataSet::updateWeights(const Eigen::VectorXd& weights)
 {
   this->weights = weights;
   resample();
+  return *this;
 }
 
 int WeightedDataSet::samples()
@@ -46,16 +49,36 @@ void WeightedDataSet::resample()
 {
   const int N = dataSet.samples();
   originalIndices.resize(N);
-  RandomNumberGenerator rng;
-  for(int n = 0; n < N; n++)
+  // Instance i will be selected for p in (cumulativeWeights[i-1],
+  // cumulativeWeights[i]], i.e. we search the first cumulative weight >= p
+  cumulativeWeights.resize(N);
+  std::partial_sum(weights.data(), weights.data() + N,
+                   cumulativeWeights.begin());
+
+  if(deterministic)
   {
-    const double p = deterministic ?
-        (double) (n+1) / (double) N : rng.generate<double>(0.0, 1.0);
-    double sum = 0.0;
+    // p increases monotonically, hence we can continue the search where we
+    // stopped for the previous instance
     int idx = 0;
-    for(; sum < p && idx < N; idx++)
-      sum += weights(idx);
-    originalIndices[n] = idx-1;
+    for(int n = 0; n < N; n++)
+    {
+      const double p = (double) (n+1) / (double) N;
+      while(idx < N-1 && cumulativeWeights[idx] < p)
+        idx++;
+      originalIndices[n] = idx;
+    }
+  }
+  else
+  {
+    RandomNumberGenerator rng;
+    for(int n = 0; n < N; n++)
+    {
+      const double p = rng.generate<double>(0.0, 1.0);
+      const int idx = std::lower_bound(cumulativeWeights.begin(),
+                                       cumulativeWeights.end(), p) -
+                      cumulativeWeights.begin();
+      originalIndices[n] = std::min(idx, N-1);
+    }
   }
 }
 
@@ -1,32 +1,33 @@
 #include <OpenANN/ZCAWhitening.h>
 #include <OpenANN/util/AssertionMacros.h>
-#include <Eigen/SVD>
+#include <OpenANN/util/BinaryIO.h>
+#include <Eigen/Eigenvalues>
 #include <cmath>
 
 namespace OpenANN
 {
 
-Transformer& ZCAWhitening::fit(const Eigen::MatrixXd& X)
+ZCAWhitening::ZCAWhitening()
+  : outdated(false)
 {
-  const int N = X.rows();
-  const int D = X.cols();
-  mean = X.colwise().mean();
-  Eigen::MatrixXd aligned = X;
-  aligned.rowwise() -= mean.transpose();
-  Eigen::MatrixXd cov = aligned.transpose() * aligned / (double) (N-1);
+}
 
-  Eigen::JacobiSVD<Eigen::MatrixXd> svd(cov, Eigen::ComputeFullV);
-  Eigen::VectorXd S = svd.singularValues();
-  W = svd.matrixV();
-  for(int d = 0; d < D; ++d)
-    W.row(d).array() /= (S.transpose().array() + 1e-5).sqrt();
-  W *= svd.matrixV().transpose();
+Transformer& ZCAWhitening::fit(const Eigen::MatrixXd& X)
+{
+  statistics.reset();
+  return fitPartial(X);
+}
 
+Transformer& ZCAWhitening::fitPartial(const Eigen::MatrixXd& X)
+{
+  statistics.add(X);
+  outdated = true;
   return *this;
 }
 
 Eigen::MatrixXd ZCAWhitening::transform(const Eigen::MatrixXd& X)
 {
+  update();
   OPENANN_CHECK(mean.rows() > 0);
   OPENANN_CHECK_EQUALS(X.cols(), mean.rows());
   Eigen::MatrixXd Y = X;
@@ -34,4 +35,53 @@ Eigen::MatrixXd ZCAWhitening::transform(const Eigen::MatrixXd& X)
   return Y * W.transpose();
 }
 
+bool ZCAWhitening::affine(Eigen::MatrixXd& W, Eigen::VectorXd& b)
+{
+  update();
+  OPENANN_CHECK(mean.rows() > 0);
+  W = this->W.transpose();
+  b = -this->W * mean;
+  return true;
+}
+
+bool ZCAWhitening::save(std::ostream& stream)
+{
+  update();
+  statistics.save(stream);
+  writeBinary(stream, mean);
+  writeBinary(stream, W);
+  return (bool) stream;
+}
+
+bool ZCAWhitening::load(std::istream& stream)
+{
+  OnlineCovariance statistics;
+  Eigen::VectorXd mean;
+  Eigen::MatrixXd W;
+  if(!statistics.load(stream) || !readBinary(stream, mean) ||
+     !readBinary(stream, W) || W.rows() != mean.rows() ||
+     W.cols() != mean.rows())
+    return false;
+  this->statistics = statistics;
+  this->mean = mean;
+  this->W = W;
+  outdated = false;
+  return true;
+}
+
+void ZCAWhitening::update()
+{
+  if(!outdated)
+    return;
+  outdated = false;
+
+  mean = statistics.getMean();
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(
+      statistics.getCovariance());
+  Eigen::VectorXd S = eig.eigenvalues();
+  S = (S.array() < 0.0).select(0.0, S);
+  W = eig.eigenvectors() * (S.array() + 1e-5).sqrt().inverse().matrix()
+      .asDiagonal() * eig.eigenvectors().transpose();
+}
+
 }
@@ -3,13 +3,17 @@
 #include <OpenANN/Net.h>
 #include <OpenANN/Evaluation.h>
 #include <OpenANN/io/DirectStorageDataSet.h>
+#include <OpenANN/io/WeightedDataSet.h>
 #include <OpenANN/optimization/CG.h>
 #include <OpenANN/util/Random.h>
+#include <cmath>
 #include <list>
+#include <vector>
 
 void AdaBoostTestCase::run()
 {
   RUN(AdaBoostTestCase, adaBoost);
+  RUN(AdaBoostTestCase, reweighting);
 }
 
 void AdaBoostTestCase::setUp()
@@ -65,3 +69,88 @@ void AdaBoostTestCase::adaBoost()
       it != nets.end(); it++)
     delete *it;
 }
+
+void AdaBoostTestCase::reweighting()
+{
+  const int D = 2;
+  const int F = 2;
+  const int N = 200;
+  const int M = 4;
+  Eigen::MatrixXd X(N, D);
+  Eigen::MatrixXd T(N, F);
+  T.setZero();
+  OpenANN::RandomNumberGenerator rng;
+  for(int n = 0; n < N; n++)
+  {
+    X(n, 0) = rng.sampleNormalDistribution<double>();
+    X(n, 1) = rng.sampleNormalDistribution<double>();
+    const double noise = rng.sampleNormalDistribution<double>();
+    T(n, X(n, 0) + 0.5 * X(n, 1) + noise > 0.0 ? 1 : 0) = 1.0;
+  }
+  OpenANN::DirectStorageDataSet dataSet(&X, &T);
+
+  OpenANN::CG optimizer;
+  OpenANN::StoppingCriteria stop;
+  stop.maximalIterations = 20;
+  optimizer.setStopCriteria(stop);
+
+  std::vector<OpenANN::Net*> nets;
+  for(int m = 0; m < 2 * M; m++)
+  {
+    OpenANN::Net* net = new OpenANN::Net;
+    nets.push_back(net);
+  }
+
+  rng.seed(2);
+  OpenANN::AdaBoost adaBoost;
+  for(int m = 0; m < M; m++)
+  {
+    nets[m]->inputLayer(D).outputLayer(F, OpenANN::LOGISTIC);
+    adaBoost.addLearner(*nets[m]);
+  }
+  adaBoost.setOptimizer(optimizer);
+  adaBoost.train(dataSet);
+  const Eigen::VectorXd actual = adaBoost.getWeights();
+
+  // Evaluate each instance separately with the same initialization
+  rng.seed(2);
+  for(int m = M; m < 2 * M; m++)
+    nets[m]->inputLayer(D).outputLayer(F, OpenANN::LOGISTIC);
+  Eigen::VectorXd expected(M);
+  expected.setZero();
+  Eigen::VectorXd weights(N);
+  weights.fill(1.0 / (double) N);
+  OpenANN::WeightedDataSet resampled(dataSet, weights, true);
+  int updates = 0;
+  for(int t = 0; t < M; t++)
+  {
+    OpenANN::Net& net = *nets[M + t];
+    net.trainingSet(resampled);
+    optimizer.setOptimizable(net);
+    optimizer.optimize();
+    net.removeTrainingSet();
+    const double error = 1.0 - OpenANN::weightedAccuracy(net, dataSet,
+                                                         weights);
+    expected(t) = 0.5 * std::log((1.0 - error) / (error + 1e-10));
+    if(error == 0.0 || error >= 0.5)
+      continue;
+    for(int n = 0; n < N; n++)
+    {
+      const bool correct =
+          OpenANN::oneOfCDecoding(net(dataSet.getInstance(n))) ==
+          OpenANN::oneOfCDecoding(dataSet.getTarget(n));
+      weights(n) *= std::exp((correct ? -1.0 : 1.0) * expected(t));
+    }
+    weights /= weights.sum();
+    resampled.updateWeights(weights);
+    updates++;
+  }
+  expected /= expected.sum();
+
+  ASSERT(updates > 0);
+  for(int t = 0; t < M; t++)
+    ASSERT_EQUALS_DELTA(actual(t), expected(t), 1e-8);
+
+  for(int m = 0; m < 2 * M; m++)
+    delete nets[m];
+}
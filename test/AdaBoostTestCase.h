@@ -8,6 +8,7 @@ class AdaBoostTestCase : public TestCase
   virtual void run();
   virtual void setUp();
   void adaBoost();
+  void reweighting();
 };
 
 #endif // OPENANN_TEST_ADA_BOOST_TEST_CASE_H_
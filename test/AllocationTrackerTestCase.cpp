@@ -0,0 +1,59 @@
+#include "AllocationTrackerTestCase.h"
+#include <OpenANN/util/AllocationTracker.h>
+#include <OpenANN/layers/Dropout.h>
+#include <Eigen/Core>
+#include <vector>
+
+using namespace OpenANN;
+
+void AllocationTrackerTestCase::run()
+{
+  RUN(AllocationTrackerTestCase, counting);
+  RUN(AllocationTrackerTestCase, allocationFreeInference);
+}
+
+void AllocationTrackerTestCase::counting()
+{
+  AllocationTracker tracker;
+  {
+    Eigen::VectorXd v(100);
+    v.setZero();
+  }
+  if(AllocationTracker::available())
+  {
+    ASSERT_EQUALS(tracker.allocations(), 1);
+    ASSERT(tracker.bytes() >= 100 * sizeof(double));
+  }
+  else
+  {
+    ASSERT_EQUALS(tracker.allocations(), 0);
+    ASSERT_EQUALS(tracker.bytes(), 0);
+  }
+
+  tracker.reset();
+  Eigen::Matrix<double, 10, 1> fixed;
+  fixed.setOnes();
+  ASSERT_EQUALS(fixed.sum(), 10.0);
+  ASSERT_EQUALS(tracker.allocations(), 0);
+  ASSERT_EQUALS(tracker.bytes(), 0);
+}
+
+void AllocationTrackerTestCase::allocationFreeInference()
+{
+  OutputInfo info;
+  info.dimensions.push_back(100);
+  Dropout layer(info, 0.5);
+  std::vector<double*> parameterPointers;
+  std::vector<double*> parameterDerivativePointers;
+  layer.initialize(parameterPointers, parameterDerivativePointers);
+  Eigen::MatrixXd x = Eigen::MatrixXd::Random(10, 100);
+  Eigen::MatrixXd* y;
+  Eigen::MatrixXd* e;
+
+  // Without dropout the input is passed through
+  AllocationTracker tracker;
+  layer.forwardPropagate(&x, y, false);
+  layer.backpropagate(&x, e, true);
+  ASSERT_EQUALS(tracker.allocations(), 0);
+  ASSERT(y == &x);
+}
@@ -0,0 +1,13 @@
+#ifndef OPENANN_TEST_ALLOCATION_TRACKER_TEST_CASE_H_
+#define OPENANN_TEST_ALLOCATION_TRACKER_TEST_CASE_H_
+
+#include <Test/TestCase.h>
+
+class AllocationTrackerTestCase : public TestCase
+{
+  virtual void run();
+  void counting();
+  void allocationFreeInference();
+};
+
+#endif // OPENANN_TEST_ALLOCATION_TRACKER_TEST_CASE_H_
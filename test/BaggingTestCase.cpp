@@ -3,12 +3,15 @@
 #include <OpenANN/Net.h>
 #include <OpenANN/Evaluation.h>
 #include <OpenANN/optimization/CG.h>
+#include <OpenANN/optimization/MBSGD.h>
 #include <OpenANN/io/DirectStorageDataSet.h>
 #include <OpenANN/util/Random.h>
+#include <OpenANN/util/Threads.h>
 
 void BaggingTestCase::run()
 {
   RUN(BaggingTestCase, bagging);
+  RUN(BaggingTestCase, threadIndependence);
 }
 
 void BaggingTestCase::setUp()
@@ -67,3 +70,61 @@ void BaggingTestCase::bagging()
       it != nets.end(); it++)
     delete *it;
 }
+
+Eigen::MatrixXd trainEnsemble(int threads, int skip, const Eigen::MatrixXd& X,
+                              const Eigen::MatrixXd& T,
+                              Eigen::MatrixXd& averagePrediction)
+{
+  const int models = 6;
+  OpenANN::setNumThreads(threads);
+  OpenANN::RandomNumberGenerator rng;
+  rng.seed(1);
+  Eigen::MatrixXd inputs = X, targets = T;
+  OpenANN::DirectStorageDataSet dataSet(&inputs, &targets);
+  OpenANN::Bagging bagging(0.5);
+  std::vector<OpenANN::Net*> nets;
+  for(int m = 0; m < models; m++)
+  {
+    OpenANN::Net* net = new OpenANN::Net;
+    net->inputLayer(X.cols());
+    net->fullyConnectedLayer(3, OpenANN::TANH);
+    net->outputLayer(T.cols(), OpenANN::LINEAR);
+    nets.push_back(net);
+    bagging.addLearner(*net);
+  }
+  OpenANN::MBSGD optimizer(0.1, 0.5, 5);
+  OpenANN::StoppingCriteria stop;
+  stop.maximalIterations = 5;
+  optimizer.setStopCriteria(stop);
+  bagging.setOptimizer(optimizer);
+  for(int i = 0; i < skip; i++)
+    rng.generateIndex(10);
+  bagging.train(dataSet);
+
+  Eigen::MatrixXd Y = bagging(inputs);
+  averagePrediction = Eigen::MatrixXd::Zero(X.rows(), T.cols());
+  for(int m = 0; m < models; m++)
+  {
+    averagePrediction += (*nets[m])(inputs) / models;
+    delete nets[m];
+  }
+  return Y;
+}
+
+void BaggingTestCase::threadIndependence()
+{
+  // Each model draws from its own random stream, hence parallel training
+  // gives the same ensemble as serial training and it does not depend on
+  // random numbers that have been drawn by other parts of the program
+  const int threads = OpenANN::numThreads();
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(40, 2);
+  Eigen::MatrixXd T = X.rowwise().sum();
+  Eigen::MatrixXd average1, average4;
+  Eigen::MatrixXd Y1 = trainEnsemble(1, 0, X, T, average1);
+  Eigen::MatrixXd Y4 = trainEnsemble(4, 7, X, T, average4);
+  OpenANN::setNumThreads(threads);
+
+  ASSERT(Y1 == Y4);
+  for(int n = 0; n < X.rows(); n++)
+    ASSERT_EQUALS_DELTA(Y4(n, 0), average4(n, 0), 1e-10);
+}
@@ -8,6 +8,7 @@ class BaggingTestCase : public TestCase
   virtual void run();
   virtual void setUp();
   void bagging();
+  void threadIndependence();
 };
 
 #endif // OPENANN_TEST_BAGGING_TEST_CASE_H_
@@ -0,0 +1,186 @@
+#include "BatchPredictorTestCase.h"
+#include <OpenANN/BatchPredictor.h>
+#include <OpenANN/Net.h>
+#include <OpenANN/layers/SigmaPi.h>
+#include <OpenANN/io/DirectStorageDataSet.h>
+#include <OpenANN/util/Random.h>
+#include <OpenANN/util/Threads.h>
+
+class RecordingSink : public OpenANN::PredictionSink
+{
+public:
+  Eigen::MatrixXd Y;
+  int next;
+  bool ordered;
+
+  RecordingSink(int N, int F) : Y(N, F), next(0), ordered(true) {}
+  virtual void consume(int offset, const Eigen::MatrixXd& tile)
+  {
+    ordered = ordered && offset == next;
+    next = offset + tile.rows();
+    Y.middleRows(offset, tile.rows()) = tile;
+  }
+};
+
+void BatchPredictorTestCase::run()
+{
+  RUN(BatchPredictorTestCase, predictMatrix);
+  RUN(BatchPredictorTestCase, predictDataSet);
+  RUN(BatchPredictorTestCase, updatedParameters);
+  RUN(BatchPredictorTestCase, notReplicable);
+  RUN(BatchPredictorTestCase, customLayer);
+  RUN(BatchPredictorTestCase, randomNumbers);
+}
+
+void BatchPredictorTestCase::predictMatrix()
+{
+  const int threads = OpenANN::numThreads();
+  OpenANN::setNumThreads(4);
+  const int N = 1000;
+  const int D = 6;
+  const int F = 3;
+  OpenANN::Net net;
+  net.inputLayer(D)
+  .fullyConnectedLayer(10, OpenANN::TANH)
+  .outputLayer(F, OpenANN::LINEAR)
+  .setErrorFunction(OpenANN::CE);
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(N, D);
+  Eigen::MatrixXd expected = net(X);
+
+  OpenANN::BatchPredictor predictor(net, 64);
+  ASSERT_EQUALS(predictor.getTileSize(), 64);
+  Eigen::MatrixXd Y = predictor(X);
+  ASSERT_EQUALS(Y.rows(), N);
+  ASSERT_EQUALS(Y.cols(), F);
+  for(int n = 0; n < N; n++)
+    for(int f = 0; f < F; f++)
+      ASSERT_EQUALS_DELTA(Y(n, f), expected(n, f), 1e-10);
+
+  OpenANN::BatchPredictor automatic(net);
+  ASSERT(automatic.getTileSize() >= 16);
+  ASSERT(automatic.getTileSize() <= 1024);
+  OpenANN::setNumThreads(threads);
+}
+
+void BatchPredictorTestCase::predictDataSet()
+{
+  const int threads = OpenANN::numThreads();
+  OpenANN::setNumThreads(3);
+  const int N = 500;
+  const int D = 4;
+  const int F = 2;
+  OpenANN::Net net;
+  net.inputLayer(D)
+  .fullyConnectedLayer(5, OpenANN::RECTIFIER)
+  .outputLayer(F, OpenANN::LINEAR);
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(N, D);
+  Eigen::MatrixXd T = Eigen::MatrixXd::Zero(N, F);
+  OpenANN::DirectStorageDataSet dataSet(&X, &T);
+  Eigen::MatrixXd expected = net(X);
+
+  OpenANN::BatchPredictor predictor(net, 32);
+  RecordingSink sink(N, F);
+  predictor.predict(dataSet, sink);
+  ASSERT(sink.ordered);
+  ASSERT_EQUALS(sink.next, N);
+  for(int n = 0; n < N; n++)
+    for(int f = 0; f < F; f++)
+      ASSERT_EQUALS_DELTA(sink.Y(n, f), expected(n, f), 1e-10);
+  OpenANN::setNumThreads(threads);
+}
+
+void BatchPredictorTestCase::updatedParameters()
+{
+  const int threads = OpenANN::numThreads();
+  OpenANN::setNumThreads(4);
+  const int N = 200;
+  const int D = 3;
+  OpenANN::Net net;
+  net.inputLayer(D)
+  .fullyConnectedLayer(4, OpenANN::LOGISTIC)
+  .outputLayer(1, OpenANN::LINEAR);
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(N, D);
+
+  OpenANN::BatchPredictor predictor(net, 16);
+  predictor(X);
+  net.initialize();
+  Eigen::MatrixXd expected = net(X);
+  Eigen::MatrixXd Y;
+  predictor.predict(X, Y);
+  for(int n = 0; n < N; n++)
+    ASSERT_EQUALS_DELTA(Y(n, 0), expected(n, 0), 1e-10);
+  OpenANN::setNumThreads(threads);
+}
+
+void BatchPredictorTestCase::notReplicable()
+{
+  const int threads = OpenANN::numThreads();
+  OpenANN::setNumThreads(4);
+  const int N = 100;
+  const int D = 5;
+  OpenANN::Net net;
+  net.inputLayer(D)
+  .extremeLayer(20, OpenANN::RECTIFIER)
+  .outputLayer(2, OpenANN::LINEAR);
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(N, D);
+  Eigen::MatrixXd expected = net(X);
+
+  // The random matrix of the extreme layer cannot be copied, hence the
+  // network itself will compute all tiles
+  OpenANN::BatchPredictor predictor(net, 16);
+  Eigen::MatrixXd Y = predictor(X);
+  for(int n = 0; n < N; n++)
+    for(int f = 0; f < 2; f++)
+      ASSERT_EQUALS_DELTA(Y(n, f), expected(n, f), 1e-10);
+  OpenANN::setNumThreads(threads);
+}
+
+void BatchPredictorTestCase::customLayer()
+{
+  const int threads = OpenANN::numThreads();
+  OpenANN::setNumThreads(4);
+  const int N = 100;
+  OpenANN::Net net;
+  net.inputLayer(2, 2);
+  OpenANN::SigmaPi* layer = new OpenANN::SigmaPi(net.getOutputInfo(0), false,
+                                                 OpenANN::TANH, 0.05);
+  layer->secondOrderNodes(3);
+  net.addLayer(layer);
+  net.outputLayer(2, OpenANN::LINEAR);
+  ASSERT(!net.isStorable());
+  ASSERT(!net.isReplicable());
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(N, 4);
+  Eigen::MatrixXd expected = net(X);
+
+  // Layers that have been added with addLayer() will not be saved, hence
+  // the network cannot be replicated
+  OpenANN::BatchPredictor predictor(net, 16);
+  Eigen::MatrixXd Y = predictor(X);
+  for(int n = 0; n < N; n++)
+    for(int f = 0; f < 2; f++)
+      ASSERT_EQUALS_DELTA(Y(n, f), expected(n, f), 1e-10);
+  OpenANN::setNumThreads(threads);
+}
+
+void BatchPredictorTestCase::randomNumbers()
+{
+  const int threads = OpenANN::numThreads();
+  OpenANN::setNumThreads(4);
+  OpenANN::Net net;
+  net.inputLayer(3)
+  .fullyConnectedLayer(10, OpenANN::TANH)
+  .outputLayer(2, OpenANN::LINEAR);
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(100, 3);
+
+  // Predictions between two epochs must not change the random numbers of
+  // the training
+  OpenANN::RandomNumberGenerator rng;
+  rng.seed(7);
+  const double expected = rng.generate<double>(0.0, 1.0);
+  rng.seed(7);
+  OpenANN::BatchPredictor predictor(net, 16);
+  predictor(X);
+  const double actual = rng.generate<double>(0.0, 1.0);
+  ASSERT_EQUALS(actual, expected);
+  OpenANN::setNumThreads(threads);
+}
@@ -0,0 +1,17 @@
+#ifndef OPENANN_TEST_BATCH_PREDICTOR_TEST_CASE_H_
+#define OPENANN_TEST_BATCH_PREDICTOR_TEST_CASE_H_
+
+#include <Test/TestCase.h>
+
+class BatchPredictorTestCase : public TestCase
+{
+  virtual void run();
+  void predictMatrix();
+  void predictDataSet();
+  void updatedParameters();
+  void notReplicable();
+  void customLayer();
+  void randomNumbers();
+};
+
+#endif // OPENANN_TEST_BATCH_PREDICTOR_TEST_CASE_H_
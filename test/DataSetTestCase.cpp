@@ -2,6 +2,9 @@
 #include <OpenANN/io/DirectStorageDataSet.h>
 #include <OpenANN/io/DataSetView.h>
 #include <OpenANN/io/WeightedDataSet.h>
+#include <OpenANN/util/Random.h>
+#include <algorithm>
+#include <vector>
 
 #include "DataSetTestCase.h"
 
@@ -17,6 +20,7 @@ void DataSetTestCase::run()
   RUN(DataSetTestCase, dataSetSamplingWithoutReplacement);
   RUN(DataSetTestCase, dataSetSamplingWithReplacement);
   RUN(DataSetTestCase, weightedDataSet);
+  RUN(DataSetTestCase, weightedSampling);
 }
 
 void DataSetTestCase::directStorageDataSets()
@@ -275,3 +279,58 @@ void DataSetTestCase::weightedDataSet()
   ASSERT_EQUALS(resampled.getTarget(3).x(), 4.0);
   ASSERT_EQUALS(resampled.getTarget(4).x(), 4.0);
 }
+
+void DataSetTestCase::weightedSampling()
+{
+  const int N = 2000;
+  const int groups = 4;
+  Eigen::MatrixXd in(N, 1);
+  Eigen::MatrixXd out(N, 1);
+  Eigen::VectorXd weights(N);
+  for(int n = 0; n < N; n++)
+  {
+    in(n, 0) = n;
+    out(n, 0) = n % groups;
+    weights(n) = n % groups + 1;
+  }
+  weights /= weights.sum();
+  OpenANN::DirectStorageDataSet original(&in, &out);
+
+  // Linear search in the weights for each random number
+  OpenANN::RandomNumberGenerator rng;
+  rng.seed(1);
+  std::vector<int> expected(N);
+  for(int n = 0; n < N; n++)
+  {
+    const double p = rng.generate<double>(0.0, 1.0);
+    double sum = 0.0;
+    int idx = 0;
+    for(; sum < p && idx < N; idx++)
+      sum += weights(idx);
+    expected[n] = idx - 1;
+  }
+
+  rng.seed(1);
+  OpenANN::WeightedDataSet resampled(original, weights, false);
+  std::vector<int> counts(groups, 0);
+  for(int n = 0; n < N; n++)
+  {
+    ASSERT_EQUALS((int) resampled.getInstance(n).x(), expected[n]);
+    counts[(int) resampled.getTarget(n).x()]++;
+  }
+  // Group g has the probability (g + 1) / 10
+  for(int g = 0; g < groups; g++)
+    ASSERT_EQUALS_DELTA((double) counts[g] / (double) N, (g + 1) / 10.0, 0.04);
+
+  // Roulette wheel sampling selects the instances in order and the number of
+  // samples up to each instance follows the cumulative weights
+  OpenANN::WeightedDataSet roulette(original, weights, true);
+  double cumulativeWeight = 0.0;
+  for(int n = 0, i = 0; i < N; i++)
+  {
+    cumulativeWeight += weights(i);
+    while(n < N && (int) roulette.getInstance(n).x() <= i)
+      n++;
+    ASSERT_EQUALS_DELTA((double) n, cumulativeWeight * N, 1.0);
+  }
+}
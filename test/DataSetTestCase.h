@@ -16,6 +16,7 @@ public:
   void dataSetSamplingWithoutReplacement();
   void dataSetSamplingWithReplacement();
   void weightedDataSet();
+  void weightedSampling();
 };
 
 #endif // OPENANN_TEST_DATA_SET_TEST_CASE_H_
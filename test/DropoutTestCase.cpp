@@ -8,6 +8,7 @@ using namespace OpenANN;
 void DropoutTestCase::run()
 {
   RUN(DropoutTestCase, dropout);
+  RUN(DropoutTestCase, scaleAfterTraining);
 }
 
 void DropoutTestCase::dropout()
@@ -25,15 +26,45 @@ void DropoutTestCase::dropout()
   ASSERT_EQUALS(info2.dimensions[0], samples);
 
   // During training (dropout = true) approximately dropoutProbability neurons
-  // should be suppressed
+  // should be suppressed, the others are scaled up
   Eigen::MatrixXd x(2, samples);
   x.fill(1.0);
   Eigen::MatrixXd* y;
   layer.forwardPropagate(&x, y, true);
-  double mean = y->sum() / samples;
-  ASSERT_EQUALS_DELTA(mean / 2.0, dropoutProbability, 0.01);
-  // After training, the output should be scaled down
+  const int suppressed = (y->array() == 0.0).count();
+  ASSERT_EQUALS_DELTA(suppressed / (2.0 * samples), dropoutProbability, 0.01);
+  ASSERT_EQUALS((y->array() == 2.0).count(), 2 * samples - suppressed);
+  // Errors are backpropagated through the active neurons only
+  Eigen::MatrixXd* e;
+  layer.backpropagate(&x, e, true);
+  ASSERT(*e == *y);
+  // After training, the output equals the input
   layer.forwardPropagate(&x, y, false);
-  mean = y->sum() / samples;
-  ASSERT_EQUALS(mean / 2.0, dropoutProbability);
+  ASSERT(*y == x);
+}
+
+void DropoutTestCase::scaleAfterTraining()
+{
+  double dropoutProbability = 0.25;
+  int samples = 1000;
+  OutputInfo info;
+  info.dimensions.push_back(samples);
+  Dropout layer(info, dropoutProbability, false);
+  std::vector<double*> parameterPointers;
+  std::vector<double*> parameterDerivativePointers;
+  layer.initialize(parameterPointers, parameterDerivativePointers);
+
+  // Active neurons are not scaled during training
+  Eigen::MatrixXd x(2, samples);
+  x.fill(1.0);
+  Eigen::MatrixXd* y;
+  layer.forwardPropagate(&x, y, true);
+  const int suppressed = (y->array() == 0.0).count();
+  ASSERT_EQUALS((y->array() == 1.0).count(), 2 * samples - suppressed);
+  // After training, outputs and errors are scaled down
+  layer.forwardPropagate(&x, y, false);
+  ASSERT(*y == 0.75 * x);
+  Eigen::MatrixXd* e;
+  layer.backpropagate(&x, e, true);
+  ASSERT(*e == 0.75 * x);
 }
@@ -7,6 +7,7 @@ class DropoutTestCase : public TestCase
 {
   virtual void run();
   void dropout();
+  void scaleAfterTraining();
 };
 
 #endif // OPENANN_TEST_DROP_OUT_TEST_CASE_H_
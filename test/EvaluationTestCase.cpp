@@ -1,10 +1,63 @@
 #include "EvaluationTestCase.h"
 #include <OpenANN/Learner.h>
 #include <OpenANN/Evaluation.h>
+#include <OpenANN/Evaluator.h>
 #include <OpenANN/Net.h>
+#include <OpenANN/layers/SigmaPi.h>
 #include <OpenANN/optimization/LMA.h>
 #include <OpenANN/io/DirectStorageDataSet.h>
 #include <OpenANN/util/Random.h>
+#include <OpenANN/io/Logger.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * Redirects the console to a string while it exists.
+ */
+class ConsoleCapture
+{
+  std::stringstream stream;
+  std::streambuf* console;
+public:
+  ConsoleCapture()
+  {
+    // Messages of previous tests must not be captured
+    OpenANN::Log::flush();
+    console = std::cout.rdbuf(stream.rdbuf());
+    OpenANN::Logger::deactivate = false;
+  }
+
+  ~ConsoleCapture()
+  {
+    OpenANN::Log::flush();
+    std::cout.rdbuf(console);
+    OpenANN::Logger::deactivate = true;
+  }
+
+  /**
+   * Parse the evaluation results, comments and empty lines will be skipped.
+   * @return each row contains iteration, SSE, correct, wrong and time
+   */
+  std::vector<std::vector<double> > results()
+  {
+    OpenANN::Log::flush();
+    std::vector<std::vector<double> > lines;
+    std::string line;
+    while(std::getline(stream, line))
+    {
+      if(line.empty() || line[0] == '#')
+        continue;
+      std::stringstream content(line);
+      std::vector<double> values(5);
+      for(int i = 0; i < 5; i++)
+        content >> values[i];
+      lines.push_back(values);
+    }
+    return lines;
+  }
+};
 
 class ReturnInput : public OpenANN::Learner
 {
@@ -42,6 +95,10 @@ void EvaluationTestCase::run()
   RUN(EvaluationTestCase, weightedAccuracy);
   RUN(EvaluationTestCase, confusionMatrix);
   RUN(EvaluationTestCase, crossValidation);
+  RUN(EvaluationTestCase, asynchronousEvaluation);
+  RUN(EvaluationTestCase, pendingEvaluations);
+  RUN(EvaluationTestCase, unreplicableNet);
+  RUN(EvaluationTestCase, randomNumbers);
 }
 
 void EvaluationTestCase::setUp()
@@ -200,3 +257,144 @@ void EvaluationTestCase::crossValidation()
   // A linear model is not able to fit the XOR data set
   ASSERT_EQUALS(score, 0.0);
 }
+
+void EvaluationTestCase::asynchronousEvaluation()
+{
+  const int N = 300;
+  Eigen::MatrixXd X(N, 3);
+  Eigen::MatrixXd T(N, 2);
+  OpenANN::RandomNumberGenerator rng;
+  rng.fillNormalDistribution(X);
+  T.setZero();
+  for(int n = 0; n < N; n++)
+    T(n, X(n, 0) > 0.0 ? 1 : 0) = 1.0;
+  OpenANN::DirectStorageDataSet dataSet(&X, &T);
+  OpenANN::Net net;
+  net.inputLayer(3)
+  .outputLayer(2, OpenANN::LOGISTIC);
+
+  // The snapshots will be evaluated in the background while the parameters
+  // of the network change
+  const int iterations = 5;
+  std::vector<Eigen::VectorXd> parameters;
+  std::vector<std::vector<double> > expected, actual;
+  {
+    ConsoleCapture console;
+    OpenANN::MulticlassEvaluator evaluator(1, OpenANN::Logger::CONSOLE, true);
+    for(int i = 0; i < iterations; i++)
+    {
+      Eigen::VectorXd p(net.dimension());
+      rng.fillNormalDistribution(p);
+      parameters.push_back(p);
+      net.setParameters(p);
+      evaluator.evaluate(net, dataSet);
+    }
+    evaluator.wait();
+    actual = console.results();
+  }
+  {
+    ConsoleCapture console;
+    OpenANN::MulticlassEvaluator evaluator(1, OpenANN::Logger::CONSOLE);
+    for(int i = 0; i < iterations; i++)
+    {
+      net.setParameters(parameters[i]);
+      evaluator.evaluate(net, dataSet);
+    }
+    expected = console.results();
+  }
+
+  ASSERT_EQUALS(actual.size(), (size_t) iterations);
+  ASSERT_EQUALS(expected.size(), (size_t) iterations);
+  for(int i = 0; i < iterations; i++)
+  {
+    ASSERT_EQUALS((int) actual[i][0], i + 1);
+    ASSERT_EQUALS_DELTA(actual[i][1], expected[i][1], 1e-4);
+    ASSERT_EQUALS((int) actual[i][2], (int) expected[i][2]);
+    ASSERT_EQUALS((int) actual[i][3], (int) expected[i][3]);
+    ASSERT_EQUALS((int) (actual[i][2] + actual[i][3]), N);
+  }
+}
+
+void EvaluationTestCase::pendingEvaluations()
+{
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(50, 2);
+  Eigen::MatrixXd T = Eigen::MatrixXd::Identity(50, 2);
+  OpenANN::DirectStorageDataSet dataSet(&X, &T);
+  OpenANN::Net net;
+  net.inputLayer(2)
+  .outputLayer(2, OpenANN::LINEAR);
+
+  // The destructor logs all pending evaluations before it returns
+  std::vector<std::vector<double> > results;
+  {
+    ConsoleCapture console;
+    {
+      OpenANN::MulticlassEvaluator evaluator(2, OpenANN::Logger::CONSOLE,
+                                             true);
+      for(int i = 0; i < 6; i++)
+        evaluator.evaluate(net, dataSet);
+    }
+    results = console.results();
+  }
+  ASSERT_EQUALS(results.size(), (size_t) 3);
+  for(int i = 0; i < 3; i++)
+    ASSERT_EQUALS((int) results[i][0], 2 * (i + 1));
+}
+
+void EvaluationTestCase::unreplicableNet()
+{
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(20, 4);
+  Eigen::MatrixXd T = Eigen::MatrixXd::Identity(20, 2);
+  OpenANN::DirectStorageDataSet dataSet(&X, &T);
+  OpenANN::Net net;
+  net.inputLayer(2, 2);
+  OpenANN::SigmaPi* layer = new OpenANN::SigmaPi(net.getOutputInfo(0), false,
+                                                 OpenANN::TANH, 0.05);
+  layer->secondOrderNodes(3);
+  net.addLayer(layer);
+  net.outputLayer(2, OpenANN::LINEAR);
+
+  // Layers that have been added with addLayer() cannot be replicated, the
+  // network will be evaluated synchronously
+  std::vector<std::vector<double> > results;
+  {
+    ConsoleCapture console;
+    OpenANN::MulticlassEvaluator evaluator(1, OpenANN::Logger::CONSOLE, true);
+    evaluator.evaluate(net, dataSet);
+    results = console.results();
+  }
+  ASSERT_EQUALS(results.size(), (size_t) 1);
+  ASSERT_EQUALS((int) (results[0][2] + results[0][3]), 20);
+}
+
+void EvaluationTestCase::randomNumbers()
+{
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(20, 3);
+  Eigen::MatrixXd T = Eigen::MatrixXd::Identity(20, 2);
+  OpenANN::DirectStorageDataSet dataSet(&X, &T);
+  OpenANN::Net net;
+  net.inputLayer(3)
+  .fullyConnectedLayer(5, OpenANN::TANH)
+  .outputLayer(2, OpenANN::LINEAR);
+
+  // The replica of an asynchronous evaluator must not consume the random
+  // numbers of the training thread
+  OpenANN::RandomNumberGenerator rng;
+  double expected, actual;
+  {
+    ConsoleCapture console;
+    OpenANN::MulticlassEvaluator evaluator(1, OpenANN::Logger::CONSOLE);
+    rng.seed(3);
+    evaluator.evaluate(net, dataSet);
+    expected = rng.generate<double>(0.0, 1.0);
+  }
+  {
+    ConsoleCapture console;
+    OpenANN::MulticlassEvaluator evaluator(1, OpenANN::Logger::CONSOLE, true);
+    rng.seed(3);
+    evaluator.evaluate(net, dataSet);
+    actual = rng.generate<double>(0.0, 1.0);
+    evaluator.wait();
+  }
+  ASSERT_EQUALS(actual, expected);
+}
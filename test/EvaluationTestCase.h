@@ -15,6 +15,10 @@ class EvaluationTestCase : public TestCase
   void weightedAccuracy();
   void confusionMatrix();
   void crossValidation();
+  void asynchronousEvaluation();
+  void pendingEvaluations();
+  void unreplicableNet();
+  void randomNumbers();
 };
 
 #endif // OPENANN_TEST_EVALUATION_TEST_CASE_H_
@@ -6,6 +6,12 @@
 void KMeansTestCase::run()
 {
   RUN(KMeansTestCase, clustering);
+  RUN(KMeansTestCase, lloyd);
+}
+
+void KMeansTestCase::setUp()
+{
+  OpenANN::RandomNumberGenerator().seed(0);
 }
 
 void KMeansTestCase::clustering()
@@ -28,3 +34,55 @@ void KMeansTestCase::clustering()
     averageDistToCenter = newDistance;
   }
 }
+
+void KMeansTestCase::lloyd()
+{
+  const int N = 3000;
+  const int D = 5;
+  const int K = 6;
+  Eigen::MatrixXd centers(K, D);
+  OpenANN::RandomNumberGenerator rng;
+  rng.fillNormalDistribution(centers, 10.0);
+  Eigen::MatrixXd X(N, D);
+  rng.fillNormalDistribution(X);
+  for(int n = 0; n < N; n++)
+    X.row(n) += centers.row(n % K);
+
+  // k-means only finds a local minimum, hence we take the best of several
+  // restarts like in practice
+  const int restarts = 5;
+  Eigen::MatrixXd bestC;
+  double bestInertia = std::numeric_limits<double>::max();
+  for(int r = 0; r < restarts; r++)
+  {
+    OpenANN::KMeans kmeans(D, K);
+    kmeans.fit(X);
+    const Eigen::MatrixXd C = kmeans.getCenters();
+
+    // The instances are assigned to their closest centers
+    Eigen::MatrixXd Y = kmeans.transform(X);
+    for(int n = 0; n < N; n++)
+    {
+      int closest;
+      Y.row(n).minCoeff(&closest);
+      ASSERT_EQUALS_DELTA(Y(n, closest), (X.row(n) - C.row(closest)).norm(),
+                          1e-6);
+    }
+
+    const double inertia = Y.rowwise().minCoeff().squaredNorm();
+    if(inertia < bestInertia)
+    {
+      bestInertia = inertia;
+      bestC = C;
+    }
+  }
+
+  // Each cluster must be represented by one center
+  for(int k = 0; k < K; k++)
+  {
+    double distance = std::numeric_limits<double>::max();
+    for(int j = 0; j < K; j++)
+      distance = std::min(distance, (bestC.row(j) - centers.row(k)).norm());
+    ASSERT(distance < 0.5);
+  }
+}
@@ -6,7 +6,9 @@
 class KMeansTestCase : public TestCase
 {
   virtual void run();
+  virtual void setUp();
   void clustering();
+  void lloyd();
 };
 
 #endif // OPENANN_TEST_KMEANS_TEST_CASE_H_
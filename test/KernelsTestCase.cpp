@@ -0,0 +1,100 @@
+#include "KernelsTestCase.h"
+#include <OpenANN/util/Kernels.h>
+#include <Eigen/Core>
+#include <cmath>
+#include <string>
+
+void KernelsTestCase::run()
+{
+  RUN(KernelsTestCase, selection);
+  RUN(KernelsTestCase, instructionSets);
+  RUN(KernelsTestCase, accuracy);
+}
+
+void KernelsTestCase::selection()
+{
+  const std::string isa = OpenANN::kernels().isa;
+  ASSERT(!OpenANN::useKernels("unknown"));
+  ASSERT_EQUALS(std::string(OpenANN::kernels().isa), isa);
+  ASSERT(OpenANN::useKernels("generic"));
+  ASSERT_EQUALS(std::string(OpenANN::kernels().isa), std::string("generic"));
+  ASSERT(OpenANN::useKernels(isa));
+}
+
+void KernelsTestCase::instructionSets()
+{
+  // All available variants must compute bitwise identical results
+  const std::string isa = OpenANN::kernels().isa;
+  const int n = 1000;
+  Eigen::VectorXd a = Eigen::VectorXd::Random(n) * 50.0;
+  Eigen::VectorXd g = Eigen::VectorXd::Random(n);
+  OpenANN::useKernels("generic");
+  const OpenANN::Kernels generic = OpenANN::kernels();
+  const char* isas[] = {"avx2", "avx512"};
+  for(int i = 0; i < 2; i++)
+  {
+    if(!OpenANN::useKernels(isas[i]))
+      continue;
+    const OpenANN::Kernels& k = OpenANN::kernels();
+    Eigen::VectorXd expected(n), actual(n);
+    generic.logistic(a.data(), expected.data(), n);
+    k.logistic(a.data(), actual.data(), n);
+    ASSERT(expected == actual);
+    generic.tanh(a.data(), expected.data(), n);
+    k.tanh(a.data(), actual.data(), n);
+    ASSERT(expected == actual);
+    generic.scaledTanh(a.data(), expected.data(), n);
+    k.scaledTanh(a.data(), actual.data(), n);
+    ASSERT(expected == actual);
+    generic.rectifier(a.data(), expected.data(), n);
+    k.rectifier(a.data(), actual.data(), n);
+    ASSERT(expected == actual);
+    generic.logisticDerivative(g.data(), expected.data(), n);
+    k.logisticDerivative(g.data(), actual.data(), n);
+    ASSERT(expected == actual);
+    generic.tanhDerivative(g.data(), expected.data(), n);
+    k.tanhDerivative(g.data(), actual.data(), n);
+    ASSERT(expected == actual);
+    generic.scaledTanhDerivative(g.data(), expected.data(), n);
+    k.scaledTanhDerivative(g.data(), actual.data(), n);
+    ASSERT(expected == actual);
+    generic.rectifierDerivative(g.data(), expected.data(), n);
+    k.rectifierDerivative(g.data(), actual.data(), n);
+    ASSERT(expected == actual);
+
+    Eigen::VectorXd p1 = a, p2 = a, m1 = g, m2 = g;
+    generic.momentumUpdate(p1.data(), m1.data(), a.data(), 0.9, 0.01, n);
+    k.momentumUpdate(p2.data(), m2.data(), a.data(), 0.9, 0.01, n);
+    ASSERT(m1 == m2);
+    ASSERT(p1 == p2);
+  }
+  OpenANN::useKernels(isa);
+}
+
+void KernelsTestCase::accuracy()
+{
+  const int n = 1000;
+  Eigen::VectorXd a(n);
+  for(int i = 0; i < n; i++)
+    a(i) = (i - n / 2) * std::pow(10.0, i % 7 - 5);
+  Eigen::VectorXd z(n);
+  const OpenANN::Kernels& k = OpenANN::kernels();
+  k.logistic(a.data(), z.data(), n);
+  for(int i = 0; i < n; i++)
+  {
+    const double expected = 1.0 / (1.0 + std::exp(-a(i)));
+    ASSERT_EQUALS_DELTA(z(i), expected, 1e-15);
+  }
+  k.tanh(a.data(), z.data(), n);
+  for(int i = 0; i < n; i++)
+  {
+    const double expected = std::tanh(a(i));
+    ASSERT_EQUALS_DELTA(z(i), expected, 1e-14 * std::fabs(expected));
+  }
+  k.scaledTanh(a.data(), z.data(), n);
+  for(int i = 0; i < n; i++)
+  {
+    const double expected = 1.7159 * std::tanh(0.66666667 * a(i));
+    ASSERT_EQUALS_DELTA(z(i), expected, 1e-14 * std::fabs(expected));
+  }
+}
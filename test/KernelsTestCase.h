@@ -0,0 +1,14 @@
+#ifndef OPENANN_TEST_KERNELS_TEST_CASE_H_
+#define OPENANN_TEST_KERNELS_TEST_CASE_H_
+
+#include <Test/TestCase.h>
+
+class KernelsTestCase : public TestCase
+{
+  virtual void run();
+  void selection();
+  void instructionSets();
+  void accuracy();
+};
+
+#endif // OPENANN_TEST_KERNELS_TEST_CASE_H_
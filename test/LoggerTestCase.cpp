@@ -0,0 +1,79 @@
+#include "LoggerTestCase.h"
+#include <OpenANN/io/Logger.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace OpenANN;
+
+void LoggerTestCase::run()
+{
+  RUN(LoggerTestCase, asynchronousLogging);
+  RUN(LoggerTestCase, synchronousLogging);
+  RUN(LoggerTestCase, replaceStream);
+}
+
+void LoggerTestCase::asynchronousLogging()
+{
+  const int threads = 4;
+  const int messages = 5000;
+  std::stringstream stream;
+  Log::setStream(stream);
+  #pragma omp parallel for num_threads(threads)
+  for(int t = 0; t < threads; t++)
+  {
+    for(int i = 0; i < messages; i++)
+      Log().get(Log::INFO, "test") << t << " " << i;
+  }
+  Log::flush();
+  Log::setStream(std::cout);
+
+  // Each message is a complete line and the messages of each thread are
+  // written in order
+  std::vector<int> next(threads, 0);
+  std::string line;
+  int lines = 0;
+  while(std::getline(stream, line))
+  {
+    const size_t start = line.find("test: ");
+    ASSERT(start != std::string::npos);
+    std::stringstream content(line.substr(start + 6));
+    int t, i;
+    content >> t >> i;
+    ASSERT(t >= 0 && t < threads);
+    ASSERT_EQUALS(i, next[t]);
+    next[t]++;
+    lines++;
+  }
+  ASSERT_EQUALS(lines, threads * messages);
+}
+
+void LoggerTestCase::synchronousLogging()
+{
+  std::stringstream stream;
+  Log::setStream(stream);
+  Log::setAsynchronous(false);
+  Log().get(Log::INFO, 0) << "message";
+  const std::string text = stream.str();
+  Log::setAsynchronous(true);
+  Log::setStream(std::cout);
+  ASSERT(text.find("INFO") != std::string::npos);
+  ASSERT_EQUALS(text.substr(text.size() - 8), "message\n");
+}
+
+void LoggerTestCase::replaceStream()
+{
+  const int messages = 1000;
+  std::stringstream* stream = new std::stringstream;
+  Log::setStream(*stream);
+  for(int i = 0; i < messages; i++)
+    Log().get(Log::INFO, "test") << i;
+  // All messages must have been written before the stream can be deleted
+  Log::setStream(std::cout);
+  std::string line;
+  int lines = 0;
+  while(std::getline(*stream, line))
+    lines++;
+  delete stream;
+  ASSERT_EQUALS(lines, messages);
+}
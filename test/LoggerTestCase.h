@@ -0,0 +1,14 @@
+#ifndef OPENANN_TEST_LOGGER_TEST_CASE_H_
+#define OPENANN_TEST_LOGGER_TEST_CASE_H_
+
+#include <Test/TestCase.h>
+
+class LoggerTestCase : public TestCase
+{
+  virtual void run();
+  void asynchronousLogging();
+  void synchronousLogging();
+  void replaceStream();
+};
+
+#endif // OPENANN_TEST_LOGGER_TEST_CASE_H_
@@ -7,6 +7,7 @@ void MBSGDTestCase::run()
 {
   RUN(MBSGDTestCase, quadratic);
   RUN(MBSGDTestCase, restart);
+  RUN(MBSGDTestCase, metrics);
 }
 
 void MBSGDTestCase::quadratic()
@@ -45,3 +46,24 @@ void MBSGDTestCase::restart()
   optimum = mbsgd.result();
   ASSERT(q.error() < 0.001);
 }
+
+void MBSGDTestCase::metrics()
+{
+  OpenANN::MBSGD mbsgd;
+  Quadratic<10> q;
+  q.setParameters(Eigen::VectorXd::Ones(10));
+  OpenANN::StoppingCriteria s;
+  s.maximalIterations = 10;
+  mbsgd.setOptimizable(q);
+  mbsgd.setStopCriteria(s);
+  for(int i = 0; i < 3; i++)
+    mbsgd.step();
+  OpenANN::Metrics& metrics = mbsgd.getMetrics();
+  ASSERT_EQUALS_DELTA(metrics.value("steps_total"), 3.0, 1e-10);
+  ASSERT_EQUALS_DELTA(metrics.value("samples_total"),
+                      3.0 * q.examples(), 1e-10);
+  ASSERT_EQUALS(metrics.count("step_seconds"), 3UL);
+  ASSERT(metrics.count("batch_seconds") >= 3UL);
+  ASSERT(metrics.value("error") > 0.0);
+  ASSERT(metrics.value("eta_seconds") >= 0.0);
+}
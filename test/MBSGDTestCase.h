@@ -8,6 +8,7 @@ class MBSGDTestCase : public TestCase
   virtual void run();
   void quadratic();
   void restart();
+  void metrics();
 };
 
 #endif // OPENANN_TEST_MBSGD_TEST_CASE_H_
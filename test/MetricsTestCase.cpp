@@ -0,0 +1,90 @@
+#include "MetricsTestCase.h"
+#include <OpenANN/util/Metrics.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+void MetricsTestCase::run()
+{
+  RUN(MetricsTestCase, countersAndGauges);
+  RUN(MetricsTestCase, histogram);
+  RUN(MetricsTestCase, exposition);
+  RUN(MetricsTestCase, finishedStep);
+}
+
+void MetricsTestCase::countersAndGauges()
+{
+  OpenANN::Metrics metrics;
+  ASSERT_EQUALS_DELTA(metrics.value("unknown"), 0.0, 1e-10);
+  metrics.increment("steps_total");
+  metrics.increment("steps_total", 2.0);
+  ASSERT_EQUALS_DELTA(metrics.value("steps_total"), 3.0, 1e-10);
+  metrics.set("error", 5.0);
+  metrics.set("error", 4.0);
+  ASSERT_EQUALS_DELTA(metrics.value("error"), 4.0, 1e-10);
+  metrics.reset();
+  ASSERT_EQUALS_DELTA(metrics.value("steps_total"), 0.0, 1e-10);
+  ASSERT_EQUALS_DELTA(metrics.value("error"), 0.0, 1e-10);
+}
+
+void MetricsTestCase::histogram()
+{
+  OpenANN::Metrics metrics;
+  ASSERT_EQUALS(metrics.count("step_seconds"), 0UL);
+  ASSERT_EQUALS_DELTA(metrics.quantile("step_seconds", 0.5), 0.0, 1e-10);
+  for(int i = 0; i < 90; i++)
+    metrics.observe("step_seconds", 0.003);
+  for(int i = 0; i < 10; i++)
+    metrics.observe("step_seconds", 0.7);
+  ASSERT_EQUALS(metrics.count("step_seconds"), 100UL);
+  ASSERT_EQUALS_DELTA(metrics.value("step_seconds"), 90 * 0.003 + 7.0, 1e-10);
+  const double median = metrics.quantile("step_seconds", 0.5);
+  ASSERT(median > 0.0025);
+  ASSERT(median <= 0.005);
+  const double p95 = metrics.quantile("step_seconds", 0.95);
+  ASSERT(p95 > 0.5);
+  ASSERT(p95 <= 1.0);
+}
+
+void MetricsTestCase::exposition()
+{
+  OpenANN::Metrics metrics;
+  metrics.increment("samples_total", 32.0);
+  metrics.observe("batch_seconds", 0.02);
+  std::string text = metrics.exposition();
+  ASSERT(text.find("# TYPE openann_samples_total counter\n"
+                   "openann_samples_total 32\n") != std::string::npos);
+  ASSERT(text.find("# TYPE openann_batch_seconds histogram\n")
+         != std::string::npos);
+  ASSERT(text.find("openann_batch_seconds_bucket{le=\"0.01\"} 0\n")
+         != std::string::npos);
+  ASSERT(text.find("openann_batch_seconds_bucket{le=\"0.025\"} 1\n")
+         != std::string::npos);
+  ASSERT(text.find("openann_batch_seconds_bucket{le=\"+Inf\"} 1\n")
+         != std::string::npos);
+  ASSERT(text.find("openann_batch_seconds_count 1\n") != std::string::npos);
+}
+
+void MetricsTestCase::finishedStep()
+{
+  const char* fileName = "metrics.prom";
+  OpenANN::Metrics metrics;
+  metrics.exportPeriodically(fileName, 3600.0);
+  metrics.finishedStep(0.5, 100, 2.0, 1, 10);
+  metrics.finishedStep(1.5, 100, 1.0, 2, 10);
+  ASSERT_EQUALS_DELTA(metrics.value("steps_total"), 2.0, 1e-10);
+  ASSERT_EQUALS_DELTA(metrics.value("samples_total"), 200.0, 1e-10);
+  ASSERT_EQUALS_DELTA(metrics.value("samples_per_second"), 200.0 / 3.0,
+                      1e-10);
+  ASSERT_EQUALS_DELTA(metrics.value("error"), 1.0, 1e-10);
+  ASSERT_EQUALS_DELTA(metrics.value("eta_seconds"), 8.0, 1e-10);
+
+  // Only the first step has been exported because of the interval
+  std::ifstream file(fileName);
+  ASSERT(file.is_open());
+  std::stringstream content;
+  content << file.rdbuf();
+  file.close();
+  std::remove(fileName);
+  ASSERT(content.str().find("openann_steps_total 1\n") != std::string::npos);
+}
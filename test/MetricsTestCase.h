@@ -0,0 +1,15 @@
+#ifndef OPENANN_TEST_METRICS_TEST_CASE_H_
+#define OPENANN_TEST_METRICS_TEST_CASE_H_
+
+#include <Test/TestCase.h>
+
+class MetricsTestCase : public TestCase
+{
+  virtual void run();
+  void countersAndGauges();
+  void histogram();
+  void exposition();
+  void finishedStep();
+};
+
+#endif // OPENANN_TEST_METRICS_TEST_CASE_H_
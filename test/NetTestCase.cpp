@@ -3,6 +3,7 @@
 #include <OpenANN/Net.h>
 #include <OpenANN/io/DirectStorageDataSet.h>
 #include <OpenANN/util/Random.h>
+#include <OpenANN/util/AllocationTracker.h>
 #include <sstream>
 
 void NetTestCase::run()
@@ -13,9 +14,13 @@ void NetTestCase::run()
   RUN(NetTestCase, gradientCE);
   RUN(NetTestCase, multilayerNetwork);
   RUN(NetTestCase, predictMinibatch);
+  RUN(NetTestCase, predictInstance);
   RUN(NetTestCase, minibatchErrorGradient);
   RUN(NetTestCase, regularizationGradient);
+  RUN(NetTestCase, fitOutputLayer);
+  RUN(NetTestCase, profiling);
   RUN(NetTestCase, saveLoad);
+  RUN(NetTestCase, loadDropout);
 }
 
 void NetTestCase::dimension()
@@ -195,6 +200,38 @@ void NetTestCase::predictMinibatch()
   }
 }
 
+void NetTestCase::predictInstance()
+{
+  const int D = 5;
+  const int F = 3;
+  OpenANN::Net net;
+  net.inputLayer(D)
+  .fullyConnectedLayer(4, OpenANN::TANH)
+  .outputLayer(F, OpenANN::LINEAR);
+
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(10, D);
+  Eigen::VectorXd x = X.row(0);
+  Eigen::VectorXd y;
+  net(X);
+  for(int e = 0; e < 2; e++)
+  {
+    net.predict(x, y);
+    Eigen::VectorXd expected = net(x);
+    ASSERT_EQUALS(y.rows(), F);
+    for(int f = 0; f < F; f++)
+      ASSERT_EQUALS_DELTA(y(f), expected(f), 1e-10);
+    net.setErrorFunction(OpenANN::CE);
+  }
+  ASSERT_EQUALS_DELTA(y.sum(), 1.0, 1e-10);
+
+  // Buffers are reused after the first call
+  net.predict(x, y);
+  OpenANN::AllocationTracker tracker;
+  tracker.reset();
+  net.predict(x, y);
+  ASSERT_EQUALS(tracker.allocations(), 0);
+}
+
 void NetTestCase::minibatchErrorGradient()
 {
   const int D = 5;
@@ -250,6 +287,83 @@ void NetTestCase::regularizationGradient()
     ASSERT_EQUALS_DELTA(ga(k), g(k), 1e-2);
 }
 
+void NetTestCase::fitOutputLayer()
+{
+  const int D = 2;
+  const int F = 3;
+  const int N = 50;
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(N, D);
+  Eigen::MatrixXd T = Eigen::MatrixXd::Random(N, F);
+
+  OpenANN::Net net;
+  net.inputLayer(D)
+  .setRegularization(0.0, 0.1)
+  .extremeLayer(20, OpenANN::TANH, 1.0)
+  .outputLayer(F, OpenANN::LINEAR)
+  .trainingSet(X, T);
+  net.fitOutputLayer(16);
+
+  // The solution of the ridge regression is a minimum of the error function
+  double e;
+  Eigen::VectorXd g(net.dimension());
+  net.errorGradient(e, g);
+  for(int k = 0; k < net.dimension(); k++)
+    ASSERT_EQUALS_DELTA(g(k), 0.0, 1e-8);
+}
+
+void NetTestCase::profiling()
+{
+  const int D = 5;
+  const int F = 2;
+  const int N = 10;
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(N, D);
+  Eigen::MatrixXd T = Eigen::MatrixXd::Random(N, F);
+
+  OpenANN::Net net;
+  net.inputLayer(D)
+  .fullyConnectedLayer(3, OpenANN::TANH)
+  .outputLayer(F, OpenANN::LINEAR)
+  .trainingSet(X, T);
+
+  // Nothing will be recorded unless profiling is activated
+  double error;
+  Eigen::VectorXd grad(net.dimension());
+  net.errorGradient(error, grad);
+  const std::vector<OpenANN::LayerProfile>& profile = net.getProfile();
+  ASSERT_EQUALS(profile.size(), 3);
+  ASSERT_EQUALS(profile[1].forwardCalls, 0);
+
+  net.useProfiling();
+  net.errorGradient(error, grad);
+  net(X);
+  ASSERT_EQUALS(profile[1].name, "FullyConnected");
+  ASSERT_EQUALS(profile[1].inputs, D);
+  ASSERT_EQUALS(profile[1].outputs, 3);
+  ASSERT_EQUALS(profile[1].parameters, 3 * (D + 1));
+  ASSERT_EQUALS(profile[1].forwardCalls, 2);
+  ASSERT_EQUALS(profile[1].forwardInstances, 2 * N);
+  ASSERT_EQUALS(profile[1].backwardCalls, 1);
+  ASSERT_EQUALS(profile[1].backwardInstances, N);
+  ASSERT_EQUALS_DELTA(profile[1].forwardFlops,
+                      2.0 * N * (2.0 * 3 * (D + 1) + 3), 1e-10);
+  ASSERT_EQUALS_DELTA(profile[2].backwardFlops,
+                      N * (4.0 * F * (3 + 1) + F), 1e-10);
+  ASSERT(profile[2].forwardTime >= 0.0);
+  ASSERT(profile[2].bytes > 0.0);
+
+  const std::string json = net.profileReport(true);
+  ASSERT_EQUALS(json.substr(0, 15), "{\"total_time\": ");
+  ASSERT(json.find("\"type\": \"FullyConnected\"") != std::string::npos);
+  ASSERT(net.profileReport().find("FullyConnected") != std::string::npos);
+
+  net.useProfiling(false);
+  net.errorGradient(error, grad);
+  ASSERT_EQUALS(profile[1].forwardCalls, 2);
+  net.resetProfile();
+  ASSERT_EQUALS(profile[1].forwardCalls, 0);
+  ASSERT_EQUALS(profile[1].bytes, 0.0);
+}
+
 void NetTestCase::saveLoad()
 {
   OpenANN::RandomNumberGenerator().seed(0);
@@ -277,3 +391,35 @@ void NetTestCase::saveLoad()
     for(int f = 0; f < Y2.cols(); f++)
       ASSERT_EQUALS_DELTA(Y1(n, f), Y2(n, f), 1e-5);
 }
+
+void NetTestCase::loadDropout()
+{
+  OpenANN::RandomNumberGenerator().seed(0);
+  OpenANN::Net net;
+  net.inputLayer(3)
+  .dropoutLayer(0.5)
+  .outputLayer(2, OpenANN::LINEAR);
+  std::stringstream stream;
+  net.save(stream);
+  std::string saved = stream.str();
+  const size_t token = saved.find("inverted_dropout 0.5 ");
+  ASSERT(token != std::string::npos);
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(4, 3);
+
+  OpenANN::Net loadedNet;
+  std::stringstream invertedStream(saved);
+  loadedNet.load(invertedStream);
+  ASSERT_EQUALS_DELTA((loadedNet(X) - net(X)).norm(), 0.0, 1e-5);
+
+  // Networks that have been stored without inverted dropout scale the
+  // outputs of the dropout layer after training
+  saved.replace(token, std::string("inverted_dropout").size(), "dropout");
+  OpenANN::Net oldNet;
+  std::stringstream oldStream(saved);
+  oldNet.load(oldStream);
+  Eigen::MatrixXd scaledX = 0.5 * X;
+  ASSERT_EQUALS_DELTA((oldNet(X) - net(scaledX)).norm(), 0.0, 1e-5);
+  std::stringstream resaved;
+  oldNet.save(resaved);
+  ASSERT(resaved.str().find("inverted_dropout") == std::string::npos);
+}
@@ -12,9 +12,13 @@ class NetTestCase : public TestCase
   void gradientCE();
   void multilayerNetwork();
   void predictMinibatch();
+  void predictInstance();
   void minibatchErrorGradient();
   void regularizationGradient();
+  void fitOutputLayer();
+  void profiling();
   void saveLoad();
+  void loadDropout();
 };
 
 #endif // OPENANN_TEST_NET_TEST_CASE_H_
@@ -4,6 +4,7 @@
 void NormalizationTestCase::run()
 {
   RUN(NormalizationTestCase, normalize);
+  RUN(NormalizationTestCase, normalizePartial);
 }
 
 void NormalizationTestCase::normalize()
@@ -24,3 +25,33 @@ void NormalizationTestCase::normalize()
   for(int d = 0; d < D; d++)
     ASSERT_EQUALS_DELTA(s(d), 1.0, 1e-5);
 }
+
+void NormalizationTestCase::normalizePartial()
+{
+  const int N = 5000;
+  const int D = 5;
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(N, D);
+  X.array() += 1e6;
+  OpenANN::Normalization n;
+  n.fit(X);
+
+  // Accumulate statistics of batches with different sizes
+  OpenANN::Normalization incremental;
+  incremental.fitPartial(X.topRows(10));
+  incremental.fitPartial(X.middleRows(10, 2990));
+  incremental.fitPartial(X.bottomRows(2000));
+  for(int d = 0; d < D; d++)
+  {
+    ASSERT_EQUALS_DELTA(incremental.getMean()(d), n.getMean()(d), 1e-6);
+    ASSERT_EQUALS_DELTA(incremental.getStd()(d), n.getStd()(d), 1e-6);
+  }
+
+  Eigen::MatrixXd Y = n.transform(X);
+  incremental.transformInPlace(X);
+  ASSERT_EQUALS_DELTA((X - Y).norm(), 0.0, 1e-6);
+  for(int d = 0; d < D; d++)
+  {
+    ASSERT_EQUALS_DELTA(X.col(d).mean(), 0.0, 1e-6);
+    ASSERT_EQUALS_DELTA(X.col(d).squaredNorm() / N, 1.0, 1e-6);
+  }
+}
@@ -7,6 +7,7 @@ class NormalizationTestCase : public TestCase
 {
   virtual void run();
   void normalize();
+  void normalizePartial();
 };
 
 #endif // OPENANN_TEST_NORMALIZATION_TEST_CASE_H_
@@ -7,6 +7,9 @@ void PCATestCase::run()
 {
   RUN(PCATestCase, decorrelation);
   RUN(PCATestCase, dimensionalityReduction);
+  RUN(PCATestCase, solvers);
+  RUN(PCATestCase, incremental);
+  RUN(PCATestCase, constantFeatures);
 }
 
 void PCATestCase::decorrelation()
@@ -59,3 +62,109 @@ void PCATestCase::dimensionalityReduction()
   ASSERT_EQUALS(pca.explainedVarianceRatio().rows(), 1);
   ASSERT(pca.explainedVarianceRatio().sum() > 0.9);
 }
+
+void PCATestCase::solvers()
+{
+  OpenANN::RandomNumberGenerator rng;
+  const int N = 200;
+  const int D = 50;
+  const int components = 3;
+  Eigen::MatrixXd X(N, D);
+  rng.fillNormalDistribution(X);
+
+  // Three dominant directions
+  Eigen::MatrixXd A(D, D);
+  rng.fillNormalDistribution(A, 0.05);
+  A.topLeftCorner(components, components).diagonal() << 10.0, 5.0, 3.0;
+  Eigen::MatrixXd Xt = X * A.transpose();
+
+  OpenANN::PCA svd(components, true, OpenANN::PCA::SVD);
+  svd.fit(Xt);
+  Eigen::MatrixXd Y = svd.transform(Xt);
+  Eigen::VectorXd evr = svd.explainedVarianceRatio();
+
+  OpenANN::PCA::Solver solvers[] = {OpenANN::PCA::COVARIANCE,
+                                    OpenANN::PCA::RANDOMIZED,
+                                    OpenANN::PCA::AUTO};
+  for(int s = 0; s < 3; s++)
+  {
+    OpenANN::PCA pca(components, true, solvers[s]);
+    pca.fit(Xt);
+    Eigen::MatrixXd Y2 = pca.transform(Xt);
+    ASSERT_EQUALS(Y2.cols(), components);
+    // Principal components are only unique up to their sign
+    for(int c = 0; c < components; c++)
+    {
+      ASSERT_EQUALS_DELTA(pca.explainedVarianceRatio()(c), evr(c), 1e-5);
+      const double sign = Y2.col(c).dot(Y.col(c)) < 0.0 ? -1.0 : 1.0;
+      ASSERT_EQUALS_DELTA((Y2.col(c) * sign - Y.col(c)).norm(), 0.0, 1e-3);
+    }
+  }
+}
+
+void PCATestCase::incremental()
+{
+  OpenANN::RandomNumberGenerator rng;
+  const int N = 3000;
+  const int D = 5;
+  Eigen::MatrixXd X(N, D);
+  rng.fillNormalDistribution(X);
+  Eigen::MatrixXd A = Eigen::MatrixXd::Identity(D, D) * 0.5 +
+      Eigen::MatrixXd::Ones(D, D);
+  Eigen::MatrixXd Xt = X * A.transpose();
+  Xt.array() += 3.0;
+
+  OpenANN::PCA pca(2, true, OpenANN::PCA::SVD);
+  pca.fit(Xt);
+  Eigen::MatrixXd Y = pca.transform(Xt);
+
+  // Fit in mini-batches of different sizes
+  OpenANN::PCA incremental(2);
+  incremental.fitPartial(Xt.topRows(100));
+  incremental.fitPartial(Xt.middleRows(100, 1900));
+  incremental.fitPartial(Xt.bottomRows(1000));
+  Eigen::MatrixXd Y2 = incremental.transform(Xt);
+  for(int c = 0; c < 2; c++)
+  {
+    ASSERT_EQUALS_DELTA(incremental.explainedVarianceRatio()(c),
+                        pca.explainedVarianceRatio()(c), 1e-8);
+    const double sign = Y2.col(c).dot(Y.col(c)) < 0.0 ? -1.0 : 1.0;
+    ASSERT_EQUALS_DELTA((Y2.col(c) * sign - Y.col(c)).norm(), 0.0, 1e-6);
+  }
+}
+
+void PCATestCase::constantFeatures()
+{
+  OpenANN::RandomNumberGenerator rng;
+  const int N = 100;
+  const int D = 4;
+  Eigen::MatrixXd X(N, D);
+  X.fill(3.0);
+  // Only the first feature varies in the second dataset
+  Eigen::MatrixXd X2 = X;
+  Eigen::VectorXd x(N);
+  rng.fillNormalDistribution(x);
+  X2.col(0) = x;
+
+  OpenANN::PCA::Solver solvers[] = {OpenANN::PCA::SVD,
+                                    OpenANN::PCA::COVARIANCE,
+                                    OpenANN::PCA::RANDOMIZED};
+  for(int s = 0; s < 3; s++)
+  {
+    OpenANN::PCA pca(2, true, solvers[s]);
+    pca.fit(X);
+    Eigen::VectorXd evr = pca.explainedVarianceRatio();
+    ASSERT_EQUALS(evr(0), 0.0);
+    ASSERT_EQUALS(evr(1), 0.0);
+    Eigen::MatrixXd Y = pca.transform(X);
+    ASSERT_EQUALS_DELTA(Y.norm(), 0.0, 1e-10);
+
+    pca.fit(X2);
+    evr = pca.explainedVarianceRatio();
+    ASSERT_EQUALS_DELTA(evr(0), 1.0, 1e-10);
+    ASSERT_EQUALS_DELTA(evr(1), 0.0, 1e-10);
+    Y = pca.transform(X2);
+    ASSERT_EQUALS_DELTA(Y.col(0).squaredNorm() / N, 1.0, 1e-8);
+    ASSERT_EQUALS_DELTA(Y.col(1).norm(), 0.0, 1e-8);
+  }
+}
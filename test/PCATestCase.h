@@ -8,6 +8,9 @@ class PCATestCase : public TestCase
   virtual void run();
   void decorrelation();
   void dimensionalityReduction();
+  void solvers();
+  void incremental();
+  void constantFeatures();
 };
 
 #endif // OPENANN_TEST_PCA_TEST_CASE_H_
@@ -1,11 +1,14 @@
 #include "PreprocessingTestCase.h"
 #include <OpenANN/Preprocessing.h>
 #include <OpenANN/util/OpenANNException.h>
+#include <cstdlib>
 
 void PreprocessingTestCase::run()
 {
   RUN(PreprocessingTestCase, scaling);
   RUN(PreprocessingTestCase, testSampleRandomPatches);
+  RUN(PreprocessingTestCase, firFilter);
+  RUN(PreprocessingTestCase, iirFilter);
 }
 
 void PreprocessingTestCase::scaling()
@@ -62,3 +65,75 @@ void PreprocessingTestCase::testSampleRandomPatches()
     ASSERT_EQUALS(patches(n, 6)+1, patches(n, 7));
   }
 }
+
+void PreprocessingTestCase::firFilter()
+{
+  const int C = 3;
+  const int T = 50;
+  Eigen::MatrixXd x = Eigen::MatrixXd::Random(C, T);
+  Eigen::VectorXd b(4);
+  b << 0.1, 0.4, 0.3, 0.2;
+  Eigen::VectorXd a(1);
+  a << 2.0;
+
+  Eigen::MatrixXd y;
+  OpenANN::filter(x, y, b, a);
+  ASSERT_EQUALS(y.rows(), C);
+  ASSERT_EQUALS(y.cols(), T);
+  for(int c = 0; c < C; c++)
+  {
+    for(int t = 0; t < T; t++)
+    {
+      // The beginning of the signal is mirrored
+      double expected = 0.0;
+      for(int k = 0; k < b.rows(); k++)
+        expected += b(k) * x(c, std::abs(t - k));
+      ASSERT_EQUALS_DELTA(y(c, t), expected / a(0), 1e-10);
+    }
+  }
+
+  Eigen::MatrixXd d(C, T / 4);
+  OpenANN::downsample(y, d, 4);
+  Eigen::MatrixXd d2(C, T / 4);
+  OpenANN::filterAndDownsample(x, d2, b, a, 4);
+  ASSERT_EQUALS_DELTA((d - d2).norm(), 0.0, 1e-10);
+}
+
+void PreprocessingTestCase::iirFilter()
+{
+  const int C = 5;
+  const int T = 60;
+  Eigen::MatrixXd x = Eigen::MatrixXd::Random(C, T);
+  Eigen::VectorXd b(2);
+  b << 0.5, 0.25;
+  Eigen::VectorXd a(3);
+  a << 1.0, -0.5, 0.2;
+
+  // Difference equation applied to the signal with mirrored beginning
+  const int P = 2;
+  Eigen::MatrixXd expected(C, T);
+  for(int c = 0; c < C; c++)
+  {
+    Eigen::VectorXd xe(T + P), ye(T + P);
+    for(int t = -P; t < T; t++)
+      xe(t + P) = x(c, std::abs(t));
+    for(int t = 0; t < T + P; t++)
+    {
+      ye(t) = 0.0;
+      for(int k = 0; k < b.rows() && k <= t; k++)
+        ye(t) += b(k) * xe(t - k);
+      for(int k = 1; k < a.rows() && k <= t; k++)
+        ye(t) -= a(k) * ye(t - k);
+    }
+    expected.row(c) = ye.tail(T).transpose();
+  }
+
+  Eigen::MatrixXd y;
+  OpenANN::filter(x, y, b, a);
+  ASSERT_EQUALS_DELTA((y - expected).norm(), 0.0, 1e-10);
+
+  Eigen::MatrixXd d(C, T / 3);
+  OpenANN::filterAndDownsample(x, d, b, a, 3);
+  for(int j = 0; j < d.cols(); j++)
+    ASSERT_EQUALS_DELTA((d.col(j) - expected.col(3 * j)).norm(), 0.0, 1e-10);
+}
@@ -8,6 +8,8 @@ class PreprocessingTestCase : public TestCase
   virtual void run();
   void scaling();
   void testSampleRandomPatches();
+  void firFilter();
+  void iirFilter();
 };
 
 #endif // OPENANN_TEST_PREPROCESSING_TEST_CASE_H_
@@ -4,11 +4,14 @@
 #include <OpenANN/RBM.h>
 #include <OpenANN/optimization/MBSGD.h>
 #include <OpenANN/io/DirectStorageDataSet.h>
+#include <OpenANN/util/Random.h>
 #include <Eigen/Core>
 
 void RBMTestCase::run()
 {
   RUN(RBMTestCase, learnSimpleExample);
+  RUN(RBMTestCase, persistentContrastiveDivergence);
+  RUN(RBMTestCase, miniBatchGradient);
   RUN(RBMTestCase, parameterGradient);
   RUN(RBMTestCase, inputGradient);
 }
@@ -41,6 +44,10 @@ void RBMTestCase::learnSimpleExample()
   opt.optimize();
 
   Eigen::MatrixXd H = rbm(X);
+  // The order of the hidden units is arbitrary, each group must activate
+  // another unit
+  const int first = H(0, 0) > H(0, 1) ? 0 : 1;
+  const int second = 1 - first;
 
   for(int i = 0; i < 3; i++)
   {
@@ -52,8 +59,8 @@ void RBMTestCase::learnSimpleExample()
     ASSERT(v(0, 4) < 0.5);
     ASSERT(v(0, 5) < 0.5);
 
-    ASSERT(H(i, 0) > 0.5);
-    ASSERT(H(i, 1) < 0.5);
+    ASSERT(H(i, first) > 0.5);
+    ASSERT(H(i, second) < 0.5);
   }
 
   for(int i = 3; i < 6; i++)
@@ -66,11 +73,88 @@ void RBMTestCase::learnSimpleExample()
     ASSERT(v(0, 4) > 0.5);
     ASSERT(v(0, 5) < 0.5);
 
-    ASSERT(H(i, 0) < 0.5);
-    ASSERT(H(i, 1) > 0.5);
+    ASSERT(H(i, first) < 0.5);
+    ASSERT(H(i, second) > 0.5);
   }
 }
 
+void RBMTestCase::persistentContrastiveDivergence()
+{
+  Eigen::MatrixXd X(6, 6);
+  X.row(0) << 1, 1, 1, 0, 0, 0;
+  X.row(1) << 1, 0, 1, 0, 0, 0;
+  X.row(2) << 1, 1, 1, 0, 0, 0;
+  X.row(3) << 0, 0, 1, 1, 1, 0;
+  X.row(4) << 0, 0, 1, 1, 0, 0;
+  X.row(5) << 0, 0, 1, 1, 1, 0;
+
+  OpenANN::RBM rbm(6, 2, 1, 0.1, true, OpenANN::Regularization(), 10);
+  ASSERT_EQUALS(rbm.persistentGibbsChains(), 10);
+  OpenANN::DirectStorageDataSet ds(&X);
+  rbm.trainingSet(ds);
+  rbm.initialize();
+  OpenANN::MBSGD opt(0.1, 0.0, 2);
+  OpenANN::StoppingCriteria stop;
+  stop.maximalIterations = 2000;
+  opt.setOptimizable(rbm);
+  opt.setStopCriteria(stop);
+  opt.optimize();
+
+  // The fantasy particles replace the mini-batch in the negative phase
+  ASSERT_EQUALS(rbm.getVisibleSample().rows(), 10);
+
+  // Reconstructions should agree with the features that are shared by all
+  // instances of a group, the other features are ambiguous
+  for(int i = 0; i < 6; i++)
+  {
+    Eigen::MatrixXd v = rbm.reconstructProb(i, 1);
+    const int group = i < 3 ? 0 : 3;
+    for(int j = 0; j < 6; j++)
+    {
+      const double frequency = X.block(group, j, 3, 1).mean();
+      if(frequency == 1.0)
+        ASSERT(v(0, j) > 0.5);
+      else if(frequency == 0.0)
+        ASSERT(v(0, j) < 0.5);
+    }
+  }
+}
+
+void RBMTestCase::miniBatchGradient()
+{
+  // Gibbs sampling is deterministic if all units are saturated, hence the
+  // contrastive divergence of the mini-batches must equal the sum of the
+  // instances' gradients
+  const int D = 5;
+  const int H = 4;
+  const int N = 300;
+  OpenANN::RandomNumberGenerator rng;
+  Eigen::MatrixXd X(N, D);
+  for(int n = 0; n < N; n++)
+    for(int d = 0; d < D; d++)
+      X(n, d) = rng.generateIndex(2);
+  OpenANN::DirectStorageDataSet ds(&X);
+
+  OpenANN::RBM rbm(D, H, 2);
+  Eigen::VectorXd parameters(rbm.dimension());
+  for(int k = 0; k < D * H; k++)
+    parameters(k) = 100.0 * rng.generateInt(-1, 3);
+  for(int k = D * H; k < parameters.size(); k++)
+    parameters(k) = rng.generateIndex(2) ? 50.0 : -50.0;
+  rbm.setParameters(parameters);
+  rbm.trainingSet(ds);
+
+  Eigen::VectorXd expected(rbm.dimension());
+  expected.setZero();
+  for(int n = 0; n < N; n++)
+    expected += rbm.gradient(n);
+  const Eigen::VectorXd actual = rbm.gradient();
+
+  ASSERT(expected.squaredNorm() > 0.0);
+  for(int k = 0; k < expected.size(); k++)
+    ASSERT_EQUALS_DELTA(actual(k), expected(k), 1e-8);
+}
+
 void RBMTestCase::parameterGradient()
 {
   OpenANN::OutputInfo info;
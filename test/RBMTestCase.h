@@ -8,6 +8,8 @@ class RBMTestCase : public TestCase
   virtual void run();
   virtual void setUp();
   void learnSimpleExample();
+  void persistentContrastiveDivergence();
+  void miniBatchGradient();
   void parameterGradient();
   void inputGradient();
 };
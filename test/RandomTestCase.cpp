@@ -1,5 +1,7 @@
 #include "RandomTestCase.h"
 #include <OpenANN/util/Random.h>
+#include <OpenANN/util/Threads.h>
+#include <Eigen/Core>
 #include <algorithm>
 #include <cmath>
 #include <numeric>
@@ -13,6 +15,9 @@ void RandomTestCase::run()
   RUN(RandomTestCase, generate);
   RUN(RandomTestCase, sampleNormalDistribution);
   RUN(RandomTestCase, generateIndices);
+  RUN(RandomTestCase, fillDistributions);
+  RUN(RandomTestCase, threadIndependence);
+  RUN(RandomTestCase, streams);
 }
 
 void RandomTestCase::seed()
@@ -104,3 +109,102 @@ void RandomTestCase::generateIndices()
     foundAll = foundAll && found[n];
   ASSERT(foundAll);
 }
+
+void RandomTestCase::fillDistributions()
+{
+  OpenANN::RandomNumberGenerator rng;
+  Eigen::MatrixXd X(1001, 11);
+
+  rng.fillUniformDistribution(X, -1.0, 3.0);
+  ASSERT(X.minCoeff() >= -1.0);
+  ASSERT(X.maxCoeff() < 2.0);
+  ASSERT_EQUALS_DELTA(X.mean(), 0.5, 0.05);
+
+  rng.fillNormalDistribution(X, 2.0);
+  const double mean = X.mean();
+  ASSERT_EQUALS_DELTA(mean, 0.0, 0.1);
+  const double variance = (X.array() - mean).square().sum() / X.size();
+  ASSERT_EQUALS_DELTA(variance, 4.0, 0.2);
+
+  rng.fillBernoulliDistribution(X, 0.2);
+  ASSERT_EQUALS((X.array() == 0.0).count() + (X.array() == 1.0).count(),
+                X.size());
+  ASSERT_EQUALS_DELTA(X.mean(), 0.2, 0.02);
+}
+
+void RandomTestCase::threadIndependence()
+{
+  // Random numbers only depend on the seed, not on the number of threads
+  OpenANN::RandomNumberGenerator rng;
+  Eigen::MatrixXd X1(100, 1000), X2(100, 1000);
+  const int threads = OpenANN::numThreads();
+  OpenANN::setNumThreads(1);
+  rng.seed(7);
+  rng.fillNormalDistribution(X1);
+  const double d1 = rng.generate<double>(0.0, 1.0);
+  OpenANN::setNumThreads(std::max(threads, 4));
+  rng.seed(7);
+  rng.fillNormalDistribution(X2);
+  const double d2 = rng.generate<double>(0.0, 1.0);
+  OpenANN::setNumThreads(threads);
+  ASSERT(X1 == X2);
+  ASSERT_EQUALS(d1, d2);
+}
+
+void RandomTestCase::streams()
+{
+  // Each task draws from its own stream, which only depends on the seed and
+  // the task, not on the order of the tasks or the scheduling of the threads
+  const int tasks = 16;
+  const int samples = 50;
+  OpenANN::RandomNumberGenerator rng;
+  Eigen::MatrixXd serial(tasks, samples), parallel(tasks, samples);
+  rng.seed(3);
+  for(int t = tasks - 1; t >= 0; t--)
+  {
+    OpenANN::RandomStream stream(t);
+    std::vector<int> indices;
+    rng.generateIndices(t + 2, indices);
+    Eigen::VectorXd row(samples);
+    rng.fillUniformDistribution(row);
+    serial.row(t) = row.transpose();
+  }
+  const double shared1 = rng.generate<double>(0.0, 1.0);
+
+  rng.seed(3);
+  #pragma omp parallel for schedule(dynamic, 1) num_threads(4)
+  for(int t = 0; t < tasks; t++)
+  {
+    OpenANN::RandomStream stream(t);
+    std::vector<int> indices;
+    rng.generateIndices(t + 2, indices);
+    Eigen::VectorXd row(samples);
+    rng.fillUniformDistribution(row);
+    parallel.row(t) = row.transpose();
+  }
+  // Streams of tasks do not consume numbers of the shared stream
+  const double shared2 = rng.generate<double>(0.0, 1.0);
+
+  ASSERT(serial == parallel);
+  ASSERT(serial.row(0) != serial.row(1));
+  ASSERT_EQUALS(shared1, shared2);
+
+  // Nested streams restore the outer stream
+  rng.seed(3);
+  double outer1, outer2;
+  {
+    OpenANN::RandomStream stream(0);
+    rng.generate<double>(0.0, 1.0);
+    {
+      OpenANN::RandomStream inner(1);
+      rng.generate<double>(0.0, 1.0);
+    }
+    outer1 = rng.generate<double>(0.0, 1.0);
+  }
+  {
+    OpenANN::RandomStream stream(0);
+    rng.generate<double>(0.0, 1.0);
+    outer2 = rng.generate<double>(0.0, 1.0);
+  }
+  ASSERT_EQUALS(outer1, outer2);
+}
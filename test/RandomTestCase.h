@@ -12,6 +12,9 @@ class RandomTestCase : public TestCase
   void generate();
   void sampleNormalDistribution();
   void generateIndices();
+  void fillDistributions();
+  void threadIndependence();
+  void streams();
 };
 
 #endif // OPENANN_TEST_RANDOM_TEST_CASE_H_
@@ -2,6 +2,7 @@
 #include <OpenANN/OpenANN>
 #include <OpenANN/layers/SigmaPiConstraints.h>
 #include <OpenANN/layers/SigmaPi.h>
+#include <OpenANN/util/Random.h>
 
 
 SigmaPiConstraintTestCase::SigmaPiConstraintTestCase() : TestCase(), T1(25, 1), T2(25, 1), T3(25, 1)
@@ -35,6 +36,11 @@ void SigmaPiConstraintTestCase::run()
   RUN(SigmaPiConstraintTestCase, triangle);
 }
 
+void SigmaPiConstraintTestCase::setUp()
+{
+  OpenANN::RandomNumberGenerator().seed(0);
+}
+
 void SigmaPiConstraintTestCase::distance()
 {
   OpenANN::Net net;
@@ -10,6 +10,7 @@ public:
   SigmaPiConstraintTestCase();
 
   virtual void run();
+  virtual void setUp();
 
   void distance();
   void slope();
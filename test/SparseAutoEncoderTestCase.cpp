@@ -3,10 +3,14 @@
 #include "LayerAdapter.h"
 #include <OpenANN/SparseAutoEncoder.h>
 #include <OpenANN/io/DirectStorageDataSet.h>
+#include <cmath>
+#include <vector>
 
 void SparseAutoEncoderTestCase::run()
 {
   RUN(SparseAutoEncoderTestCase, gradient);
+  RUN(SparseAutoEncoderTestCase, minibatchGradient);
+  RUN(SparseAutoEncoderTestCase, runningMeanReset);
   RUN(SparseAutoEncoderTestCase, inputGradient);
   RUN(SparseAutoEncoderTestCase, layerGradient);
   RUN(SparseAutoEncoderTestCase, regularization);
@@ -27,6 +31,70 @@ void SparseAutoEncoderTestCase::gradient()
     ASSERT_EQUALS_DELTA(ga(k), g(k), 1e-2);
 }
 
+void SparseAutoEncoderTestCase::minibatchGradient()
+{
+  const int D = 6;
+  const int H = 3;
+  const int N = 5;
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(N, D);
+  OpenANN::DirectStorageDataSet ds(&X);
+  OpenANN::SparseAutoEncoder sae(D, H, 3.0, 0.1, 0.0001, OpenANN::LOGISTIC);
+  sae.trainingSet(ds);
+  ASSERT_EQUALS(sae.examples(), N);
+
+  double e;
+  Eigen::VectorXd g(sae.dimension());
+  sae.errorGradient(e, g);
+
+  // The first mini-batch initializes the estimated mean activation, a
+  // mini-batch that contains the whole data set is equivalent to batch
+  // training
+  std::vector<int> indices;
+  for(int n = N-1; n >= 0; n--)
+    indices.push_back(n);
+  double eBatch;
+  Eigen::VectorXd gBatch(sae.dimension());
+  sae.errorGradient(indices.begin(), indices.end(), eBatch, gBatch);
+  ASSERT_EQUALS_DELTA(eBatch, e, 1e-10);
+  for(int k = 0; k < sae.dimension(); k++)
+    ASSERT_EQUALS_DELTA(gBatch(k), g(k), 1e-10);
+}
+
+void SparseAutoEncoderTestCase::runningMeanReset()
+{
+  const int D = 6;
+  const int H = 3;
+  const int N = 6;
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(N, D);
+  OpenANN::DirectStorageDataSet ds(&X);
+  OpenANN::SparseAutoEncoder sae(D, H, 3.0, 0.1, 0.0001, OpenANN::LOGISTIC);
+  sae.trainingSet(ds);
+  const Eigen::VectorXd parameters = sae.currentParameters();
+  std::vector<int> indices;
+  for(int n = 0; n < N; n++)
+    indices.push_back(n);
+  std::vector<int>::const_iterator half = indices.begin() + N / 2;
+  double e;
+  Eigen::VectorXd g(sae.dimension());
+
+  // Estimate from the second half only
+  sae.errorGradient(half, indices.end(), e, g);
+  const double eFresh = e;
+
+  // Updates between mini-batches keep the estimate
+  sae.setParameters(parameters);
+  sae.errorGradient(indices.begin(), half, e, g);
+  sae.setParameters(parameters);
+  sae.errorGradient(half, indices.end(), e, g);
+  ASSERT(std::abs(e - eFresh) > 1e-10);
+
+  // Replaced parameters start a new estimate
+  sae.setParameters(parameters);
+  sae.setParameters(parameters);
+  sae.errorGradient(half, indices.end(), e, g);
+  ASSERT_EQUALS_DELTA(e, eFresh, 1e-12);
+}
+
 void SparseAutoEncoderTestCase::inputGradient()
 {
   const int D = 6;
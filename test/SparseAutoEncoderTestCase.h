@@ -7,6 +7,8 @@ class SparseAutoEncoderTestCase : public TestCase
 {
   virtual void run();
   void gradient();
+  void minibatchGradient();
+  void runningMeanReset();
   void inputGradient();
   void layerGradient();
   void regularization();
@@ -0,0 +1,77 @@
+#ifdef __linux__
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <sched.h>
+#endif
+#include "ThreadsTestCase.h"
+#include <OpenANN/util/Threads.h>
+#include <Eigen/Core>
+#include <cstdlib>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+void ThreadsTestCase::run()
+{
+  RUN(ThreadsTestCase, numberOfThreads);
+  RUN(ThreadsTestCase, workPackages);
+  RUN(ThreadsTestCase, pinning);
+}
+
+void ThreadsTestCase::numberOfThreads()
+{
+  const int threads = OpenANN::numThreads();
+  ASSERT(threads >= 1);
+#ifdef _OPENMP
+  OpenANN::setNumThreads(3);
+  ASSERT_EQUALS(OpenANN::numThreads(), 3);
+  ASSERT_EQUALS(Eigen::nbThreads(), 3);
+  // The library does not change the global OpenMP settings
+  const int ompThreads = omp_get_max_threads();
+  OpenANN::setNumThreads(ompThreads + 1);
+  ASSERT_EQUALS(omp_get_max_threads(), ompThreads);
+  if(!std::getenv("OPENANN_NUM_THREADS"))
+  {
+    OpenANN::setNumThreads(0);
+    ASSERT_EQUALS(OpenANN::numThreads(), ompThreads);
+  }
+#else
+  ASSERT_EQUALS(threads, 1);
+#endif
+  OpenANN::setNumThreads(threads);
+}
+
+void ThreadsTestCase::workPackages()
+{
+  const int threads = OpenANN::numThreads();
+  OpenANN::setNumThreads(4);
+  ASSERT_EQUALS(OpenANN::numThreads(0), 1);
+  ASSERT_EQUALS(OpenANN::numThreads(2), 2);
+  ASSERT_EQUALS(OpenANN::numThreads(100), OpenANN::numThreads());
+  OpenANN::setNumThreads(threads);
+}
+
+void ThreadsTestCase::pinning()
+{
+#if defined(_OPENMP) && defined(__linux__)
+  cpu_set_t original, cpus;
+  ASSERT_EQUALS(sched_getaffinity(0, sizeof(original), &original), 0);
+  if(!OpenANN::pinThreads())
+    return; // The affinity might not be modifiable in containers
+
+  // The calling thread runs on the first processor that it was allowed to use
+  ASSERT_EQUALS(sched_getaffinity(0, sizeof(cpus), &cpus), 0);
+  ASSERT_EQUALS(CPU_COUNT(&cpus), 1);
+  int first = 0;
+  while(!CPU_ISSET(first, &original))
+    first++;
+  ASSERT(CPU_ISSET(first, &cpus));
+
+  // Pinning again must not restrict the threads to the pinned processor
+  ASSERT(OpenANN::pinThreads());
+  ASSERT(OpenANN::pinThreads(false));
+  ASSERT_EQUALS(sched_getaffinity(0, sizeof(cpus), &cpus), 0);
+  ASSERT(CPU_EQUAL(&cpus, &original));
+#endif
+}
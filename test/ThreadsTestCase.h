@@ -0,0 +1,14 @@
+#ifndef OPENANN_TEST_THREADS_TEST_CASE_H_
+#define OPENANN_TEST_THREADS_TEST_CASE_H_
+
+#include <Test/TestCase.h>
+
+class ThreadsTestCase : public TestCase
+{
+  virtual void run();
+  void numberOfThreads();
+  void workPackages();
+  void pinning();
+};
+
+#endif // OPENANN_TEST_THREADS_TEST_CASE_H_
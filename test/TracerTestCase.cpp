@@ -0,0 +1,141 @@
+#include "TracerTestCase.h"
+#include <OpenANN/util/Tracer.h>
+#include <OpenANN/Net.h>
+#include <OpenANN/io/DirectStorageDataSet.h>
+#include <OpenANN/util/Threads.h>
+#include <pthread.h>
+#include <string>
+
+namespace
+{
+
+int occurrences(const std::string& str, const std::string& pattern)
+{
+  int count = 0;
+  for(size_t pos = str.find(pattern); pos != std::string::npos;
+      pos = str.find(pattern, pos + 1))
+    count++;
+  return count;
+}
+
+void* recordSpans(void*)
+{
+  for(int i = 0; i < 1000; i++)
+  {
+    OPENANN_TRACE_SPAN("background", "test");
+  }
+  return 0;
+}
+
+}
+
+void TracerTestCase::run()
+{
+  RUN(TracerTestCase, inactive);
+  RUN(TracerTestCase, spans);
+  RUN(TracerTestCase, threads);
+  RUN(TracerTestCase, net);
+  RUN(TracerTestCase, layerShares);
+  RUN(TracerTestCase, backgroundThread);
+}
+
+void TracerTestCase::inactive()
+{
+  OpenANN::Tracer::start();
+  OpenANN::Tracer::stop();
+  {
+    OPENANN_TRACE_SPAN("ignored", "test");
+  }
+  ASSERT(!OpenANN::Tracer::active());
+  const std::string json = OpenANN::Tracer::json();
+  ASSERT_EQUALS(occurrences(json, "\"ph\":\"X\""), 0);
+}
+
+void TracerTestCase::spans()
+{
+  OpenANN::Tracer::start();
+  ASSERT(OpenANN::Tracer::active());
+  {
+    OPENANN_TRACE_SPAN("outer", "test");
+    OPENANN_TRACE_SPAN(std::string("inner \"quoted\""), "test");
+  }
+  OpenANN::Tracer::stop();
+  const std::string json = OpenANN::Tracer::json();
+  ASSERT_EQUALS(occurrences(json, "\"ph\":\"X\""), 2);
+  ASSERT(json.find("\"name\":\"outer\",\"cat\":\"test\"") != std::string::npos);
+  ASSERT(json.find("\"name\":\"inner \\\"quoted\\\"\"") != std::string::npos);
+  ASSERT_EQUALS(occurrences(json, "\"thread_name\""), 1);
+}
+
+void TracerTestCase::threads()
+{
+  OpenANN::Tracer::start();
+  #pragma omp parallel num_threads(2)
+  {
+    OPENANN_TRACE_SPAN("parallel", "test");
+  }
+  OpenANN::Tracer::stop();
+  const std::string json = OpenANN::Tracer::json();
+  ASSERT_EQUALS(occurrences(json, "\"name\":\"parallel\""), 2);
+#ifdef _OPENMP
+  ASSERT_EQUALS(occurrences(json, "\"thread_name\""), 2);
+#endif
+}
+
+void TracerTestCase::net()
+{
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(8, 3);
+  Eigen::MatrixXd T = Eigen::MatrixXd::Random(8, 2);
+  OpenANN::DirectStorageDataSet dataSet(&X, &T);
+  OpenANN::Net net;
+  net.inputLayer(3)
+  .fullyConnectedLayer(4, OpenANN::TANH)
+  .outputLayer(2, OpenANN::LINEAR);
+  net.trainingSet(dataSet);
+
+  OpenANN::Tracer::start();
+  double error;
+  Eigen::VectorXd gradient(net.dimension());
+  net.errorGradient(error, gradient);
+  OpenANN::Tracer::stop();
+  const std::string json = OpenANN::Tracer::json();
+  ASSERT_EQUALS(occurrences(json, "\"name\":\"Net::errorGradient\""), 1);
+  ASSERT_EQUALS(occurrences(json, "\"name\":\"Net::gather\""), 1);
+  ASSERT_EQUALS(occurrences(json, "\"cat\":\"forward\""), 3);
+  ASSERT_EQUALS(occurrences(json, "\"cat\":\"backward\""), 3);
+  ASSERT(json.find("\"name\":\"FullyConnected\"") != std::string::npos);
+}
+
+void TracerTestCase::layerShares()
+{
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(64, 16);
+  OpenANN::Net net;
+  net.inputLayer(1, 4, 4)
+  .maxPoolingLayer(2, 2)
+  .outputLayer(2, OpenANN::LINEAR);
+
+  OpenANN::setNumThreads(2);
+  OpenANN::Tracer::start();
+  net(X);
+  OpenANN::Tracer::stop();
+  OpenANN::setNumThreads(0);
+  const std::string json = OpenANN::Tracer::json();
+  // One span per thread, not per instance
+  const int spans = occurrences(json,
+                                "\"name\":\"MaxPooling::forwardPropagate\"");
+  ASSERT(spans >= 1);
+  ASSERT(spans <= 2);
+}
+
+void TracerTestCase::backgroundThread()
+{
+  OpenANN::Tracer::start();
+  pthread_t thread;
+  pthread_create(&thread, 0, &recordSpans, 0);
+  for(int i = 0; i < 10; i++)
+    OpenANN::Tracer::json();
+  pthread_join(thread, 0);
+  OpenANN::Tracer::stop();
+  const std::string json = OpenANN::Tracer::json();
+  ASSERT_EQUALS(occurrences(json, "\"name\":\"background\""), 1000);
+}
@@ -0,0 +1,17 @@
+#ifndef OPENANN_TEST_TRACER_TEST_CASE_H_
+#define OPENANN_TEST_TRACER_TEST_CASE_H_
+
+#include <Test/TestCase.h>
+
+class TracerTestCase : public TestCase
+{
+  virtual void run();
+  void inactive();
+  void spans();
+  void threads();
+  void net();
+  void layerShares();
+  void backgroundThread();
+};
+
+#endif // OPENANN_TEST_TRACER_TEST_CASE_H_
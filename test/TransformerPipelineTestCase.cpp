@@ -0,0 +1,215 @@
+#include "TransformerPipelineTestCase.h"
+#include <OpenANN/TransformerPipeline.h>
+#include <OpenANN/Normalization.h>
+#include <OpenANN/PCA.h>
+#include <OpenANN/KMeans.h>
+#include <OpenANN/util/Random.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+void TransformerPipelineTestCase::run()
+{
+  RUN(TransformerPipelineTestCase, fusion);
+  RUN(TransformerPipelineTestCase, cache);
+  RUN(TransformerPipelineTestCase, corruptCache);
+  RUN(TransformerPipelineTestCase, fitPartial);
+  RUN(TransformerPipelineTestCase, fitTransform);
+}
+
+void TransformerPipelineTestCase::fusion()
+{
+  OpenANN::RandomNumberGenerator rng;
+  const int N = 300;
+  const int D = 6;
+  Eigen::MatrixXd X(N, D);
+  rng.fillNormalDistribution(X, 3.0);
+  X.array() += 2.0;
+
+  // Apply transformations one after another
+  OpenANN::Normalization normalization;
+  OpenANN::PCA pca(3);
+  Eigen::MatrixXd Y1 = normalization.fit(X).transform(X);
+  Eigen::MatrixXd Y2 = pca.fit(Y1).transform(Y1);
+
+  // Normalization and PCA will be combined, KMeans is not affine
+  OpenANN::Normalization normalization2;
+  OpenANN::PCA pca2(3);
+  OpenANN::KMeans kmeans2(3, 4);
+  OpenANN::TransformerPipeline pipeline(64);
+  pipeline.add(normalization2).add(pca2);
+  pipeline.fit(X);
+  Eigen::MatrixXd W;
+  Eigen::VectorXd b;
+  ASSERT(pipeline.affine(W, b));
+  ASSERT_EQUALS(W.rows(), D);
+  ASSERT_EQUALS(W.cols(), 3);
+  ASSERT_EQUALS_DELTA((pipeline.transform(X) - Y2).norm(), 0.0, 1e-8);
+
+  pipeline.add(kmeans2);
+  pipeline.fit(X);
+  ASSERT(!pipeline.affine(W, b));
+  Eigen::MatrixXd Y = pipeline.transform(X);
+  ASSERT_EQUALS(Y.rows(), N);
+  ASSERT_EQUALS(Y.cols(), 4);
+  // Check that the pipeline uses the centers of its own KMeans
+  ASSERT_EQUALS_DELTA((Y - kmeans2.transform(Y2)).norm(), 0.0, 1e-6);
+}
+
+void TransformerPipelineTestCase::cache()
+{
+  OpenANN::RandomNumberGenerator rng;
+  const int N = 100;
+  const int D = 4;
+  Eigen::MatrixXd X(N, D);
+  rng.fillNormalDistribution(X);
+
+  OpenANN::Normalization normalization;
+  OpenANN::PCA pca(2);
+  OpenANN::TransformerPipeline pipeline;
+  pipeline.add(normalization).add(pca).cache(".");
+  pipeline.fit(X);
+  Eigen::MatrixXd Y = pipeline.transform(X);
+  // The second call will load the cached dataset
+  Eigen::MatrixXd Y2 = pipeline.transform(X);
+  ASSERT_EQUALS(Y2.rows(), N);
+  ASSERT_EQUALS(Y2.cols(), 2);
+  ASSERT_EQUALS_DELTA((Y2 - Y).norm(), 0.0, 1e-12);
+
+  // Another dataset must not be loaded from the cache
+  Eigen::MatrixXd X2 = X;
+  X2(N-1, 0) += 1.0;
+  ASSERT(pipeline.cacheFileName(X2) != pipeline.cacheFileName(X));
+  Eigen::MatrixXd Y3 = pipeline.transform(X2);
+  ASSERT(Y3.row(N-1) != Y.row(N-1));
+  std::remove(pipeline.cacheFileName(X).c_str());
+  std::remove(pipeline.cacheFileName(X2).c_str());
+  pipeline.cache("");
+  ASSERT_EQUALS_DELTA((pipeline.transform(X2) - Y3).norm(), 0.0, 1e-12);
+}
+
+void TransformerPipelineTestCase::corruptCache()
+{
+  OpenANN::RandomNumberGenerator rng;
+  const int N = 50;
+  const int D = 4;
+  Eigen::MatrixXd X(N, D);
+  rng.fillNormalDistribution(X);
+
+  OpenANN::Normalization normalization;
+  OpenANN::PCA pca(2);
+  OpenANN::TransformerPipeline pipeline;
+  pipeline.add(normalization).add(pca);
+  pipeline.fit(X);
+  const Eigen::MatrixXd Y = pipeline.transform(X);
+  pipeline.cache(".");
+  const std::string fileName = pipeline.cacheFileName(X);
+
+  // Headers with wrong or negative sizes and truncated files will be ignored
+  const int headers[4][2] = {{N, 3}, {N, -1}, {-N, 2}, {N, 2}};
+  for(int i = 0; i < 4; i++)
+  {
+    {
+      std::ofstream out(fileName.c_str(), std::ios::binary);
+      out.write(reinterpret_cast<const char*>(headers[i]), 2 * sizeof(int));
+      out.write(reinterpret_cast<const char*>(Y.data()),
+                (Y.size() - 1) * sizeof(double));
+    }
+    const Eigen::MatrixXd Y2 = pipeline.transform(X);
+    ASSERT_EQUALS(Y2.rows(), N);
+    ASSERT_EQUALS(Y2.cols(), 2);
+    ASSERT_EQUALS_DELTA((Y2 - Y).norm(), 0.0, 1e-12);
+  }
+
+  // The last call replaced the truncated file
+  const Eigen::MatrixXd Y3 = pipeline.transform(X);
+  ASSERT_EQUALS_DELTA((Y3 - Y).norm(), 0.0, 1e-12);
+  std::ifstream in(fileName.c_str(), std::ios::binary | std::ios::ate);
+  ASSERT_EQUALS((int) in.tellg(),
+                (int) (2 * sizeof(int) + Y.size() * sizeof(double)));
+  in.close();
+  std::remove(fileName.c_str());
+  pipeline.cache("");
+}
+
+void TransformerPipelineTestCase::fitPartial()
+{
+  OpenANN::RandomNumberGenerator rng;
+  const int N = 100;
+  const int D = 5;
+  Eigen::MatrixXd X(N, D);
+  rng.fillNormalDistribution(X, 2.0);
+  X.array() += 1.0;
+
+  OpenANN::Normalization normalization;
+  OpenANN::PCA pca(2, true, OpenANN::PCA::COVARIANCE);
+  Eigen::MatrixXd Y1 = normalization.fit(X).transform(X);
+  Eigen::MatrixXd Y = pca.fit(Y1).transform(Y1);
+
+  // Each stage will be updated block by block with the output of the
+  // completely updated previous stage
+  OpenANN::Normalization normalization2;
+  OpenANN::PCA pca2(2, true, OpenANN::PCA::COVARIANCE);
+  OpenANN::TransformerPipeline pipeline(16);
+  pipeline.add(normalization2).add(pca2);
+  pipeline.fitPartial(X);
+  ASSERT_EQUALS_DELTA((normalization2.getMean() -
+                       normalization.getMean()).norm(), 0.0, 1e-10);
+  ASSERT_EQUALS_DELTA((pipeline.transform(X).cwiseAbs() -
+                       Y.cwiseAbs()).norm(), 0.0, 1e-6);
+}
+
+void TransformerPipelineTestCase::fitTransform()
+{
+  OpenANN::RandomNumberGenerator rng;
+  const int N = 80;
+  const int D = 4;
+  Eigen::MatrixXd X(N, D);
+  rng.fillNormalDistribution(X);
+
+  OpenANN::Normalization normalization;
+  OpenANN::PCA pca(2);
+  OpenANN::KMeans kmeans(2, 3);
+  OpenANN::TransformerPipeline pipeline;
+  pipeline.add(normalization).add(pca).add(kmeans).cache(".");
+  const std::string fileName = pipeline.fittedCacheFileName(X);
+  std::remove(fileName.c_str());
+  const Eigen::MatrixXd Y = pipeline.fitTransform(X);
+  ASSERT_EQUALS(Y.rows(), N);
+  ASSERT_EQUALS(Y.cols(), 3);
+  ASSERT_EQUALS_DELTA((Y - pipeline.transform(X)).norm(), 0.0, 1e-10);
+  std::remove(pipeline.cacheFileName(X).c_str());
+
+  // A pipeline with the same configuration will not be fitted again
+  OpenANN::Normalization normalization2;
+  OpenANN::PCA pca2(2);
+  OpenANN::KMeans kmeans2(2, 3);
+  OpenANN::TransformerPipeline pipeline2;
+  pipeline2.add(normalization2).add(pca2).add(kmeans2).cache(".");
+  ASSERT_EQUALS(pipeline2.fittedCacheFileName(X), fileName);
+  const Eigen::MatrixXd Y2 = pipeline2.fitTransform(X);
+  ASSERT_EQUALS_DELTA((Y2 - Y).norm(), 0.0, 0.0);
+  ASSERT_EQUALS_DELTA((kmeans2.getCenters() - kmeans.getCenters()).norm(),
+                      0.0, 0.0);
+  pipeline2.cache("");
+  ASSERT_EQUALS_DELTA((pipeline2.transform(X) - Y).norm(), 0.0, 1e-10);
+
+  // Another input requires fitting
+  Eigen::MatrixXd X2 = X;
+  X2(N-1, 0) += 1.0;
+  ASSERT(pipeline.fittedCacheFileName(X2) != fileName);
+
+  // Other parameters of the transformations will be detected while loading
+  OpenANN::Normalization normalization3;
+  OpenANN::PCA pca3(3);
+  OpenANN::KMeans kmeans3(3, 3);
+  OpenANN::TransformerPipeline pipeline3;
+  pipeline3.add(normalization3).add(pca3).add(kmeans3).cache(".");
+  ASSERT_EQUALS(pipeline3.fittedCacheFileName(X), fileName);
+  const Eigen::MatrixXd Y3 = pipeline3.fitTransform(X);
+  ASSERT_EQUALS(Y3.rows(), N);
+  ASSERT_EQUALS(Y3.cols(), 3);
+  pipeline3.cache("");
+  ASSERT_EQUALS_DELTA((Y3 - pipeline3.transform(X)).norm(), 0.0, 1e-10);
+  std::remove(fileName.c_str());
+}
@@ -0,0 +1,16 @@
+#ifndef OPENANN_TEST_TRANSFORMER_PIPELINE_TEST_CASE_H_
+#define OPENANN_TEST_TRANSFORMER_PIPELINE_TEST_CASE_H_
+
+#include <Test/TestCase.h>
+
+class TransformerPipelineTestCase : public TestCase
+{
+  virtual void run();
+  void fusion();
+  void cache();
+  void corruptCache();
+  void fitPartial();
+  void fitTransform();
+};
+
+#endif // OPENANN_TEST_TRANSFORMER_PIPELINE_TEST_CASE_H_
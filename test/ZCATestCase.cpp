@@ -6,6 +6,12 @@
 void ZCATestCase::run()
 {
   RUN(ZCATestCase, whiten);
+  RUN(ZCATestCase, incremental);
+}
+
+void ZCATestCase::setUp()
+{
+  OpenANN::RandomNumberGenerator().seed(0);
 }
 
 void ZCATestCase::whiten()
@@ -32,3 +38,22 @@ void ZCATestCase::whiten()
   for(int d = 0; d < D; d++)
     ASSERT_EQUALS_DELTA(C(d, d), 1.0, 0.15);
 }
+
+void ZCATestCase::incremental()
+{
+  int N = 3000;
+  int D = 5;
+  Eigen::MatrixXd X(N, D);
+  OpenANN::RandomNumberGenerator rng;
+  rng.fillNormalDistribution(X);
+  Eigen::MatrixXd A = Eigen::MatrixXd::Identity(D, D) * 0.5 +
+      Eigen::MatrixXd::Ones(D, D);
+  X = X * A.transpose();
+
+  OpenANN::ZCAWhitening zca;
+  Eigen::MatrixXd Y = zca.fit(X).transform(X);
+  OpenANN::ZCAWhitening incremental;
+  incremental.fitPartial(X.topRows(1000)).fitPartial(X.bottomRows(2000));
+  Eigen::MatrixXd Y2 = incremental.transform(X);
+  ASSERT_EQUALS_DELTA((Y2 - Y).norm(), 0.0, 1e-8);
+}
@@ -6,7 +6,9 @@
 class ZCATestCase : public TestCase
 {
   virtual void run();
+  virtual void setUp();
   void whiten();
+  void incremental();
 };
 
 #endif // OPENANN_TEST_ZCA_TEST_CASE_H_
@@ -15,6 +15,7 @@
 #include "PCATestCase.h"
 #include "ZCATestCase.h"
 #include "KMeansTestCase.h"
+#include "TransformerPipelineTestCase.h"
 #include "RandomTestCase.h"
 #include "FullyConnectedTestCase.h"
 #include "CompressedTestCase.h"
@@ -39,6 +40,13 @@
 #include "IODataSetTestCase.h"
 #include "EvaluationTestCase.h"
 #include "SigmaPiConstraintTestCase.h"
+#include "AllocationTrackerTestCase.h"
+#include "LoggerTestCase.h"
+#include "MetricsTestCase.h"
+#include "TracerTestCase.h"
+#include "ThreadsTestCase.h"
+#include "KernelsTestCase.h"
+#include "BatchPredictorTestCase.h"
 
 int main(int argc, char** argv)
 {
@@ -71,6 +79,7 @@ int main(int argc, char** argv)
   ts.addTestCase(new PCATestCase);
   ts.addTestCase(new ZCATestCase);
   ts.addTestCase(new KMeansTestCase);
+  ts.addTestCase(new TransformerPipelineTestCase);
 
   ts.addTestCase(new FullyConnectedTestCase);
   ts.addTestCase(new CompressedTestCase);
@@ -98,6 +107,13 @@ int main(int argc, char** argv)
   ts.addTestCase(new IODataSetTestCase);
   ts.addTestCase(new EvaluationTestCase);
   ts.addTestCase(new SigmaPiConstraintTestCase);
+  ts.addTestCase(new AllocationTrackerTestCase);
+  ts.addTestCase(new LoggerTestCase);
+  ts.addTestCase(new MetricsTestCase);
+  ts.addTestCase(new TracerTestCase);
+  ts.addTestCase(new ThreadsTestCase);
+  ts.addTestCase(new KernelsTestCase);
+  ts.addTestCase(new BatchPredictorTestCase);
 
   if(qt)
   {